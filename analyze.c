@@ -0,0 +1,625 @@
+// some standard library/system headers
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "analyze.h"
+#include "romdb.h"
+
+#define PROG_START 0x200
+#define ADDR(a) ((a) & 0x0FFF)
+
+// what the propagation knows about I at an instruction, besides a constant address
+#define I_UNSEEN 0xFFFF     // no path has reached the instruction (yet)
+#define I_UNKNOWN 0xFFFE    // paths disagree, or I was computed at run time
+
+// header at the start of a sidecar file (followed by the byte map, then `nblocks` blocks,
+// `nloops` loops and `nsprites` sprites, as raw records)
+struct analysis_file_header {
+    char magic[8];          // "C8CFG001"
+    uint64_t rom_hash;
+    uint8_t quirks;
+    uint8_t flags;
+    uint16_t entry;
+    uint16_t idle_pc;
+    uint16_t insns;
+    uint16_t nblocks;
+    uint16_t nloops;
+    uint16_t nsprites;
+    uint16_t record_sizes;  // sizeof each record type when the file was written (a cheap format check)
+};
+
+#define ANALYSIS_MAGIC "C8CFG001"
+#define RECORD_SIZES ((uint16_t)(sizeof(struct analysis_block) << 10 | sizeof(struct analysis_loop) << 5 \
+                                 | sizeof(struct analysis_sprite)))
+
+// scratch state for finding loops (natural loops of the back edges a depth-first search finds)
+struct loop_finder {
+    const struct chip8_analysis *a;
+    const int16_t *block_at;            // block index by start address (-1 = none)
+    uint8_t state[ANALYZE_MAX_BLOCKS];  // DFS: 0 = not visited yet, 1 = on the DFS path, 2 = done
+    uint8_t back[ANALYZE_MAX_BLOCKS];   // bit e set: the block's successor e is a back edge
+    bool header[ANALYZE_MAX_BLOCKS];    // target of some back edge
+    int16_t pred_first[ANALYZE_MAX_BLOCKS + 1]; // predecessors of block b: pred[pred_first[b] .. pred_first[b + 1])
+    int16_t pred[2 * ANALYZE_MAX_BLOCKS];
+    int16_t reach[ANALYZE_MAX_BLOCKS];      // 1 + the last loop whose header can reach this block
+    int16_t in_loop[ANALYZE_MAX_BLOCKS];    // 1 + the last loop whose body includes this block
+    int16_t work[ANALYZE_MAX_BLOCKS];
+};
+
+void chip8_disasm(uint16_t op, char *buf, size_t len) {
+    int x = (op >> 8) & 0xF, y = (op >> 4) & 0xF, n = op & 0xF, nn = op & 0xFF, nnn = op & 0xFFF;
+    static const char *alu[16] = { "LD", "OR", "AND", "XOR", "ADD", "SUB", "SHR", "SUBN",
+                                   NULL, NULL, NULL, NULL, NULL, NULL, "SHL", NULL };
+    switch (op >> 12) {
+    case 0x0:
+        if (op == 0x00E0) snprintf(buf, len, "CLS");
+        else if (op == 0x00EE) snprintf(buf, len, "RET");
+        else snprintf(buf, len, "SYS  %03X", nnn);
+        break;
+    case 0x1: snprintf(buf, len, "JP   %03X", nnn); break;
+    case 0x2: snprintf(buf, len, "CALL %03X", nnn); break;
+    case 0x3: snprintf(buf, len, "SE   V%X, %02X", x, nn); break;
+    case 0x4: snprintf(buf, len, "SNE  V%X, %02X", x, nn); break;
+    case 0x5: snprintf(buf, len, "SE   V%X, V%X", x, y); break;
+    case 0x6: snprintf(buf, len, "LD   V%X, %02X", x, nn); break;
+    case 0x7: snprintf(buf, len, "ADD  V%X, %02X", x, nn); break;
+    case 0x8:
+        if (alu[n]) snprintf(buf, len, "%-4s V%X, V%X", alu[n], x, y);
+        else snprintf(buf, len, "???  %04X", op);
+        break;
+    case 0x9: snprintf(buf, len, "SNE  V%X, V%X", x, y); break;
+    case 0xA: snprintf(buf, len, "LD   I, %03X", nnn); break;
+    case 0xB: snprintf(buf, len, "JP   V0, %03X", nnn); break;
+    case 0xC: snprintf(buf, len, "RND  V%X, %02X", x, nn); break;
+    case 0xD: snprintf(buf, len, "DRW  V%X, V%X, %X", x, y, n); break;
+    case 0xE:
+        if (nn == 0x9E) snprintf(buf, len, "SKP  V%X", x);
+        else if (nn == 0xA1) snprintf(buf, len, "SKNP V%X", x);
+        else snprintf(buf, len, "???  %04X", op);
+        break;
+    default:
+        switch (nn) {
+        case 0x07: snprintf(buf, len, "LD   V%X, DT", x); break;
+        case 0x0A: snprintf(buf, len, "LD   V%X, K", x); break;
+        case 0x15: snprintf(buf, len, "LD   DT, V%X", x); break;
+        case 0x18: snprintf(buf, len, "LD   ST, V%X", x); break;
+        case 0x1E: snprintf(buf, len, "ADD  I, V%X", x); break;
+        case 0x29: snprintf(buf, len, "LD   F, V%X", x); break;
+        case 0x33: snprintf(buf, len, "LD   B, V%X", x); break;
+        case 0x55: snprintf(buf, len, "LD   [I], V%X", x); break;
+        case 0x65: snprintf(buf, len, "LD   V%X, [I]", x); break;
+        default: snprintf(buf, len, "???  %04X", op); break;
+        }
+        break;
+    }
+}
+
+// helper to tell whether an opcode is in the CHIP-8 instruction set (the ISA, not just what the core runs today)
+static bool valid_op(uint16_t op) {
+    uint8_t n = op & 0xF, nn = op & 0xFF;
+    switch (op >> 12) {
+    case 0x0: return op == 0x00E0 || op == 0x00EE;
+    case 0x5: case 0x9: return n == 0;
+    case 0x8: return n <= 0x7 || n == 0xE;
+    case 0xE: return nn == 0x9E || nn == 0xA1;
+    case 0xF:
+        return nn == 0x07 || nn == 0x0A || nn == 0x15 || nn == 0x18 || nn == 0x1E
+            || nn == 0x29 || nn == 0x33 || nn == 0x55 || nn == 0x65;
+    default: return true;
+    }
+}
+
+// helper to tell whether an instruction is a conditional skip
+static bool is_skip(uint16_t op) {
+    switch (op >> 12) {
+    case 0x3: case 0x4: case 0x5: case 0x9: return true;
+    case 0xE: return (op & 0xFF) == 0x9E || (op & 0xFF) == 0xA1;
+    default: return false;
+    }
+}
+
+// helper to find where control can go after `op` at `pc` (returns how many places, in `succ`; an
+// instruction that doesn't just fall through to pc + 2 ends its basic block, flagged in `*ends`)
+static int successors(uint16_t op, uint16_t pc, uint16_t succ[2], bool *ends) {
+    int n = 0;
+    *ends = true;
+    if (!valid_op(op) || op == 0x00EE || (op >> 12) == 0xB) {
+        // (nowhere: a return's target comes from the stack, BNNN's from V0)
+    } else if ((op >> 12) == 0x1) {
+        succ[n++] = op & 0xFFF;
+    } else if ((op >> 12) == 0x2) {
+        succ[n++] = op & 0xFFF;
+        succ[n++] = pc + 2;
+    } else if (is_skip(op)) {
+        succ[n++] = pc + 2;
+        succ[n++] = pc + 4;
+    } else {
+        *ends = false;
+        succ[n++] = pc + 2;
+    }
+
+    // (an instruction has to fit in RAM to be fetched)
+    int kept = 0;
+    for (int i = 0; i < n; ++i) {
+        if (succ[i] <= RAM_SIZE - 2) succ[kept++] = succ[i];
+    }
+    return kept;
+}
+
+// helper to work out I after `op` runs with I = `i`
+static uint16_t i_after(uint16_t op, uint16_t i, uint8_t quirks) {
+    uint8_t nn = op & 0xFF;
+    if ((op >> 12) == 0xA) return op & 0xFFF;
+    if ((op >> 12) != 0xF) return i;
+    if (nn == 0x1E || nn == 0x29) return I_UNKNOWN;
+    if ((nn == 0x55 || nn == 0x65) && (quirks & CHIP8_QUIRK_MEMORY_I) && i != I_UNKNOWN) {
+        return ADDR(i + ((op >> 8) & 0xF) + 1);
+    }
+    return i;
+}
+
+// helper to merge a value of I arriving along one more path into what's known (true if that changed)
+static bool merge_i(uint16_t *known, uint16_t i) {
+    if (*known == i || *known == I_UNKNOWN) return false;
+    *known = (*known == I_UNSEEN) ? i : I_UNKNOWN;
+    return true;
+}
+
+// helper to tell whether a loop made of this instruction could spin without changing any state
+// a later frame can't change for it (i.e., it's just waiting on the delay timer or the keypad)
+static bool is_idle_op(uint16_t op) {
+    uint8_t nn = op & 0xFF;
+    return (op >> 12) == 0x1 || is_skip(op) || ((op >> 12) == 0xF && (nn == 0x07 || nn == 0x0A));
+}
+
+// helper to note a DXYN's sprite (or that one more DXYN draws it)
+static void add_sprite(struct chip8_analysis *a, uint16_t addr, uint8_t rows) {
+    for (int s = 0; s < a->nsprites; ++s) {
+        if (a->sprites[s].addr == addr && a->sprites[s].rows == rows) {
+            if (a->sprites[s].draws < UINT8_MAX) a->sprites[s].draws++;
+            return;
+        }
+    }
+    if (a->nsprites < ANALYZE_MAX_SPRITES) {
+        a->sprites[a->nsprites++] = (struct analysis_sprite){ .addr = addr, .rows = rows, .draws = 1 };
+    }
+}
+
+// helper to mark the bytes an FX33/FX55/FX65 at a known I touches (and any code it overwrites)
+static void mark_data(struct chip8_analysis *a, uint16_t i, int count, bool store) {
+    for (int k = 0; k < count; ++k) {
+        uint16_t addr = ADDR(i + k);
+        a->map[addr] |= ANALYZE_DATA;
+        if (store && (a->map[addr] & (ANALYZE_CODE | ANALYZE_OPERAND))) {
+            a->map[addr] |= ANALYZE_SMC;
+            a->flags |= ANALYZE_F_SMC;
+        }
+    }
+}
+
+// helper for the depth-first search: an edge to a block still on the DFS path is a back edge (its target heads a loop)
+static void dfs_visit(struct loop_finder *lf, int b) {
+    lf->state[b] = 1;
+    const struct analysis_block *blk = &lf->a->blocks[b];
+    for (int e = 0; e < blk->nsucc; ++e) {
+        int t = lf->block_at[blk->succ[e]];
+        if (t < 0) continue;
+        if (lf->state[t] == 0) dfs_visit(lf, t);
+        else if (lf->state[t] == 1) {
+            lf->header[t] = true;
+            lf->back[b] |= 1 << e;
+        }
+    }
+    lf->state[b] = 2;
+}
+
+static int cmp_sprites(const void *l, const void *r) {
+    const struct analysis_sprite *sl = l, *sr = r;
+    return sl->addr != sr->addr ? (int)sl->addr - (int)sr->addr : (int)sl->rows - (int)sr->rows;
+}
+
+// helper to split the reachable code into basic blocks (needs the CODE/LEADER map)
+static void find_blocks(struct chip8_analysis *a, const uint8_t *mem, int16_t *block_at) {
+    for (int addr = 0; addr < RAM_SIZE; ++addr) {
+        block_at[addr] = -1;
+        if (!(a->map[addr] & ANALYZE_LEADER)) continue;
+
+        struct analysis_block *blk = &a->blocks[a->nblocks];
+        block_at[addr] = (int16_t)a->nblocks++;
+        blk->start = (uint16_t)addr;
+        for (uint16_t pc = (uint16_t)addr;; pc += 2) {
+            uint16_t op = (uint16_t)(mem[pc] << 8 | mem[pc + 1]), succ[2];
+            bool ends;
+            int n = successors(op, pc, succ, &ends);
+            blk->end = pc + 2;
+            if (ends || n == 0 || (a->map[succ[0]] & ANALYZE_LEADER)) {
+                blk->nsucc = (uint8_t)n;
+                memcpy(blk->succ, succ, n * sizeof *succ);
+                break;
+            }
+        }
+    }
+}
+
+// helper to find the loops: each block a back edge goes to heads one, whose body is every block that
+// can get back to it without going through it (so a wait loop inside a main loop is a loop of its own)
+static void find_loops(struct chip8_analysis *a, const uint8_t *mem, const int16_t *block_at) {
+    struct loop_finder *lf = calloc(1, sizeof *lf);
+    if (!lf) return;
+    lf->a = a;
+    lf->block_at = block_at;
+    int entry_block = block_at[a->entry];
+    if (entry_block >= 0) dfs_visit(lf, entry_block);
+    for (int b = 0; b < a->nblocks; ++b) {
+        if (!lf->state[b]) dfs_visit(lf, b);
+    }
+
+    // list every block's predecessors
+    for (int b = 0; b < a->nblocks; ++b) {
+        for (int e = 0; e < a->blocks[b].nsucc; ++e) {
+            int t = block_at[a->blocks[b].succ[e]];
+            if (t >= 0) lf->pred_first[t + 1]++;
+        }
+    }
+    for (int b = 0; b < a->nblocks; ++b) lf->pred_first[b + 1] += lf->pred_first[b];
+    int16_t *fill = lf->work;       // (borrowed: next free predecessor slot per block)
+    for (int b = 0; b < a->nblocks; ++b) fill[b] = lf->pred_first[b];
+    for (int b = 0; b < a->nblocks; ++b) {
+        for (int e = 0; e < a->blocks[b].nsucc; ++e) {
+            int t = block_at[a->blocks[b].succ[e]];
+            if (t >= 0) lf->pred[fill[t]++] = (int16_t)b;
+        }
+    }
+
+    // (blocks are sorted by address, so the loops come out sorted by header)
+    for (int h = 0; h < a->nblocks; ++h) {
+        if (!lf->header[h]) continue;
+        int16_t id = (int16_t)(a->nloops + 1);
+        struct analysis_loop *lp = &a->loops[a->nloops++];
+        *lp = (struct analysis_loop){ .header = a->blocks[h].start, .lo = 0xFFFF, .flags = ANALYZE_LOOP_IDLE };
+
+        // find what the header can reach...
+        int top = 0;
+        lf->reach[h] = id;
+        lf->work[top++] = (int16_t)h;
+        while (top) {
+            const struct analysis_block *blk = &a->blocks[lf->work[--top]];
+            for (int e = 0; e < blk->nsucc; ++e) {
+                int t = block_at[blk->succ[e]];
+                if (t >= 0 && lf->reach[t] != id) {
+                    lf->reach[t] = id;
+                    lf->work[top++] = (int16_t)t;
+                }
+            }
+        }
+
+        // ...then walk backwards from the blocks whose back edges go to it, up to the header
+        // (staying within that reach, in case the loop can also be entered somewhere else)
+        lf->in_loop[h] = id;
+        for (int p = lf->pred_first[h]; p < lf->pred_first[h + 1]; ++p) {
+            int b = lf->pred[p];
+            const struct analysis_block *blk = &a->blocks[b];
+            bool latch = false;
+            for (int e = 0; e < blk->nsucc; ++e) latch |= (lf->back[b] >> e & 1) && blk->succ[e] == a->blocks[h].start;
+            if (latch && lf->in_loop[b] != id) {
+                lf->in_loop[b] = id;
+                lf->work[top++] = (int16_t)b;
+            }
+        }
+        while (top) {
+            int b = lf->work[--top];
+            for (int p = lf->pred_first[b]; p < lf->pred_first[b + 1]; ++p) {
+                int q = lf->pred[p];
+                if (lf->in_loop[q] != id && lf->reach[q] == id) {
+                    lf->in_loop[q] = id;
+                    lf->work[top++] = (int16_t)q;
+                }
+            }
+        }
+
+        for (int b = 0; b < a->nblocks; ++b) {
+            if (lf->in_loop[b] != id) continue;
+            const struct analysis_block *blk = &a->blocks[b];
+            if (blk->start < lp->lo) lp->lo = blk->start;
+            if (blk->end > lp->hi) lp->hi = blk->end;
+            for (uint16_t pc = blk->start; pc < blk->end; pc += 2) {
+                uint16_t op = (uint16_t)(mem[pc] << 8 | mem[pc + 1]);
+                lp->insns++;
+                if ((op >> 12) == 0x2) lp->flags = (lp->flags | ANALYZE_LOOP_CALLS) & ~ANALYZE_LOOP_IDLE;
+                if (!is_idle_op(op)) lp->flags &= ~ANALYZE_LOOP_IDLE;
+            }
+            for (uint16_t addr = blk->start; addr < blk->end; ++addr) a->map[addr] |= ANALYZE_LOOP;
+
+            // (a block belongs to the innermost, i.e., smallest, loop around it)
+            struct analysis_block *bb = &a->blocks[b];
+            if (!bb->loop || a->loops[bb->loop - 1].insns > lp->insns) bb->loop = (uint16_t)id;
+        }
+        if (!a->idle_pc && (lp->flags & ANALYZE_LOOP_IDLE)) a->idle_pc = lp->header;
+    }
+    free(lf);
+}
+
+struct chip8_analysis *chip8_analyze(const uint8_t *rom, size_t len, uint8_t quirks) {
+    struct chip8_analysis *a = calloc(1, sizeof *a);
+    struct chip8_vm *vm = malloc(sizeof *vm);
+    uint8_t *mem = malloc(RAM_SIZE + 1);
+    uint16_t *in_i = malloc(RAM_SIZE * sizeof *in_i);
+    uint16_t *work = malloc(RAM_SIZE * sizeof *work);
+    int16_t *block_at = malloc(RAM_SIZE * sizeof *block_at);
+    bool *queued = calloc(RAM_SIZE, sizeof *queued);
+    if (!a || !vm || !mem || !in_i || !work || !block_at || !queued || !chip8_load(vm, (uint8_t *)rom, len)) {
+        free(a);
+        a = NULL;
+        goto cleanup;
+    }
+
+    // take the RAM image exactly as chip8_load sets it up
+    for (int addr = 0; addr < RAM_SIZE; ++addr) mem[addr] = (uint8_t)vm->ram[addr];
+    mem[RAM_SIZE] = 0;
+    a->rom_hash = romdb_hash_rom(rom, len);
+    a->quirks = quirks;
+    a->entry = PROG_START;
+
+    // follow every path from the entry point, merging what each one knows about I (a worklist
+    // iteration: an instruction is revisited whenever the value of I it can start with changes)
+    for (int addr = 0; addr < RAM_SIZE; ++addr) in_i[addr] = I_UNSEEN;
+    int top = 0;
+    in_i[a->entry] = 0;
+    work[top++] = a->entry;
+    queued[a->entry] = true;
+    while (top) {
+        uint16_t pc = work[--top], succ[2];
+        queued[pc] = false;
+        uint16_t op = (uint16_t)(mem[pc] << 8 | mem[pc + 1]);
+        bool ends;
+        int n = successors(op, pc, succ, &ends);
+        uint16_t i = i_after(op, in_i[pc], quirks);
+        for (int s = 0; s < n; ++s) {
+            // (a subroutine can leave anything in I)
+            bool return_site = (op >> 12) == 0x2 && succ[s] == pc + 2;
+            if (merge_i(&in_i[succ[s]], return_site ? I_UNKNOWN : i) && !queued[succ[s]]) {
+                queued[succ[s]] = true;
+                work[top++] = succ[s];
+            }
+        }
+    }
+
+    // classify the instructions, and mark where basic blocks start
+    a->map[a->entry] |= ANALYZE_LEADER;
+    for (int pc = 0; pc < RAM_SIZE; ++pc) {
+        if (in_i[pc] == I_UNSEEN) continue;
+        uint16_t op = (uint16_t)(mem[pc] << 8 | mem[pc + 1]), succ[2];
+        a->map[pc] |= ANALYZE_CODE;
+        // (successors() never lets a path reach the last byte of RAM, but `map` has no padding
+        // byte like `mem` does, so don't count on it)
+        if (pc + 1 < RAM_SIZE) a->map[pc + 1] |= ANALYZE_OPERAND;
+        a->insns++;
+        if (!valid_op(op)) {
+            a->map[pc] |= ANALYZE_INVALID;
+            a->flags |= ANALYZE_F_INVALID;
+        }
+        if ((op >> 12) == 0xB) a->flags |= ANALYZE_F_INDIRECT;
+        bool ends;
+        int n = successors(op, (uint16_t)pc, succ, &ends);
+        for (int s = 0; ends && s < n; ++s) a->map[succ[s]] |= ANALYZE_LEADER;
+    }
+    for (int addr = 0; addr < RAM_SIZE; ++addr) {
+        if ((a->map[addr] & (ANALYZE_CODE | ANALYZE_OPERAND)) == (ANALYZE_CODE | ANALYZE_OPERAND)) {
+            a->flags |= ANALYZE_F_OVERLAP;
+        }
+    }
+
+    // then see what memory the instructions with a known I touch
+    for (int pc = 0; pc < RAM_SIZE; ++pc) {
+        if (in_i[pc] == I_UNSEEN) continue;
+        uint16_t op = (uint16_t)(mem[pc] << 8 | mem[pc + 1]), i = in_i[pc];
+        int x = (op >> 8) & 0xF;
+        uint8_t nn = op & 0xFF;
+        bool store = (op >> 12) == 0xF && (nn == 0x33 || nn == 0x55);
+        bool load = (op >> 12) == 0xF && nn == 0x65;
+        if (i == I_UNKNOWN) {
+            if (store) a->flags |= ANALYZE_F_STORE;
+        } else if ((op >> 12) == 0xD && (op & 0xF)) {
+            for (int r = 0; r < (op & 0xF); ++r) a->map[ADDR(i + r)] |= ANALYZE_SPRITE;
+            add_sprite(a, i, op & 0xF);
+        } else if (store || load) {
+            mark_data(a, i, nn == 0x33 ? 3 : x + 1, store);
+        }
+    }
+    qsort(a->sprites, a->nsprites, sizeof *a->sprites, cmp_sprites);
+
+    find_blocks(a, mem, block_at);
+    find_loops(a, mem, block_at);
+
+cleanup:
+    free(vm);
+    free(mem);
+    free(in_i);
+    free(work);
+    free(block_at);
+    free(queued);
+    return a;
+}
+
+bool chip8_analysis_save(const struct chip8_analysis *a, const char *path) {
+    // (a temporary name of our own, so concurrent writers of the same sidecar never share one;
+    // mkstemp makes it 0600, but the cache is meant to be as readable as any other file)
+    char tmp_path[1040];
+    snprintf(tmp_path, sizeof tmp_path, "%s.XXXXXX", path);
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) return false;
+    FILE *fp = fdopen(fd, "wb");
+    if (!fp || fchmod(fd, 0644) != 0) {
+        if (fp) fclose(fp);
+        else close(fd);
+        remove(tmp_path);
+        return false;
+    }
+
+    struct analysis_file_header hdr;
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, ANALYSIS_MAGIC, sizeof hdr.magic);
+    hdr.rom_hash = a->rom_hash;
+    hdr.quirks = a->quirks;
+    hdr.flags = a->flags;
+    hdr.entry = a->entry;
+    hdr.idle_pc = a->idle_pc;
+    hdr.insns = a->insns;
+    hdr.nblocks = a->nblocks;
+    hdr.nloops = a->nloops;
+    hdr.nsprites = a->nsprites;
+    hdr.record_sizes = RECORD_SIZES;
+
+    bool ok = (fwrite(&hdr, sizeof hdr, 1, fp) == 1)
+        && (fwrite(a->map, sizeof a->map, 1, fp) == 1)
+        && (fwrite(a->blocks, sizeof *a->blocks, a->nblocks, fp) == (size_t)a->nblocks)
+        && (fwrite(a->loops, sizeof *a->loops, a->nloops, fp) == (size_t)a->nloops)
+        && (fwrite(a->sprites, sizeof *a->sprites, a->nsprites, fp) == (size_t)a->nsprites);
+    ok = (fclose(fp) == 0) && ok;
+
+    // rename-over so a concurrent reader only ever sees a complete file
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+struct chip8_analysis *chip8_analysis_load(const char *path, uint64_t rom_hash, uint8_t quirks) {
+    struct analysis_file_header hdr;
+    struct chip8_analysis *a = NULL;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    if (fread(&hdr, sizeof hdr, 1, fp) != 1 || memcmp(hdr.magic, ANALYSIS_MAGIC, sizeof hdr.magic) != 0
+            || hdr.record_sizes != RECORD_SIZES || hdr.rom_hash != rom_hash || hdr.quirks != quirks
+            || hdr.nblocks > ANALYZE_MAX_BLOCKS || hdr.nloops > ANALYZE_MAX_BLOCKS
+            || hdr.nsprites > ANALYZE_MAX_SPRITES || (a = calloc(1, sizeof *a)) == NULL) {
+        goto fail;
+    }
+    a->rom_hash = hdr.rom_hash;
+    a->quirks = hdr.quirks;
+    a->flags = hdr.flags;
+    a->entry = hdr.entry;
+    a->idle_pc = hdr.idle_pc;
+    a->insns = hdr.insns;
+    a->nblocks = hdr.nblocks;
+    a->nloops = hdr.nloops;
+    a->nsprites = hdr.nsprites;
+    if (fread(a->map, sizeof a->map, 1, fp) != 1
+            || fread(a->blocks, sizeof *a->blocks, a->nblocks, fp) != (size_t)a->nblocks
+            || fread(a->loops, sizeof *a->loops, a->nloops, fp) != (size_t)a->nloops
+            || fread(a->sprites, sizeof *a->sprites, a->nsprites, fp) != (size_t)a->nsprites) {
+        goto fail;
+    }
+    fclose(fp);
+    return a;
+
+fail:
+    free(a);
+    fclose(fp);
+    return NULL;
+}
+
+void chip8_analysis_path(const char *dir, uint64_t rom_hash, uint8_t quirks, char *buf, size_t len) {
+    snprintf(buf, len, "%s/%016llx-q%02x.c8cfg", dir, (unsigned long long)rom_hash, quirks);
+}
+
+struct chip8_analysis *chip8_analysis_cached(const char *dir, const uint8_t *rom, size_t len, uint8_t quirks) {
+    uint64_t hash = romdb_hash_rom(rom, len);
+    char path[1024];
+    chip8_analysis_path(dir, hash, quirks, path, sizeof path);
+
+    struct chip8_analysis *a = chip8_analysis_load(path, hash, quirks);
+    if (!a && (a = chip8_analyze(rom, len, quirks)) != NULL) {
+        chip8_analysis_save(a, path);
+    }
+    return a;
+}
+
+void chip8_analysis_prewarm(const struct chip8_analysis *a, struct chip8_vm *vm) {
+    // (fill in order of increasing use, so where two sprites share a cache slot the more drawn one stays)
+    for (int draws = 1; draws <= UINT8_MAX; ++draws) {
+        bool more = false;
+        for (int s = 0; s < a->nsprites; ++s) {
+            if (a->sprites[s].draws == draws) chip8_prewarm_sprite(vm, a->sprites[s].addr, a->sprites[s].rows);
+            more |= a->sprites[s].draws > draws;
+        }
+        if (!more) break;
+    }
+}
+
+// helper to read a ROM byte by its RAM address (0 past the end of the ROM)
+static uint8_t rom_byte(const uint8_t *rom, size_t len, unsigned addr) {
+    return (addr >= PROG_START && addr - PROG_START < len) ? rom[addr - PROG_START] : 0;
+}
+
+void chip8_analysis_list(const struct chip8_analysis *a, const uint8_t *rom, size_t len, FILE *out) {
+    unsigned end = PROG_START + (unsigned)len;
+
+    fprintf(out, "; ROM %016llx (%zu bytes), quirks 0x%02x\n", (unsigned long long)a->rom_hash, len, a->quirks);
+    fprintf(out, "; instructions: %u, blocks: %u, loops: %u, sprites: %u", a->insns, a->nblocks, a->nloops, a->nsprites);
+    if (a->idle_pc) fprintf(out, "; idle loop at %03X", a->idle_pc);
+    fprintf(out, "\n");
+    if (a->flags & ANALYZE_F_INDIRECT) fprintf(out, "; has BNNN jumps: code only reached through them is listed as data\n");
+    if (a->flags & ANALYZE_F_SMC) fprintf(out, "; stores into its own code: the instructions marked may change at run time\n");
+    if (a->flags & ANALYZE_F_STORE) fprintf(out, "; stores through a computed I: any byte may change at run time\n");
+
+    for (unsigned pc = PROG_START; pc < end;) {
+        uint8_t m = a->map[pc];
+        if (m & ANALYZE_CODE) {
+            if (m & ANALYZE_LEADER) {
+                fprintf(out, "\n%03X:", pc);
+                if (pc == a->entry) fprintf(out, "  ; entry");
+                for (int l = 0; l < a->nloops; ++l) {
+                    const struct analysis_loop *lp = &a->loops[l];
+                    if (lp->header != pc) continue;
+                    fprintf(out, "  ; loop %03X-%03X, %u instructions%s", lp->lo, lp->hi - 1, lp->insns,
+                            (lp->flags & ANALYZE_LOOP_IDLE) ? " (idle)" : "");
+                }
+                fprintf(out, "\n");
+            }
+            uint16_t op = (uint16_t)(rom_byte(rom, len, pc) << 8 | rom_byte(rom, len, pc + 1));
+            char text[32];
+            chip8_disasm(op, text, sizeof text);
+            uint8_t next = pc + 1 < RAM_SIZE ? a->map[pc + 1] : 0, both = m | next;
+            char line[128];
+            int n = snprintf(line, sizeof line, "    %03X  %04X  %-16s%s%s%s", pc, op, text,
+                             (both & ANALYZE_SMC) ? "  ; self-modified" : "",
+                             (m & ANALYZE_INVALID) ? "  ; not in the ISA" : "",
+                             (next & ANALYZE_CODE) ? "  ; overlaps the next instruction" : "");
+            while (n > 0 && line[n - 1] == ' ') line[--n] = '\0';
+            fprintf(out, "%s\n", line);
+            pc += (next & ANALYZE_CODE) ? 1 : 2;
+        } else if (m & ANALYZE_SPRITE) {
+            // (sprite rows one per line, drawn out)
+            uint8_t b = rom_byte(rom, len, pc);
+            char pixels[9];
+            for (int k = 0; k < 8; ++k) pixels[k] = (b & (0x80 >> k)) ? '#' : '.';
+            pixels[8] = '\0';
+            fprintf(out, "    %03X  %02X    %s", pc, b, pixels);
+            int heights = 0;
+            for (int sp = 0; sp < a->nsprites; ++sp) {
+                if (a->sprites[sp].addr == pc) fprintf(out, heights++ ? "/%u" : "  ; sprite, %u", a->sprites[sp].rows);
+            }
+            fprintf(out, "%s%s\n", heights ? " rows" : "", (m & ANALYZE_DATA) ? "  ; also data" : "");
+            pc++;
+        } else {
+            // (up to 8 other bytes per line, split where the kind of byte changes)
+            uint8_t kind = m & ANALYZE_DATA;
+            fprintf(out, "    %03X  DB   ", pc);
+            int n = 0;
+            for (; n < 8 && pc < end && !(a->map[pc] & (ANALYZE_CODE | ANALYZE_SPRITE))
+                    && (a->map[pc] & ANALYZE_DATA) == kind; ++n, ++pc) {
+                fprintf(out, "%s%02X", n ? " " : "", rom_byte(rom, len, pc));
+            }
+            fprintf(out, "%*s; %s\n", 3 * (8 - n) + 2, "", kind ? "data" : "not reached");
+        }
+    }
+}
+
+void chip8_analysis_free(struct chip8_analysis *a) {
+    free(a);
+}
@@ -0,0 +1,135 @@
+#ifndef _ANALYZE_H
+#define _ANALYZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "chip8.h"
+
+// STATIC ROM ANALYZER: CONTROL-FLOW GRAPH, BYTE CLASSES AND LOOPS
+//--------------------------------------------------------------
+//
+// chip8_analyze() loads a ROM into a scratch VM (so it sees the same 4 KiB image chip8_load
+// builds, font included) and walks every instruction reachable from 0x200, following jumps,
+// calls, returns and both sides of every skip, while tracking the value of I along each path
+// (a constant where all paths agree, unknown after ADD I / LD F / a call).  From that it gets:
+//
+// * a map of every RAM byte: instruction, operand, sprite (read by a DXYN with a known I),
+//   data (read or written by FX33/FX55/FX65) or self-modified code (written by one of those)
+// * the basic blocks and their successor edges (the CFG)
+// * the loops (the natural loop of each back edge, so nested loops are found separately), and
+//   which of them only wait on the delay timer or the keypad: the first such loop's header is an
+//   idle-loop hint like romdb.h's idle_pc
+// * the sprites the program draws (address and height), to pre-fill the VM's sprite cache
+//
+// BNNN jumps (whose targets depend on V0), stores through an unknown I and reachable opcodes the
+// ISA doesn't have make the result a lower bound, and are flagged so callers can tell.
+//
+// The result can be saved to (and loaded back from) a small sidecar file keyed by the ROM's
+// romdb_hash_rom() value and the quirks, so a host only pays for the analysis the first time it
+// sees a ROM (under those quirks); chip8_analysis_cached() does that lookup in a cache directory.
+
+// what the analysis found out about a RAM byte (bit vector; one per address in `map`)
+#define ANALYZE_CODE    0x01    // first byte of a reachable instruction
+#define ANALYZE_OPERAND 0x02    // second byte of one
+#define ANALYZE_LEADER  0x04    // first instruction of a basic block
+#define ANALYZE_SPRITE  0x08    // drawn by DXYN
+#define ANALYZE_DATA    0x10    // loaded or stored by FX33/FX55/FX65
+#define ANALYZE_SMC     0x20    // instruction byte the program itself stores into
+#define ANALYZE_LOOP    0x40    // part of a loop
+#define ANALYZE_INVALID 0x80    // reachable instruction that isn't in the ISA
+
+// what the analysis could not follow (bit vector in `flags`)
+#define ANALYZE_F_INDIRECT  0x01    // a reachable BNNN (code only reached through it is missing)
+#define ANALYZE_F_SMC       0x02    // the program stores into its own code
+#define ANALYZE_F_STORE     0x04    // the program stores through an unknown I (anything may change)
+#define ANALYZE_F_OVERLAP   0x08    // two reachable instructions share a byte
+#define ANALYZE_F_INVALID   0x10    // a reachable instruction isn't in the ISA
+
+// loop flags
+#define ANALYZE_LOOP_IDLE   0x01    // only reads the delay timer/keypad and branches (safe to sleep in)
+#define ANALYZE_LOOP_CALLS  0x02    // calls a subroutine
+
+// capacities (the most instructions 4 KiB can hold, counting odd addresses too)
+#define ANALYZE_MAX_BLOCKS RAM_SIZE
+#define ANALYZE_MAX_SPRITES 256
+
+// a basic block: the instructions from `start` up to (not including) `end`, and where it can go next
+// (1NNN: the target; 2NNN: the target and the return site; a skip: both outcomes; 00EE, BNNN
+// and invalid instructions: nowhere the analysis knows)
+struct analysis_block {
+    uint16_t start;
+    uint16_t end;
+    uint16_t succ[2];
+    uint8_t nsucc;
+    uint8_t reserved;
+    uint16_t loop;      // 1 + index into `loops` (0 = not in a loop)
+};
+
+// a loop: `header` is where it is entered from outside, [lo, hi) covers all of its blocks
+struct analysis_loop {
+    uint16_t header;
+    uint16_t lo;
+    uint16_t hi;
+    uint16_t insns;     // instructions in the loop
+    uint8_t flags;      // ANALYZE_LOOP_*
+    uint8_t reserved;
+};
+
+// a sprite some DXYN draws, and how many DXYN instructions draw it
+struct analysis_sprite {
+    uint16_t addr;
+    uint8_t rows;
+    uint8_t draws;
+};
+
+struct chip8_analysis {
+    uint64_t rom_hash;          // romdb_hash_rom() of the ROM analyzed
+    uint8_t quirks;             // CHIP8_QUIRK_* flags it was analyzed under
+    uint8_t flags;              // ANALYZE_F_*
+    uint16_t entry;             // where execution starts (0x200)
+    uint16_t idle_pc;           // header of the lowest idle loop (0 = none found)
+    uint16_t insns;             // reachable instructions
+    uint16_t nblocks;
+    uint16_t nloops;
+    uint16_t nsprites;
+    uint8_t map[RAM_SIZE];      // ANALYZE_* per RAM byte
+    struct analysis_block blocks[ANALYZE_MAX_BLOCKS];   // sorted by `start`
+    struct analysis_loop loops[ANALYZE_MAX_BLOCKS];     // sorted by `header`
+    struct analysis_sprite sprites[ANALYZE_MAX_SPRITES]; // sorted by address
+};
+
+// analyze a ROM as it runs under the given CHIP8_QUIRK_* flags (NULL on error, e.g., ROM too large)
+struct chip8_analysis *chip8_analyze(const uint8_t *rom, size_t len, uint8_t quirks);
+
+// write an analysis to a sidecar file (false on error)
+// (through a uniquely named temporary file renamed over `path`, so concurrent writers and readers
+// only ever see a complete file)
+bool chip8_analysis_save(const struct chip8_analysis *a, const char *path);
+
+// read a sidecar file back (NULL if missing, damaged, or for another ROM/quirks than given)
+struct chip8_analysis *chip8_analysis_load(const char *path, uint64_t rom_hash, uint8_t quirks);
+
+// the sidecar file name for a ROM hash and quirks in cache directory `dir`: `<dir>/<rom hash>-q<quirks>.c8cfg`
+// (both in hex, so one ROM run under different quirks gets a file per quirks setting)
+void chip8_analysis_path(const char *dir, uint64_t rom_hash, uint8_t quirks, char *buf, size_t len);
+
+// load the analysis of a ROM from its chip8_analysis_path() in `dir`, or analyze it and save it there
+// (saving is best effort; NULL only if the ROM can't be analyzed)
+struct chip8_analysis *chip8_analysis_cached(const char *dir, const uint8_t *rom, size_t len, uint8_t quirks);
+
+// pre-fill a freshly loaded VM's sprite cache with the ROM's sprites (the most drawn ones win slots)
+void chip8_analysis_prewarm(const struct chip8_analysis *a, struct chip8_vm *vm);
+
+// write an annotated disassembly of the ROM (`len` bytes from 0x200) to `out`
+void chip8_analysis_list(const struct chip8_analysis *a, const uint8_t *rom, size_t len, FILE *out);
+
+// render an instruction as assembly
+void chip8_disasm(uint16_t op, char *buf, size_t len);
+
+// (NULL is OK)
+void chip8_analysis_free(struct chip8_analysis *a);
+
+#endif
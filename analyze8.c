@@ -0,0 +1,146 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// we include the static analyzer (and the ROM database for per-title quirks) here
+#include "analyze.h"
+#include "romdb.h"
+
+// makefile-overridable path of the per-ROM settings database (can also be set with the env var GUI8_ROMDB)
+#ifndef ANALYZE8_ROMDB
+#define ANALYZE8_ROMDB "chip8.romdb"
+#endif
+
+// helper to return the (monotonic) time in seconds
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// print what the analysis found
+static void summarize(const struct chip8_analysis *a) {
+    size_t counts[4] = { 0 };   // code, sprite, data, neither (ROM area only)
+    for (int addr = 0x200; addr < RAM_SIZE; ++addr) {
+        uint8_t m = a->map[addr];
+        if (m & (ANALYZE_CODE | ANALYZE_OPERAND)) counts[0]++;
+        else if (m & ANALYZE_SPRITE) counts[1]++;
+        else if (m & ANALYZE_DATA) counts[2]++;
+    }
+
+    printf("ROM hash:       %016llx\n", (unsigned long long)a->rom_hash);
+    printf("quirks:         0x%02x\n", a->quirks);
+    printf("instructions:   %u in %u blocks (%zu code bytes)\n", a->insns, a->nblocks, counts[0]);
+    printf("sprites:        %u (%zu bytes)\n", a->nsprites, counts[1]);
+    printf("data bytes:     %zu\n", counts[2]);
+    printf("loops:          %u\n", a->nloops);
+    for (int l = 0; l < a->nloops; ++l) {
+        const struct analysis_loop *lp = &a->loops[l];
+        printf("    %03X  %03X-%03X  %4u instructions%s%s\n", lp->header, lp->lo, lp->hi - 1, lp->insns,
+                (lp->flags & ANALYZE_LOOP_IDLE) ? "  idle" : "", (lp->flags & ANALYZE_LOOP_CALLS) ? "  calls" : "");
+    }
+    if (a->idle_pc) printf("idle PC:        %03X\n", a->idle_pc);
+    else printf("idle PC:        none\n");
+    if (a->flags) {
+        printf("incomplete:    %s%s%s%s%s\n",
+                (a->flags & ANALYZE_F_INDIRECT) ? " BNNN" : "", (a->flags & ANALYZE_F_SMC) ? " self-modifying" : "",
+                (a->flags & ANALYZE_F_STORE) ? " computed-stores" : "", (a->flags & ANALYZE_F_OVERLAP) ? " overlapping" : "",
+                (a->flags & ANALYZE_F_INVALID) ? " invalid-opcodes" : "");
+    }
+}
+
+// entry point: analyze a ROM, round-trip the result through its sidecar file, and optionally list it
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    FILE *romfile = NULL;
+    struct romdb *romdb = NULL;
+    struct chip8_analysis *a = NULL, *loaded = NULL;
+    static uint8_t rom[RAM_SIZE];
+    const char *dir = NULL;
+    bool listing = false, quirks_given = false;
+    unsigned quirks = CHIP8_QUIRKS_DEFAULT;
+    long expect_idle = -1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "q:d:li:")) != -1) {
+        switch (opt) {
+        case 'q': quirks = strtoul(optarg, NULL, 16); quirks_given = true; break;
+        case 'd': dir = optarg; break;
+        case 'l': listing = true; break;
+        case 'i': expect_idle = strtol(optarg, NULL, 16); break;
+        default: goto usage;
+        }
+    }
+    if (optind != argc - 1 || quirks > 0xff) {
+usage:
+        fprintf(stderr, "usage: %s [-q QUIRKS] [-d DIR] [-l] [-i ADDR] ROM_FILE\n"
+                        "  -q  CHIP8_QUIRK_* flags in hex (default: from the ROM database, else 0x%02x)\n"
+                        "  -d  save the analysis into DIR as a sidecar file (as gui8's GUI8_ANALYSIS cache does) and check it loads back\n"
+                        "  -l  print an annotated disassembly listing\n"
+                        "  -i  fail unless the idle loop found is at ADDR (hex; 0 = expect none)\n",
+                        argv[0], CHIP8_QUIRKS_DEFAULT);
+        goto cleanup;
+    }
+
+    // read the ROM and pick up its quirks from the database, unless given on the command line
+    if ((romfile = fopen(argv[optind], "rb")) == NULL) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", argv[optind]);
+        goto cleanup;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, romfile);
+    const char *romdb_path = getenv("GUI8_ROMDB");
+    if (!quirks_given && (romdb = romdb_open(romdb_path ? romdb_path : ANALYZE8_ROMDB)) != NULL) {
+        const struct romdb_entry *rome = romdb_lookup(romdb, romdb_hash_rom(rom, romlen));
+        if (rome) quirks = rome->quirks;
+    }
+
+    double t0 = now_sec();
+    if ((a = chip8_analyze(rom, romlen, (uint8_t)quirks)) == NULL) {
+        fprintf(stderr, "ERROR: cannot analyze '%s' (too large for RAM?)\n", argv[optind]);
+        goto cleanup;
+    }
+    double t_analyze = now_sec() - t0;
+    summarize(a);
+    printf("analysis:       %.1f us\n", t_analyze * 1e6);
+
+    // the sidecar file has to give back exactly what was analyzed
+    if (dir) {
+        char path[1024];
+        chip8_analysis_path(dir, a->rom_hash, a->quirks, path, sizeof path);
+        if (!chip8_analysis_save(a, path)) {
+            fprintf(stderr, "ERROR: cannot write '%s'\n", path);
+            goto cleanup;
+        }
+        t0 = now_sec();
+        loaded = chip8_analysis_load(path, a->rom_hash, (uint8_t)quirks);
+        double t_load = now_sec() - t0;
+        if (!loaded || memcmp(loaded, a, sizeof *a) != 0) {
+            fprintf(stderr, "ERROR: '%s' does not load back as the same analysis\n", path);
+            goto cleanup;
+        }
+        printf("sidecar:        %s (loads in %.1f us)\n", path, t_load * 1e6);
+    }
+
+    if (listing) {
+        printf("\n");
+        chip8_analysis_list(a, rom, romlen, stdout);
+    }
+
+    if (expect_idle >= 0 && a->idle_pc != expect_idle) {
+        fprintf(stderr, "ERROR: expected the idle loop at %03lX, found %03X\n", expect_idle, a->idle_pc);
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (romfile) fclose(romfile);
+    romdb_close(romdb);
+    chip8_analysis_free(a);
+    chip8_analysis_free(loaded);
+    return ret;
+}
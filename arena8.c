@@ -0,0 +1,110 @@
+// some standard library/system headers
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "arena8.h"
+
+#define HUGE_PAGE (2u << 20)
+
+#define ROUND_UP(n, to) (((n) + (to) - 1) / (to) * (to))
+
+// helper to map the block: reserved huge pages, then (if asked for) a 2 MiB-aligned THP-eligible
+// region, then plain pages; sets a->map/map_len/base/backing (false if nothing could be mapped)
+static bool map_block(struct arena8 *a, size_t len, int flags) {
+#ifdef MAP_HUGETLB
+    if (flags & ARENA8_HUGETLB) {
+        size_t huge_len = ROUND_UP(len, HUGE_PAGE);
+        void *p = mmap(NULL, huge_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            a->map = a->base = p;
+            a->map_len = huge_len;
+            a->backing = "hugetlb";
+            return true;
+        }
+    }
+#endif
+
+    // (with THP, over-map by a huge page so the slots can start on a huge page boundary)
+    bool thp = (flags & ARENA8_THP) != 0;
+    size_t map_len = thp ? ROUND_UP(len, HUGE_PAGE) + HUGE_PAGE : len;
+    void *p = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    a->map = p;
+    a->map_len = map_len;
+    a->base = p;
+    a->backing = "4k";
+#ifdef MADV_HUGEPAGE
+    if (thp) {
+        a->base = (uint8_t *)ROUND_UP((uintptr_t)p, HUGE_PAGE);
+        if (madvise(a->base, ROUND_UP(len, HUGE_PAGE), MADV_HUGEPAGE) == 0) a->backing = "thp";
+    }
+#endif
+    return true;
+}
+
+struct arena8 *arena8_create(size_t slot_size, size_t cap, int flags) {
+    if (!slot_size) slot_size = sizeof(struct chip8_vm);
+    if (!cap || cap > UINT32_MAX) return NULL;
+    struct arena8 *a = calloc(1, sizeof *a);
+    if (!a) return NULL;
+    a->slot_size = slot_size;
+    a->stride = ROUND_UP(slot_size, ARENA8_ALIGN);
+    a->cap = cap;
+
+    size_t len = a->stride * cap;
+    if ((a->free_slots = malloc(sizeof a->free_slots[0] * cap)) == NULL || !map_block(a, len, flags)) {
+        arena8_destroy(a);
+        return NULL;
+    }
+
+    // fault every page in now (one write per 4 KiB page; with huge pages, the first write to each
+    // 2 MiB chunk brings in all of it); fresh anonymous memory reads as zeros either way
+    if (flags & ARENA8_PREFAULT) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < len; off += page) ((volatile uint8_t *)a->base)[off] = 0;
+    }
+    return a;
+}
+
+bool arena8_set_template(struct arena8 *a, const void *obj) {
+    free(a->tmpl);
+    a->tmpl = NULL;
+    if (!obj) return true;
+    if ((a->tmpl = malloc(a->slot_size)) == NULL) return false;
+    memcpy(a->tmpl, obj, a->slot_size);
+    return true;
+}
+
+void *arena8_alloc(struct arena8 *a) {
+    size_t i;
+    if (a->nfree) {
+        i = a->free_slots[--a->nfree];
+    } else if (a->top < a->cap) {
+        i = a->top++;
+    } else {
+        return NULL;
+    }
+    void *slot = arena8_slot(a, i);
+    arena8_reset(a, slot);
+    return slot;
+}
+
+void arena8_reset(const struct arena8 *a, void *slot) {
+    if (a->tmpl) memcpy(slot, a->tmpl, a->slot_size);
+}
+
+void arena8_free(struct arena8 *a, void *slot) {
+    if (!slot) return;
+    a->free_slots[a->nfree++] = (uint32_t)(((uint8_t *)slot - a->base) / a->stride);
+}
+
+void arena8_destroy(struct arena8 *a) {
+    if (!a) return;
+    if (a->map) munmap(a->map, a->map_len);
+    free(a->free_slots);
+    free(a->tmpl);
+    free(a);
+}
@@ -0,0 +1,72 @@
+#ifndef _ARENA8_H
+#define _ARENA8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// SLAB ARENA FOR VM INSTANCES
+//--------------------------------------------------------------
+//
+// One mmap'd block of `cap` fixed-size slots (a struct chip8_vm by default, or any struct
+// that embeds one), each starting on a cache line.  The block can be backed by huge pages
+// (reserved MAP_HUGETLB pages, or transparent huge pages via madvise) and prefaulted up
+// front, so a large batch of VMs costs a handful of TLB entries and no page faults once it
+// is running.
+//
+// Slots come and go in O(1) (a free stack of slot indexes), and with a template set, every
+// allocated slot starts out as a copy of it (e.g., a VM right after chip8_load), which is
+// also what arena8_reset() puts a slot back to.  An arena can also be used as one big
+// aligned array through arena8_slot().  Not thread-safe: one owner allocates and frees
+// (slot contents may of course be worked on from any thread).
+
+#define ARENA8_HUGETLB  0x1     // try reserved huge pages first (MAP_HUGETLB; falls back if none are free)
+#define ARENA8_THP      0x2     // ask for transparent huge pages (2 MiB-aligned block + MADV_HUGEPAGE)
+#define ARENA8_PREFAULT 0x4     // touch every page now instead of on first use
+
+#define ARENA8_ALIGN 64
+
+struct arena8 {
+    uint8_t *base;              // first slot (ARENA8_ALIGN-aligned; 2 MiB-aligned with huge pages)
+    size_t slot_size;           // bytes per object...
+    size_t stride;              // ...rounded up to ARENA8_ALIGN
+    size_t cap;
+    void *map;                  // what mmap returned, and how much of it
+    size_t map_len;
+    const char *backing;        // "hugetlb", "thp" or "4k"
+    size_t top;                 // slots [top, cap) have never been handed out
+    uint32_t *free_slots;       // stack of freed slot indexes
+    size_t nfree;
+    void *tmpl;                 // template object (NULL = none)
+};
+
+// map an arena of `cap` slots of `slot_size` bytes (0 = sizeof(struct chip8_vm)) with ARENA8_* `flags`
+// (NULL on error)
+struct arena8 *arena8_create(size_t slot_size, size_t cap, int flags);
+
+// set the object new/reset slots start out as (copied; NULL = none)
+bool arena8_set_template(struct arena8 *a, const void *obj);
+
+// get a slot (NULL if all `cap` are in use): a copy of the template if there is one, otherwise
+// all zeros the first time a slot is handed out and whatever it last held after that
+void *arena8_alloc(struct arena8 *a);
+
+// put a slot back to the template (no-op without one)
+void arena8_reset(const struct arena8 *a, void *slot);
+
+// give a slot back
+void arena8_free(struct arena8 *a, void *slot);
+
+// slot `i` of the block, allocated or not (for array-style use)
+static inline void *arena8_slot(const struct arena8 *a, size_t i) {
+    return a->base + i * a->stride;
+}
+
+// number of slots currently allocated
+static inline size_t arena8_in_use(const struct arena8 *a) {
+    return a->top - a->nfree;
+}
+
+void arena8_destroy(struct arena8 *a);
+
+#endif
@@ -0,0 +1,86 @@
+// some standard library/system headers
+#include <math.h>
+#include <string.h>
+
+#include "audio8.h"
+
+#define LOAD(v) atomic_load_explicit(&(v), memory_order_relaxed)
+#define STORE(v, x) atomic_store_explicit(&(v), (x), memory_order_relaxed)
+
+// peak amplitude of the wavetables (full volume leaves a little headroom)
+#define PEAK 30000
+
+void audio8_init(struct audio8 *a, int srate) {
+    memset(a, 0, sizeof *a);
+    a->srate = srate;
+
+    // one cycle of each waveform (the whole "precompute" is these 1024 samples)
+    for (int i = 0; i < AUDIO8_TABLE_SIZE; ++i) {
+        float t = (float)i / AUDIO8_TABLE_SIZE;
+        a->tables[AUDIO8_SQUARE][i] = (t < 0.5f) ? PEAK : -PEAK;
+        a->tables[AUDIO8_TRIANGLE][i] = (int16_t)(PEAK * (4.f * fabsf(t - floorf(t + 0.5f)) - 1.f));
+        a->tables[AUDIO8_SINE][i] = (int16_t)(PEAK * sinf(2.f * (float)M_PI * t));
+        a->tables[AUDIO8_SAWTOOTH][i] = (int16_t)(PEAK * (2.f * t - 1.f));
+    }
+
+    STORE(a->wave, AUDIO8_TRIANGLE);
+    STORE(a->volume, 128);
+    audio8_set_freq(a, 440.f);
+}
+
+void audio8_set_wave(struct audio8 *a, enum audio8_wave wave) {
+    if (wave < AUDIO8_NUM_WAVES) STORE(a->wave, wave);
+}
+
+void audio8_set_freq(struct audio8 *a, float hz) {
+    // one table cycle is 2^32 phase units
+    STORE(a->phase_inc, (uint32_t)(hz * 4294967296.0 / a->srate));
+}
+
+void audio8_set_volume(struct audio8 *a, int volume) {
+    STORE(a->volume, volume < 0 ? 0 : volume > 256 ? 256 : volume);
+}
+
+void audio8_set_pattern(struct audio8 *a, const uint8_t pattern[16], uint8_t pitch) {
+    for (int w = 0; w < 4; ++w) {
+        STORE(a->pattern[w], ((uint32_t)pattern[4 * w] << 24) | ((uint32_t)pattern[4 * w + 1] << 16)
+                           | ((uint32_t)pattern[4 * w + 2] << 8) | pattern[4 * w + 3]);
+    }
+    // 128 pattern bits per 2^32 phase units, played at 4000 * 2^((pitch - 64) / 48) bits per second
+    double bits_per_sec = 4000.0 * pow(2.0, (pitch - 64) / 48.0);
+    STORE(a->phase_inc, (uint32_t)(bits_per_sec * (4294967296.0 / 128) / a->srate));
+    STORE(a->wave, AUDIO8_PATTERN);
+}
+
+const char *audio8_wave_name(enum audio8_wave wave) {
+    static const char *names[AUDIO8_NUM_WAVES] = { "square", "triangle", "sine", "sawtooth", "pattern" };
+    return (wave < AUDIO8_NUM_WAVES) ? names[wave] : "?";
+}
+
+void audio8_render(struct audio8 *a, int16_t *out, int n) {
+    // snapshot the parameters once per callback (the loops below then touch nothing shared)
+    uint32_t wave = LOAD(a->wave), inc = LOAD(a->phase_inc), vol = LOAD(a->volume);
+    uint32_t phase = a->phase;
+
+    if (!LOAD(a->gate) || !vol) {
+        memset(out, 0, sizeof *out * n);
+        a->phase = 0; // (start the next beep at the top of the cycle)
+        return;
+    }
+
+    if (wave == AUDIO8_PATTERN) {
+        uint32_t pat[4];
+        for (int w = 0; w < 4; ++w) pat[w] = LOAD(a->pattern[w]);
+        int16_t hi = (int16_t)(PEAK * (int32_t)vol / 256), lo = -hi;
+        for (int i = 0; i < n; ++i, phase += inc) {
+            uint32_t bit = phase >> 25; // (0-127)
+            out[i] = ((pat[bit >> 5] >> (31 - (bit & 31))) & 1) ? hi : lo;
+        }
+    } else {
+        const int16_t *table = a->tables[wave];
+        for (int i = 0; i < n; ++i, phase += inc) {
+            out[i] = (int16_t)((table[phase >> 24] * (int32_t)vol) >> 8);
+        }
+    }
+    a->phase = phase;
+}
@@ -0,0 +1,70 @@
+#ifndef _AUDIO8_H
+#define _AUDIO8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// WAVETABLE TONE GENERATOR (SIGNED 16-BIT MONO OUTPUT)
+//--------------------------------------------------------------
+//
+// A 32-bit phase accumulator steps through a 256-entry single-cycle wavetable (the top
+// 8 bits of the phase pick the entry), so pitch, waveform and volume can all change
+// between any two audio callbacks without regenerating anything.
+//
+// AUDIO8_PATTERN plays an XO-CHIP style 1-bit pattern instead: 128 bits (16 bytes, MSB
+// first) per cycle, clocked at 4000 * 2^((pitch - 64) / 48) bits per second.
+//
+// The setters are meant for the emulator thread and audio8_render() for the audio
+// callback; parameters are plain relaxed atomics, so neither side ever waits.
+
+enum audio8_wave {
+    AUDIO8_SQUARE,
+    AUDIO8_TRIANGLE,
+    AUDIO8_SINE,
+    AUDIO8_SAWTOOTH,
+    AUDIO8_PATTERN,
+    AUDIO8_NUM_WAVES
+};
+
+#define AUDIO8_TABLE_SIZE 256
+
+struct audio8 {
+    int srate;
+    uint32_t phase;                     // (audio thread only)
+    _Atomic uint32_t wave;              // enum audio8_wave
+    _Atomic uint32_t phase_inc;         // phase step per output sample
+    _Atomic uint32_t volume;            // 0-256
+    _Atomic uint32_t gate;              // sound on (1) or off (0)
+    _Atomic uint32_t pattern[4];        // XO-CHIP pattern bits (big-endian words)
+    int16_t tables[AUDIO8_PATTERN][AUDIO8_TABLE_SIZE];
+};
+
+// set up a (silent) generator for `srate` samples per second: triangle wave, 440 Hz, half volume
+void audio8_init(struct audio8 *a, int srate);
+
+// select the waveform
+void audio8_set_wave(struct audio8 *a, enum audio8_wave wave);
+
+// set the wavetable pitch in Hz (ignored by AUDIO8_PATTERN; see audio8_set_pattern)
+void audio8_set_freq(struct audio8 *a, float hz);
+
+// set the volume (0 = silent, 256 = full scale)
+void audio8_set_volume(struct audio8 *a, int volume);
+
+// load a 16-byte XO-CHIP pattern and pitch register value (and switch to AUDIO8_PATTERN)
+void audio8_set_pattern(struct audio8 *a, const uint8_t pattern[16], uint8_t pitch);
+
+// turn the tone on/off (e.g., following the CHIP-8 sound timer)
+static inline void audio8_set_gate(struct audio8 *a, bool on) {
+    atomic_store_explicit(&a->gate, on, memory_order_relaxed);
+}
+
+// name of a waveform (for messages)
+const char *audio8_wave_name(enum audio8_wave wave);
+
+// fill `out` with `n` samples (silence while the gate is off)
+void audio8_render(struct audio8 *a, int16_t *out, int n);
+
+#endif
@@ -0,0 +1,262 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// we include the CHIP-8 VM API (and the on-disk instruction tracer) here
+#include "chip8.h"
+#include "trace.h"
+
+// PER-OPCODE-FAMILY MICROBENCHMARKS
+//--------------------------------------------------------------
+//
+// Each benchmark is a tiny generated ROM: one opcode family's instructions unrolled
+// UNROLL times, then a jump back to the top.  We run it for a fixed number of
+// instructions, REPS times over, and report the median and mean (with a 95% confidence
+// interval) time per instruction, plus instructions-per-clock, branch misses and L1D
+// read misses per emulated instruction from the CPU's performance counters (via
+// perf_event_open; shown as "-" when the kernel won't give us counters, e.g., in a
+// container or with a strict perf_event_paranoid).
+//
+//     bench8 [-r REPS] [-n INSNS] [-t DIR] [FAMILY...]     (default: every family)
+//
+// With -t, every instruction is traced into DIR/FAMILY.c8trace while it runs (compare the
+// times with a run without it to see what capturing a trace costs).
+
+#define UNROLL 32
+#define PROG_START 0x200
+
+struct bench {
+    const char *name;
+    const char *desc;
+    uint16_t unit[4];   // the instruction pattern to unroll (0-terminated if shorter)
+    uint8_t quirks;
+};
+
+static const struct bench benches[] = {
+    { "jump",  "1NNN jump to self",             { 0x1200 },                         CHIP8_QUIRKS_DEFAULT },
+    { "alu",   "8XY1/8XY4/8XY5/8XYE",           { 0x8011, 0x8234, 0x8455, 0x866E }, CHIP8_QUIRKS_DEFAULT },
+    { "load",  "ANNN + FX55/FX65 (V0-V7)",      { 0xA800, 0xF755, 0xA800, 0xF765 }, CHIP8_QUIRKS_DEFAULT },
+    { "draw",  "DXYN 5-row sprite",             { 0xD015 },                         CHIP8_QUIRKS_DEFAULT },
+    { "sprite", "7XNN x2 + moving 15-row DXYN", { 0x7003, 0x7105, 0xD01F },         CHIP8_QUIRKS_DEFAULT },
+    { "keys",  "EX9E/EXA1 key skips",           { 0xE09E, 0xE0A1, 0x6000 },         CHIP8_QUIRKS_DEFAULT },
+};
+#define NUM_BENCHES (int)(sizeof benches / sizeof benches[0])
+
+// hardware counters we ask for (one group, so they are all scheduled together)
+enum { PC_CYCLES, PC_INSNS, PC_BRANCH_MISSES, PC_L1D_MISSES, NUM_COUNTERS };
+
+struct counters {
+    int fd[NUM_COUNTERS];   // fd[PC_CYCLES] is the group leader (-1 if unavailable)
+};
+
+// helper to open one counter (in group `group`, or as a new leader if -1)
+static int open_counter(uint32_t type, uint64_t config, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// helper to set up the counter group (false if the kernel says no)
+static bool counters_open(struct counters *pc) {
+    static const struct { uint32_t type; uint64_t config; } events[NUM_COUNTERS] = {
+        [PC_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        [PC_INSNS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [PC_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        [PC_L1D_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+    for (int i = 0; i < NUM_COUNTERS; ++i) pc->fd[i] = -1;
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        pc->fd[i] = open_counter(events[i].type, events[i].config, i ? pc->fd[0] : -1);
+        if (pc->fd[i] < 0) {
+            for (int j = 0; j < i; ++j) close(pc->fd[j]);
+            pc->fd[0] = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void counters_close(struct counters *pc) {
+    if (pc->fd[0] < 0) return;
+    for (int i = 0; i < NUM_COUNTERS; ++i) close(pc->fd[i]);
+}
+
+// helper to fetch the group's counts (as of the last disable)
+static bool counters_read(const struct counters *pc, uint64_t *out) {
+    uint64_t buf[1 + NUM_COUNTERS];
+    if (read(pc->fd[0], buf, sizeof buf) != (ssize_t)sizeof buf || buf[0] != NUM_COUNTERS) return false;
+    memcpy(out, buf + 1, sizeof(uint64_t) * NUM_COUNTERS);
+    return true;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// helper to build a benchmark's ROM (returns its length)
+static size_t build_rom(const struct bench *b, uint8_t *rom) {
+    size_t len = 0;
+    for (int u = 0; u < UNROLL; ++u) {
+        for (int i = 0; i < 4 && b->unit[i]; ++i) {
+            rom[len++] = b->unit[i] >> 8;
+            rom[len++] = b->unit[i] & 0xff;
+        }
+        if (b->unit[0] >> 12 == 0x1) break; // (a jump-to-self is its own loop)
+    }
+    rom[len++] = 0x10 | (PROG_START >> 8);
+    rom[len++] = PROG_START & 0xff;
+    return len;
+}
+
+// run one benchmark and print its row of the results table (false if the VM failed, or the
+// trace into `trace_dir` (if not NULL) couldn't be written)
+static bool run_bench(const struct bench *b, int reps, uint64_t insns, struct counters *pc, const char *trace_dir) {
+    uint8_t rom[1024];
+    size_t romlen = build_rom(b, rom);
+    struct chip8_vm vm;
+    bool sound = false;
+    double ns[reps];
+    uint64_t totals[NUM_COUNTERS] = { 0 };
+    bool have_counters = pc->fd[0] >= 0;
+    struct trace_writer *tw = NULL;
+
+    if (!chip8_load(&vm, rom, romlen)) return false;
+    chip8_set_quirks(&vm, b->quirks);
+    if (trace_dir) {
+        char path[1024];
+        snprintf(path, sizeof path, "%s/%s.c8trace", trace_dir, b->name);
+        if ((tw = trace_create(path, 0)) == NULL) return false;
+        chip8_attach_tracer(&vm, trace_tracer(tw));
+    }
+
+    // rep -1 is a warm-up (caches, branch predictors, page faults) and isn't recorded
+    for (int r = -1; r < reps; ++r) {
+        uint64_t start_cycles = chip8_get_cycles(&vm);
+        if (have_counters) {
+            ioctl(pc->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(pc->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        uint64_t t0 = now_ns();
+        for (uint64_t n = 0; n < insns; ++n) {
+            if (!chip8_cycle(&vm, 0, 0, &sound)) {
+                chip8_attach_tracer(&vm, NULL);
+                trace_close(tw);
+                return false;
+            }
+        }
+        uint64_t t1 = now_ns();
+        if (have_counters) ioctl(pc->fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (r < 0) continue;
+
+        ns[r] = (double)(t1 - t0) / (double)(chip8_get_cycles(&vm) - start_cycles);
+        uint64_t counts[NUM_COUNTERS];
+        if (have_counters && counters_read(pc, counts)) {
+            for (int i = 0; i < NUM_COUNTERS; ++i) totals[i] += counts[i];
+        } else {
+            have_counters = false;
+        }
+    }
+
+    chip8_attach_tracer(&vm, NULL);
+    if (!trace_close(tw)) return false;
+
+    // median plus mean with a 95% confidence interval (normal approximation)
+    double mean = 0, var = 0;
+    for (int r = 0; r < reps; ++r) mean += ns[r];
+    mean /= reps;
+    for (int r = 0; r < reps; ++r) var += (ns[r] - mean) * (ns[r] - mean);
+    double ci = reps > 1 ? 1.96 * sqrt(var / (reps - 1) / reps) : 0.0;
+    qsort(ns, reps, sizeof ns[0], cmp_double);
+    double median = (reps % 2) ? ns[reps / 2] : (ns[reps / 2 - 1] + ns[reps / 2]) / 2;
+
+    printf("%-6s %-28s %8.2f %8.2f %7.2f", b->name, b->desc, median, mean, ci);
+    if (have_counters && totals[PC_CYCLES]) {
+        double ops = (double)insns * reps;
+        printf(" %6.2f %10.4f %10.4f\n", (double)totals[PC_INSNS] / totals[PC_CYCLES],
+                totals[PC_BRANCH_MISSES] / ops, totals[PC_L1D_MISSES] / ops);
+    } else {
+        printf(" %6s %10s %10s\n", "-", "-", "-");
+    }
+    return true;
+}
+
+// entry point: run the selected microbenchmarks and print a results table
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    int reps = 15;
+    long long insns = 200000;
+    const char *trace_dir = NULL;
+    struct counters pc;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:n:t:")) != -1) {
+        switch (opt) {
+        case 'r': reps = atoi(optarg); break;
+        case 'n': insns = atoll(optarg); break;
+        case 't': trace_dir = optarg; break;
+        default: goto usage;
+        }
+    }
+    if (reps < 1 || reps > 1000 || insns < 1) {
+usage:
+        fprintf(stderr, "usage: %s [-r REPS (1-1000)] [-n INSNS] [-t TRACE_DIR] [FAMILY...]\n", argv[0]);
+        fprintf(stderr, "families:");
+        for (int i = 0; i < NUM_BENCHES; ++i) fprintf(stderr, " %s", benches[i].name);
+        fprintf(stderr, "\n");
+        return ret;
+    }
+    for (int a = optind; a < argc; ++a) {
+        bool known = false;
+        for (int i = 0; i < NUM_BENCHES; ++i) known |= !strcmp(argv[a], benches[i].name);
+        if (!known) {
+            fprintf(stderr, "ERROR: unknown benchmark family '%s'\n", argv[a]);
+            goto usage;
+        }
+    }
+
+    if (!counters_open(&pc)) {
+        fprintf(stderr, "note: hardware performance counters unavailable; reporting times only\n");
+    }
+    printf("%d reps x %lld instructions each\n", reps, insns);
+    printf("%-6s %-28s %8s %8s %7s %6s %10s %10s\n", "family", "instructions",
+            "med ns", "mean ns", "ci95", "IPC", "brmiss/op", "L1Dmiss/op");
+
+    ret = EXIT_SUCCESS;
+    for (int i = 0; i < NUM_BENCHES; ++i) {
+        bool selected = (optind == argc);
+        for (int a = optind; a < argc; ++a) selected |= !strcmp(argv[a], benches[i].name);
+        if (!selected) continue;
+
+        if (!run_bench(&benches[i], reps, (uint64_t)insns, &pc, trace_dir)) {
+            fprintf(stderr, "ERROR: benchmark '%s' stopped with an illegal instruction (or its trace failed)\n", benches[i].name);
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    counters_close(&pc);
+    return ret;
+}
@@ -1,6 +1,6 @@
 #include "chip8.h" 
-#include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 
 
 #define PROG_START 0x200
@@ -14,6 +14,12 @@
 
 #define FONT_CHAR_SIZE 5
 
+// seed used by chip8_load (any constant works; this one is the 64-bit golden ratio)
+#define DEFAULT_RNG_SEED 0x9e3779b97f4a7c15ull
+
+// seed for chip8_state_hash (distinct from ROM/framebuffer hash seeds, so the values never get mixed up)
+#define STATE_HASH_SEED 0x5354415445483634ull
+
 // Define the font sprites for the CHIP-8 interpreter
 static const uint8_t chip8_font_sprites[] = {
     0xf0, 0x90, 0x90, 0x90, 0xf0, // "0"
@@ -34,6 +40,176 @@ static const uint8_t chip8_font_sprites[] = {
     0xf0, 0x80, 0xf0, 0x80, 0x80  // "F"
 };
 
+// Function to seed the per-VM random number generator
+void chip8_seed(struct chip8_vm *vm, uint64_t seed) {
+    // scramble the seed (splitmix64 finalizer) so that small/similar seeds give unrelated sequences
+    seed += DEFAULT_RNG_SEED;
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ull;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebull;
+    seed ^= seed >> 31;
+    vm->rng = seed ? seed : DEFAULT_RNG_SEED; // xorshift gets stuck on an all-zero state
+}
+
+// Function to draw the next 8 random bits from the per-VM generator (xorshift64*)
+static inline uint8_t chip8_random(struct chip8_vm *vm) {
+    uint64_t s = vm->rng;
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    vm->rng = s;
+    return (uint8_t)((s * 0x2545f4914f6cdd1dull) >> 56); // the high bits are the best-mixed ones
+}
+
+// Function to select which interpreter quirks the VM emulates
+void chip8_set_quirks(struct chip8_vm *vm, uint8_t quirks) {
+    vm->quirks = quirks;
+}
+
+// Function to mix one 64-bit word into a hash value (multiply-rotate, in the style of xxHash/wyhash)
+static inline uint64_t hash_round(uint64_t h, uint64_t w) {
+    h ^= w * 0x9e3779b97f4a7c15ull;
+    h = (h << 31) | (h >> 33);
+    return h * 0xc2b2ae3d27d4eb4full;
+}
+
+// Function to hash a block of bytes 8 at a time (used for ROM identification and state fingerprints)
+uint64_t chip8_hash(const void *data, size_t len, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t h = seed ^ (len * 0x165667b19e3779f9ull);
+    uint64_t w;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&w, p, 8); // (compilers turn this into a single unaligned load)
+        h = hash_round(h, w);
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, p, len);
+        h = hash_round(h, w);
+    }
+
+    // final avalanche so every input bit affects every output bit
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 29;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Function to give a RAM (address, value) pair or a framebuffer row its key in the running fingerprints
+// (a bijective mix, so distinct RAM keys never collide)
+static inline uint64_t zobrist(uint64_t key) {
+    key = (key ^ (key >> 31)) * 0x9e3779b97f4a7c15ull;
+    key = (key ^ (key >> 29)) * 0xbf58476d1ce4e5b9ull;
+    return key ^ (key >> 32);
+}
+#define RAM_KEY(addr, val) zobrist(((uint64_t)(addr) << 8) | (val))
+#define ROW_KEY(row, bits) zobrist((bits) + ((row) + 1) * 0x9e3779b97f4a7c15ull)
+
+// sprite cache line bit for a RAM address (matches vm->sprite_lines)
+#define SPRITE_LINE(addr) (1ull << (((addr) & ADDRESS_MASK) >> 6))
+
+// Function to drop every cached sprite that covers a RAM address (slow path: only runs when a
+// write changes a byte on a line holding one)
+static void sprite_invalidate(struct chip8_vm *vm, uint16_t addr) {
+    vm->sprite_lines = 0;
+    for (int e = 0; e < CHIP8_SPRITE_CACHE; ++e) {
+        struct chip8_sprite *spr = &vm->sprites[e];
+        if (!spr->key) continue;
+        uint16_t start = spr->key >> 4, n = spr->key & 0xF;
+        if (((addr - start) & ADDRESS_MASK) < n) {
+            spr->key = 0;
+        } else {
+            vm->sprite_lines |= SPRITE_LINE(start) | SPRITE_LINE(start + n - 1);
+        }
+    }
+}
+
+// Function to write a byte of RAM, keeping the running RAM fingerprint (and the sprite cache) up to date
+static inline void ram_store(struct chip8_vm *vm, uint16_t addr, uint8_t val) {
+    if ((vm->sprite_lines & SPRITE_LINE(addr)) && vm->ram[addr] != val) sprite_invalidate(vm, addr);
+    vm->ram_hash ^= RAM_KEY(addr, vm->ram[addr] & 0xff) ^ RAM_KEY(addr, val);
+    vm->ram[addr] = val;
+}
+
+// Function to fingerprint everything that decides what the VM does next
+// (V through SP is one padding-free run of fields; RAM and framebuffer come from their running fingerprints)
+uint64_t chip8_state_hash(const struct chip8_vm *vm) {
+    size_t regs = offsetof(struct chip8_vm, V);
+    uint64_t h = chip8_hash((const uint8_t *)vm + regs, offsetof(struct chip8_vm, sp) + sizeof vm->sp - regs, STATE_HASH_SEED);
+    h = hash_round(h, vm->rng);
+    h = hash_round(h, vm->quirks);
+    h = hash_round(h, vm->ram_hash);
+    return hash_round(h, vm->fb_hash);
+}
+
+// Function to recompute the VM's per-page "anything watched here?" bits from its watchpoint set
+static void watch_compile_pages(struct chip8_vm *vm) {
+    const int words_per_page = CHIP8_WATCH_PAGE_SIZE / 64;
+    vm->watch_rpages = vm->watch_wpages = 0;
+    if (!vm->watch) return;
+    for (int w = 0; w < RAM_SIZE / 64; ++w) {
+        if (vm->watch->read[w]) vm->watch_rpages |= 1u << (w / words_per_page);
+        if (vm->watch->write[w]) vm->watch_wpages |= 1u << (w / words_per_page);
+    }
+}
+
+// Function to attach/detach a watchpoint set
+void chip8_attach_watches(struct chip8_vm *vm, struct chip8_watchset *ws) {
+    vm->watch = ws;
+    watch_compile_pages(vm);
+}
+
+// Function to add/remove watchpoints on a range of RAM
+void chip8_watch_range(struct chip8_vm *vm, uint16_t addr, uint16_t len, int kinds, bool on) {
+    if (!vm->watch) return;
+    for (uint16_t i = 0; i < len; ++i) {
+        uint16_t a = (addr + i) & ADDRESS_MASK;
+        uint64_t bit = 1ull << (a & 63);
+        if (kinds & CHIP8_WATCH_READ) {
+            if (on) vm->watch->read[a >> 6] |= bit; else vm->watch->read[a >> 6] &= ~bit;
+        }
+        if (kinds & CHIP8_WATCH_WRITE) {
+            if (on) vm->watch->write[a >> 6] |= bit; else vm->watch->write[a >> 6] &= ~bit;
+        }
+    }
+    watch_compile_pages(vm);
+}
+
+// page bit for a RAM address (matches vm->watch_rpages/watch_wpages)
+#define WATCH_PAGE(addr) (1u << (((addr) & ADDRESS_MASK) / CHIP8_WATCH_PAGE_SIZE))
+
+// Function to report an access to a watched page (slow path: only runs when the page bit is set)
+static void watch_access(struct chip8_vm *vm, uint16_t addr, uint8_t old_val, uint8_t new_val, bool write) {
+    struct chip8_watchset *ws = vm->watch;
+    addr &= ADDRESS_MASK;
+    const uint64_t *bits = write ? ws->write : ws->read;
+    if (((bits[addr >> 6] >> (addr & 63)) & 1) && ws->handler) {
+        struct chip8_watch_hit hit = {
+            .pc = (vm->pc - 2) & ADDRESS_MASK,  // (PC has already moved past the instruction)
+            .addr = addr,
+            .old_val = old_val,
+            .new_val = new_val,
+            .write = write,
+        };
+        ws->handler(ws->ctx, &hit);
+    }
+}
+
+// helpers for the memory-touching instructions: check the page bit inline, everything else out-of-line
+#define WATCH_READ(vm, addr) do { \
+    if ((vm)->watch_rpages & WATCH_PAGE(addr)) { \
+        uint8_t val_ = (vm)->ram[(addr)]; \
+        watch_access((vm), (addr), val_, val_, false); \
+    } \
+} while (0)
+#define WATCH_WRITE(vm, addr, new_val) do { \
+    if ((vm)->watch_wpages & WATCH_PAGE(addr)) { \
+        watch_access((vm), (addr), (vm)->ram[(addr)], (new_val), true); \
+    } \
+} while (0)
+
 // Function to load a program into the CHIP-8 VM
 bool chip8_load(struct chip8_vm *vm, uint8_t *program, size_t proglen) {
     // Check if the program length exceeds available memory space
@@ -41,6 +217,9 @@ bool chip8_load(struct chip8_vm *vm, uint8_t *program, size_t proglen) {
         return false; // Return false if program is too large
     }
 
+    // Start from an all-zero VM (registers, stack, framebuffer) so every load is reproducible
+    memset(vm, 0, sizeof *vm);
+
     // Load font sprites into memory
     for (size_t i = 0; i < sizeof(chip8_font_sprites); i++) {
         vm->ram[FONT_ADDRESS + i] = chip8_font_sprites[i];
@@ -51,46 +230,124 @@ bool chip8_load(struct chip8_vm *vm, uint8_t *program, size_t proglen) {
         vm->ram[PROG_START + i] = program[i];
     }
 
+    // and fingerprint the whole RAM and the blank framebuffer once (writes keep them current from here on)
+    for (size_t i = 0; i < RAM_SIZE; i++) {
+        vm->ram_hash ^= RAM_KEY(i, vm->ram[i]);
+    }
+    for (size_t row = 0; row < FB_ROWS; row++) {
+        vm->fb_hash ^= ROW_KEY(row, 0);
+    }
+
     // Initialize the CHIP-8 VM registers and timers
     vm->pc = PROG_START; // Set the program counter to the start of the program
     vm->I = 0;           // Initialize the index register to 0
     vm->sp = 0;          // Initialize the stack pointer to 0
     vm->delay_timer = 0; // Initialize the delay timer to 0
     vm->sound_timer = 0; // Initialize the sound timer to 0
+    chip8_seed(vm, 0);   // Same default random sequence for every load
+    vm->quirks = CHIP8_QUIRKS_DEFAULT;
 
     return true; // Return true if the program was loaded successfully
 }
 
-// Function to execute one cycle of the CHIP-8 VM
-bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
+// Function to find the `n`-row sprite at `addr` in the cache, pre-shifting it into its slot on a miss
+static inline const struct chip8_sprite *sprite_lookup(struct chip8_vm *vm, uint16_t addr, uint8_t n) {
+    uint16_t key = (uint16_t)(addr << 4 | n);
+    struct chip8_sprite *spr = &vm->sprites[(uint16_t)(key * 40503u) >> (16 - 4)]; // (Fibonacci hashing into 16 slots)
+    if (spr->key == key) return spr;
+
+    for (uint8_t r = 0; r < n; ++r) {
+        uint8_t b = vm->ram[(addr + r) & ADDRESS_MASK];
+        b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);  // (bit-reverse: leftmost pixel in bit 0)
+        b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+        b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+        for (int s = 0; s < 8; ++s) spr->mask[s][r] = (uint16_t)(b << s);
+    }
+    spr->key = key;
+    vm->sprite_lines |= SPRITE_LINE(addr) | SPRITE_LINE(addr + n - 1);
+    return spr;
+}
+
+// Function to fill a sprite cache slot before the first DXYN that needs it
+void chip8_prewarm_sprite(struct chip8_vm *vm, uint16_t addr, uint8_t n) {
+    if (n == 0 || n > 15) return;
+    sprite_lookup(vm, addr & ADDRESS_MASK, n);
+}
+
+// Function to spread a byte's bits over the low bits of 8 bytes (bit k -> byte k), for XORing 8 pixels
+// of the byte-per-pixel framebuffer at once (odd and even bits are multiplied out separately so the
+// partial products never overlap; byte k is the k-th in memory on little-endian hosts)
+static inline uint64_t spread_bits(uint8_t b) {
+    const uint64_t m = 0x0002040810204081ull;
+    return ((b & 0x55) * m | (b & 0xAA) * m) & 0x0101010101010101ull;
+}
+
+// Function to flip the pixels a byte's set bits select, 8 framebuffer bytes at a time
+static inline void xor_pixels(uint8_t *p, uint8_t b) {
+    uint64_t w;
+    if (!b) return;
+    memcpy(&w, p, 8);
+    w ^= spread_bits(b);
+    memcpy(p, &w, 8);
+}
+
+// Function to XOR an `n`-row sprite from I onto the framebuffer at (V[x], V[y]) (the start wraps around
+// the screen, the sprite itself is clipped at the right and bottom edges; VF = any pixel turned off)
+static inline void draw_sprite(struct chip8_vm *vm, uint8_t x, uint8_t y, uint8_t n) {
+    unsigned col0 = vm->V[x] % FB_COLS, row0 = vm->V[y] % FB_ROWS;
+    unsigned base = col0 & ~7u;
+    uint64_t collided = 0;
+    if (n) {
+        uint16_t addr = vm->I & ADDRESS_MASK;
+        const uint16_t *masks = sprite_lookup(vm, addr, n)->mask[col0 & 7];
+        for (unsigned r = 0; r < n && row0 + r < FB_ROWS; ++r) {
+            WATCH_READ(vm, (addr + r) & ADDRESS_MASK);
+            unsigned row = row0 + r;
+            uint64_t old = vm->fb_rows[row];
+            uint64_t bits = (uint64_t)masks[r] << base;    // (anything past column 63 falls off)
+            collided |= old & bits;
+            vm->fb_rows[row] = old ^ bits;
+            vm->fb_hash ^= ROW_KEY(row, old) ^ ROW_KEY(row, old ^ bits);
+            xor_pixels(&vm->fb[row][base], (uint8_t)masks[r]);
+            if (base + 8 < FB_COLS) xor_pixels(&vm->fb[row][base + 8], (uint8_t)(masks[r] >> 8));
+        }
+    }
+    vm->V[0xF] = collided != 0;
+}
+
+// Function to start/stop tracing
+void chip8_attach_tracer(struct chip8_vm *vm, struct chip8_tracer *t) {
+    vm->trace = t;
+}
+
+// Function to execute one cycle of the CHIP-8 VM (the interpreter proper; see chip8_cycle)
+static inline bool execute(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
     uint16_t opcode = (vm->ram[vm->pc] << 8) | vm->ram[vm->pc + 1];
     uint8_t x = (opcode & 0x0F00) >> 8;
     uint8_t y = (opcode & 0x00F0) >> 4;
-    uint16_t sum = vm->V[x] + vm->V[y];
-    printf("%u\n", vm->V[y]);
 
-    printf("PC: 0x%04X, Opcode: 0x%04X\n", vm->pc, opcode);
     vm->pc += 2;
+    vm->cycles++;
 
     switch (opcode & 0xF000) {
         case 0xA000:
             vm->I = opcode & 0x0FFF;
             break;
         case 0xC000:
-            vm->V[x] = (rand() % 256) & (opcode & 0x00FF);
+            vm->V[x] = chip8_random(vm) & (opcode & 0x00FF);
             break;
         case 0xD000:
-            // Implement drawing logic here
+            draw_sprite(vm, x, y, opcode & 0x000F);
             break;
         case 0xE000:
             switch (opcode & 0x00FF) {
                 case 0x009E:
-                    if (vm->keys[vm->V[x]]) {
+                    if ((keys >> (vm->V[x] & 0xF)) & 1) {
                         vm->pc += 2;
                     }
                     break;
                 case 0x00A1:
-                    if (!vm->keys[vm->V[x]]) {
+                    if (!((keys >> (vm->V[x] & 0xF)) & 1)) {
                         vm->pc += 2;
                     }
                     break;
@@ -100,15 +357,19 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
             switch (opcode & 0x00FF) {
                 case 0x0055:
                     for (uint8_t i = 0; i <= x; i++) {
-                        vm->ram[vm->I + i] = vm->V[i];
+                        uint16_t addr = (vm->I + i) & ADDRESS_MASK;  // (a stray I wraps around RAM, never past it)
+                        WATCH_WRITE(vm, addr, vm->V[i]);
+                        ram_store(vm, addr, vm->V[i]);
                     }
-                    vm->I += x + 1;
+                    if (vm->quirks & CHIP8_QUIRK_MEMORY_I) vm->I += x + 1;
                     break;
                 case 0x0065:
                     for (uint8_t i = 0; i <= x; i++) {
-                        vm->V[i] = vm->ram[vm->I + i];
+                        uint16_t addr = (vm->I + i) & ADDRESS_MASK;
+                        WATCH_READ(vm, addr);
+                        vm->V[i] = vm->ram[addr];
                     }
-                    vm->I += x + 1;
+                    if (vm->quirks & CHIP8_QUIRK_MEMORY_I) vm->I += x + 1;
                     break;
             }
             break;
@@ -117,12 +378,10 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
                 if (vm->sp > 0) {
                     vm->pc = vm->stack[--vm->sp];
                 } else {
-                    printf("Stack underflow\n");
-                    return false;
+                    return false;   // (stack underflow)
                 }
             } else {
-                printf("Unknown 0x0000 opcode: 0x%04X\n", opcode);
-                return false;
+                return false;       // (unknown 0x0000 opcode)
             }
             break;
         case 0x1000:
@@ -133,8 +392,7 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
                 vm->stack[vm->sp++] = vm->pc;
                 vm->pc = opcode & 0x0FFF;
             } else {
-                printf("Stack overflow\n");
-                return false;
+                return false;       // (stack overflow)
             }
             break;
         case 0x3000: {
@@ -175,20 +433,17 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
                     break;
                 case 0x0001:
                     vm->V[x] |= vm->V[y];
-                    vm->V[0xF] = 0;
+                    if (vm->quirks & CHIP8_QUIRK_VF_RESET) vm->V[0xF] = 0;
                     break;
                 case 0x0002:
                     vm->V[x] &= vm->V[y];
-                    vm->V[0xF] = 0;
+                    if (vm->quirks & CHIP8_QUIRK_VF_RESET) vm->V[0xF] = 0;
                     break;
                 case 0x0003:
                     vm->V[x] ^= vm->V[y];
-                    vm->V[0xF] = 0;
+                    if (vm->quirks & CHIP8_QUIRK_VF_RESET) vm->V[0xF] = 0;
                     break;
                 case 0x0004:
-                printf("%u",vm->V[y]);
-                    
-                      
                     if (vm->V[x] + vm->V[y] > 0xFF) {
                         vm->V[0xF] = 1;
                     } else {
@@ -201,21 +456,25 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
                     vm->V[0xF] = (vm->V[x] > vm->V[y]) ? 1 : 0;
                     vm->V[x] -= vm->V[y];
                     break;
-                case 0x0006:
-                    vm->V[0xF] = 0;              // Clear carry flag (VF)
-                    vm->V[0xF] = vm->V[x] & 0x1; // Set VF to the least significant bit of V[x]
-                    vm->V[x] >> 1;              // Shift V[x] right by 1
+                case 0x0006: {
+                    // (original COSMAC VIP behavior: VX = VY shifted, VF = the bit shifted out, set last)
+                    uint8_t bit = vm->V[y] & 0x1;
+                    vm->V[x] = vm->V[y] >> 1;
+                    vm->V[0xF] = bit;
+                    break;
+                }
                 case 0x0007:
                     vm->V[0xF] = (vm->V[y] > vm->V[x]) ? 1 : 0;
                     vm->V[x] = vm->V[y] - vm->V[x];
                     break;
-                case 0x000E:
-                    vm->V[0xF] = (vm->V[x] & 0x80) >> 7;
-                    vm->V[x] <<= 1;
+                case 0x000E: {
+                    uint8_t bit = (vm->V[y] & 0x80) >> 7;
+                    vm->V[x] = (uint8_t)(vm->V[y] << 1);
+                    vm->V[0xF] = bit;
                     break;
+                }
                 default:
-                    printf("Unknown 0x8000 opcode: 0x%04X\n", opcode);
-                    return false;
+                    return false;   // (unknown 0x8000 opcode)
             }
             break;
         case 0x9000: {
@@ -225,8 +484,7 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
             break;
         }
         default:
-            printf("Unknown opcode: 0x%04X\n", opcode);
-            return false;
+            return false;           // (unknown opcode)
     }
 
     if (vm->delay_timer > 0) vm->delay_timer--;
@@ -241,6 +499,79 @@ bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound)
 }
 
 
+// Function to execute one cycle while recording what it did into the attached tracer
+// (out of line, so the untraced path stays as lean as before)
+static bool traced_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
+    struct chip8_tracer *t = vm->trace;
+    uint16_t i_before = vm->I;
+    uint16_t pc = vm->pc & ADDRESS_MASK;
+    uint16_t opcode = (vm->ram[pc] << 8) | vm->ram[(pc + 1) & ADDRESS_MASK];
+
+    // only VX and VF can change, or V0-VX for FX65: keep just those (byte loads; reading V back as
+    // wider words right after execute's byte stores stalls on store forwarding, and costs more
+    // than the instruction itself)
+    uint8_t x = (opcode >> 8) & 0xF, vx = vm->V[x], vf = vm->V[0xF], before[16];
+    bool loads = (opcode & 0xF0FF) == 0xF065;
+    if (loads) {
+        for (int i = 0; i < x; ++i) before[i] = vm->V[i];
+    }
+
+    bool ok = execute(vm, keys, vtick, sound);
+
+    struct chip8_trace_record r = {
+        .vtick = (uint32_t)vtick,
+        .pc = pc,
+        .opcode = opcode,
+        .flags = ok ? 0 : CHIP8_TRACE_FAIL,
+    };
+
+    // the lowest-numbered V register that changed (VF only counts as "the" register if nothing else did)
+    int reg = (x != 0xF && vm->V[x] != vx) ? x : -1;
+    for (int i = 0; loads && i < x; ++i) {
+        if (vm->V[i] != before[i]) {
+            reg = i;
+            break;
+        }
+    }
+    bool vf_changed = vm->V[0xF] != vf;
+    if (reg >= 0) {
+        r.reg = (uint8_t)reg;
+        r.reg_val = vm->V[reg];
+        r.flags |= CHIP8_TRACE_REG | (vf_changed ? CHIP8_TRACE_VF : 0);
+    } else if (vf_changed) {
+        r.reg = 0xF;
+        r.reg_val = vm->V[0xF];
+        r.flags |= CHIP8_TRACE_REG;
+    } else if (vm->I != i_before) {
+        r.reg = CHIP8_TRACE_REG_I;
+        r.reg_val = vm->I;
+        r.flags |= CHIP8_TRACE_REG;
+    }
+
+    // FX55 is the only instruction that stores to RAM
+    if (ok && (r.opcode & 0xF0FF) == 0xF055) {
+        r.flags |= CHIP8_TRACE_MEM;
+        r.mem_addr = i_before & ADDRESS_MASK;
+        r.mem_len = ((r.opcode >> 8) & 0xF) + 1;
+        r.mem_val = vm->V[0];
+    }
+
+    t->buf[t->len] = r;
+    if (++t->len == t->cap) t->flush(t);
+    return ok;
+}
+
+// Function to execute one cycle of the CHIP-8 VM
+bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
+    if (vm->trace) return traced_cycle(vm, keys, vtick, sound);
+    return execute(vm, keys, vtick, sound);
+}
+
+// Function to get the number of instructions executed since the program was loaded
+uint64_t chip8_get_cycles(struct chip8_vm *vm) {
+    return vm->cycles;
+}
+
 // Function to get the current value of the program counter
 uint16_t chip8_get_pc(struct chip8_vm *vm) {
     return vm->pc; // Return the value of the program counter
@@ -287,6 +618,6 @@ uint8_t chip8_get_ram(struct chip8_vm *vm, uint16_t address) {
 // Function to set a new value for a specific memory address
 void chip8_set_ram(struct chip8_vm *vm, uint16_t address, uint8_t new_val) {
     if (address < RAM_SIZE) {
-        vm->ram[address] = new_val; // Set the memory address to the new value
+        ram_store(vm, address, new_val); // Set the memory address to the new value
     }
 }
\ No newline at end of file
@@ -13,6 +13,90 @@
 #define FB_COLS 64	// framebuffer is 64 pixels _wide_
 #define FB_ROWS 32	// by 32 pixels _tall_
 
+// compatibility "quirk" flags (bit vector) for behaviors that differ between CHIP-8 interpreters
+#define CHIP8_QUIRK_VF_RESET 0x01	// 8XY1/8XY2/8XY3 clear VF (original COSMAC VIP behavior)
+#define CHIP8_QUIRK_MEMORY_I 0x02	// FX55/FX65 leave I pointing just past the last register stored/loaded
+#define CHIP8_QUIRKS_DEFAULT (CHIP8_QUIRK_VF_RESET | CHIP8_QUIRK_MEMORY_I)
+
+
+// MEMORY WATCHPOINTS
+//--------------------------------------------------------------
+
+// kinds of access a watchpoint can trigger on (bit vector)
+#define CHIP8_WATCH_READ 0x1
+#define CHIP8_WATCH_WRITE 0x2
+
+// size of the RAM "pages" the VM keeps a quick is-anything-watched-here bit for
+#define CHIP8_WATCH_PAGE_SIZE 256
+
+// what a watchpoint handler gets told about the access that triggered it
+struct chip8_watch_hit {
+    uint16_t pc;        // address of the instruction doing the access
+    uint16_t addr;      // RAM address accessed
+    uint8_t old_val;    // value before the access
+    uint8_t new_val;    // value after the access (same as `old_val` for reads)
+    bool write;
+};
+
+// host-owned set of watched addresses (one bit per RAM address per access kind)
+// plus the handler to call (from inside chip8_cycle) when one of them is accessed
+struct chip8_watchset {
+    uint64_t read[RAM_SIZE / 64];
+    uint64_t write[RAM_SIZE / 64];
+    void (*handler)(void *ctx, const struct chip8_watch_hit *hit);
+    void *ctx;
+};
+
+
+// INSTRUCTION TRACING
+//--------------------------------------------------------------
+
+// what changed in a traced instruction (bit vector)
+#define CHIP8_TRACE_REG 0x01    // register `reg` now holds `reg_val`
+#define CHIP8_TRACE_VF 0x02     // VF changed too (as a flag result, besides `reg`)
+#define CHIP8_TRACE_MEM 0x04    // `mem_len` bytes of RAM were written at `mem_addr` (the first one is `mem_val`)
+#define CHIP8_TRACE_FAIL 0x08   // the instruction failed (chip8_cycle returned false)
+
+// `reg` value meaning "the I register" (0x0-0xF are V0-VF)
+#define CHIP8_TRACE_REG_I 0x10
+
+// one executed instruction (fixed 16-byte record; also the on-disk trace format, little-endian)
+struct chip8_trace_record {
+    uint32_t vtick;     // (low 32 bits)
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t reg_val;
+    uint16_t mem_addr;
+    uint8_t reg;
+    uint8_t mem_val;
+    uint8_t mem_len;
+    uint8_t flags;      // CHIP8_TRACE_*
+};
+
+// host-owned trace buffer the VM appends records to (see trace.h for one that streams them to disk)
+// (chip8_cycle fills `buf` and calls `flush` the moment it is full, which must hand back an empty one)
+struct chip8_tracer {
+    struct chip8_trace_record *buf;
+    uint32_t len;
+    uint32_t cap;
+    void (*flush)(struct chip8_tracer *t);
+};
+
+
+// PRE-SHIFTED SPRITE CACHE
+//--------------------------------------------------------------
+
+// entries in each VM's DXYN sprite cache (direct-mapped on address and height; a power of 2)
+#define CHIP8_SPRITE_CACHE 16
+
+// an `n`-row sprite at some RAM address, pre-shifted to each of the 8 bit offsets within a byte:
+// drawing row r at column c covers the 16 columns starting at c & ~7 with mask[c & 7][r]
+// (bit k = column (c & ~7) + k, i.e., the sprite byte bit-reversed and shifted left by c & 7)
+struct chip8_sprite {
+    uint16_t key;           // address << 4 | n (0 = empty slot; 0-row sprites are never cached)
+    uint16_t mask[8][15];
+};
+
 
 // THE CORE CHIP-8 VIRTUAL MACHINE (VM) OBJECT TYPE
 //--------------------------------------------------------------
@@ -49,6 +133,42 @@ struct chip8_vm {
     //stack pointer
     uint16_t sp;
 
+    // private pseudo-random number generator state (xorshift64*) used by Cxnn
+    // (never zero; lives in the VM so copies/snapshots of a VM replay identically)
+    uint64_t rng;
+
+    // active CHIP8_QUIRK_* flags (chip8_load sets CHIP8_QUIRKS_DEFAULT)
+    uint8_t quirks;
+
+    // incremental fingerprints of RAM and the framebuffer for chip8_state_hash: the XOR of a
+    // 64-bit key per (address, byte value) and per (row, contents of that row), updated by every
+    // write the VM makes (so RAM must be changed through chip8_set_ram, never poked directly)
+    uint64_t ram_hash;
+    uint64_t fb_hash;
+
+    // number of instructions executed since chip8_load
+    uint64_t cycles;
+
+    // memory watchpoints: the attached set (NULL if none) and one bit per
+    // CHIP8_WATCH_PAGE_SIZE page saying whether that page has any reads/writes watched
+    // (the memory-touching instructions only look any further when their page's bit is set)
+    struct chip8_watchset *watch;
+    uint16_t watch_rpages;
+    uint16_t watch_wpages;
+
+    // instruction tracer (NULL = not tracing; see chip8_attach_tracer)
+    struct chip8_tracer *trace;
+
+    // DXYN's sprite cache (filled the first time a sprite is drawn) and one bit per 64-byte line of
+    // RAM that holds a cached sprite's bytes (a write that changes such a line drops the affected
+    // entries); derived from RAM, so chip8_state_hash ignores it and copies of a VM stay correct
+    struct chip8_sprite sprites[CHIP8_SPRITE_CACHE];
+    uint64_t sprite_lines;
+
+    // the framebuffer again as one bit per pixel (bit c of row r = fb[r][c]), kept in step with `fb`
+    // by DXYN so collisions are one AND per sprite row and the fingerprint is updated per row
+    uint64_t fb_rows[FB_ROWS];
+
 
     // framebuffer: 1 byte per pixel in a FB_COLS x FB_ROWS matrix
     // (0 = pixel off, 1 = pixel on, all other values = undefined/error)
@@ -68,13 +188,49 @@ bool chip8_load(struct chip8_vm *vm, uint8_t *program, size_t proglen);
 // `keys` := 16-bit bit vector given the up (0) or down (1) state of the 16-key keypad
 // `vtick` := 60Hz vsync clock (or alternatively, the frame count)
 // `sound` := pointer to bool that controls the on/off of the beep generator (true == on, false == off)
-// (reason for failure: tried to execute an invalid/unsupported machine instruction, stack overflow/underflow)
+// (reason for failure: tried to execute an invalid/unsupported machine instruction, stack overflow/underflow;
+// the core never prints anything itself, so reporting it is up to the host)
 bool chip8_cycle(struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound);
 
+// seed the VM's private random number generator (used by the Cxnn instruction)
+// (chip8_load seeds every VM with the same default, so a program + key inputs replays bit-exactly;
+// call this after chip8_load to get a different, but still reproducible, random sequence)
+void chip8_seed(struct chip8_vm *vm, uint64_t seed);
+
+// select the CHIP8_QUIRK_* behaviors the VM should emulate (call after chip8_load)
+void chip8_set_quirks(struct chip8_vm *vm, uint8_t quirks);
+
+// attach a (zeroed or pre-filled) watchpoint set to the VM, or detach with NULL (call after chip8_load)
+void chip8_attach_watches(struct chip8_vm *vm, struct chip8_watchset *ws);
+
+// start (or with NULL, stop) recording every executed instruction into a tracer (any time after chip8_load)
+void chip8_attach_tracer(struct chip8_vm *vm, struct chip8_tracer *t);
+
+// watch (`on`) or unwatch `len` bytes of RAM starting at `addr` for CHIP8_WATCH_* `kinds` of access
+// (the VM must have a watchpoint set attached)
+void chip8_watch_range(struct chip8_vm *vm, uint16_t addr, uint16_t len, int kinds, bool on);
+
+// pre-shift the `n`-row sprite at `addr` into the DXYN sprite cache ahead of its first draw (e.g., from a
+// static analysis of the ROM; the cache is derived from RAM, so this never changes what the VM does)
+void chip8_prewarm_sprite(struct chip8_vm *vm, uint16_t addr, uint8_t n);
+
+// fast, non-cryptographic 64-bit hash of `len` bytes (e.g., to identify a ROM image before loading it)
+// (results are stable across runs and little-endian hosts, so they can be stored in files)
+uint64_t chip8_hash(const void *data, size_t len, uint64_t seed);
+
+// fingerprint of the VM's whole emulated state: RAM, registers, stack, timers, RNG, quirks and framebuffer
+// (two VMs with equal hashes behave identically from here on; the cycle count and any attached
+// watchpoints/tracer are left out, so clones that converge on the same state hash the same;
+// RAM and framebuffer are covered by running fingerprints, so this costs the same as hashing ~100 bytes)
+uint64_t chip8_state_hash(const struct chip8_vm *vm);
+
 // debugging functions: getters/setters for various pieces of standard CHIP-8 state
 // (included so that automated tests can run, and so that the GUI can report some errors)
 //---------------------------------------------------------------------------------------
 
+// get the number of instructions executed since chip8_load
+uint64_t chip8_get_cycles(struct chip8_vm *vm);
+
 // get/set PC (program counter)
 uint16_t chip8_get_pc(struct chip8_vm *vm);
 void chip8_set_pc(struct chip8_vm *vm, uint16_t new_pc);
@@ -0,0 +1,135 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "chip8env.h"
+#include "arena8.h"
+
+#define DEFAULT_CPF 10
+
+// one environment: its VM plus what step() needs to remember between frames
+struct env_slot {
+    struct chip8_vm vm;
+    uint64_t frame;         // vtick to pass to chip8_cycle
+    uint8_t last_score;
+    bool done;
+};
+
+struct chip8env {
+    int n;
+    struct chip8env_config cfg;
+    struct arena8 *slots;   // n slots, templated on the freshly-loaded ROM every environment (re)starts from
+};
+
+// helper to (re)start environment `i`
+static void reset_slot(struct chip8env *env, int i) {
+    struct env_slot *s = arena8_slot(env->slots, i);
+    arena8_reset(env->slots, s);
+    chip8_seed(&s->vm, env->cfg.seed + (uint64_t)i);
+}
+
+int chip8env_abi_version(void) {
+    return CHIP8ENV_ABI_VERSION;
+}
+
+struct chip8env *chip8env_create(const uint8_t *rom, size_t romlen, int n, const struct chip8env_config *cfg) {
+    uint8_t program[RAM_SIZE];
+    struct chip8env_config c = { .size = sizeof c, .quirks = CHIP8_QUIRKS_DEFAULT };
+
+    // (everything up to and including `seed` is the version-1 layout every caller must provide)
+    if (n < 1 || !cfg || cfg->size < offsetof(struct chip8env_config, seed) + sizeof c.seed) return NULL;
+    if (romlen > sizeof program) return NULL;
+    memcpy(&c, cfg, cfg->size < sizeof c ? cfg->size : sizeof c);
+    c.size = sizeof c;
+    if (!c.cpf) c.cpf = DEFAULT_CPF;
+    if (!c.done_mask) c.done_mask = 0xff;
+    if (c.obs_format != CHIP8ENV_OBS_BYTES && c.obs_format != CHIP8ENV_OBS_BITS) return NULL;
+    if (c.score_addr >= RAM_SIZE || c.done_addr >= RAM_SIZE) return NULL;
+
+    // the start state every environment gets copied from
+    struct env_slot start = { 0 };
+    memcpy(program, rom, romlen);
+    if (!chip8_load(&start.vm, program, romlen)) return NULL;
+    chip8_set_quirks(&start.vm, c.quirks);
+    start.last_score = c.score_addr ? chip8_get_ram(&start.vm, c.score_addr) : 0;
+
+    // every VM lives in one prefaulted, huge-page-backed block (no per-environment allocations or
+    // page faults, now or while stepping)
+    struct chip8env *env = malloc(sizeof *env);
+    if (!env) return NULL;
+    env->n = n;
+    env->cfg = c;
+    env->slots = arena8_create(sizeof(struct env_slot), (size_t)n, ARENA8_THP | ARENA8_PREFAULT);
+    if (!env->slots || !arena8_set_template(env->slots, &start)) {
+        chip8env_destroy(env);
+        return NULL;
+    }
+    for (int i = 0; i < n; ++i) reset_slot(env, i);
+    return env;
+}
+
+size_t chip8env_obs_size(const struct chip8env *env) {
+    size_t per_env = (env->cfg.obs_format == CHIP8ENV_OBS_BITS) ? FB_ROWS * FB_COLS / 8 : FB_ROWS * FB_COLS;
+    return per_env * (size_t)env->n;
+}
+
+void chip8env_reset(struct chip8env *env) {
+    for (int i = 0; i < env->n; ++i) reset_slot(env, i);
+}
+
+// helper to write one framebuffer into the observation buffer, bit-packed (MSB = leftmost pixel)
+static void pack_fb(const struct chip8_vm *vm, uint8_t *dst) {
+    const uint8_t *src = &vm->fb[0][0];
+    for (int b = 0; b < FB_ROWS * FB_COLS / 8; ++b, src += 8) {
+        dst[b] = ((src[0] & 1) << 7) | ((src[1] & 1) << 6) | ((src[2] & 1) << 5) | ((src[3] & 1) << 4)
+               | ((src[4] & 1) << 3) | ((src[5] & 1) << 2) | ((src[6] & 1) << 1) | (src[7] & 1);
+    }
+}
+
+int chip8env_step(struct chip8env *env, const uint16_t *actions, float *rewards, uint8_t *dones, void *obs) {
+    const struct chip8env_config *c = &env->cfg;
+    int num_done = 0;
+
+    for (int i = 0; i < env->n; ++i) {
+        struct env_slot *s = arena8_slot(env->slots, i);
+        uint16_t keys = actions ? actions[i] : 0;
+        bool sound;
+
+        if (s->done) reset_slot(env, i);
+        for (uint32_t cyc = 0; cyc < c->cpf; ++cyc) {
+            if (!chip8_cycle(&s->vm, keys, s->frame, &sound)) {
+                s->done = true;
+                break;
+            }
+        }
+        ++s->frame;
+
+        float reward = 0.f;
+        if (c->score_addr) {
+            uint8_t score = s->vm.ram[c->score_addr];
+            reward = (float)(int8_t)(uint8_t)(score - s->last_score); // (8-bit scores wrap around)
+            s->last_score = score;
+        }
+        if (c->done_addr && (s->vm.ram[c->done_addr] & c->done_mask)) s->done = true;
+
+        if (rewards) rewards[i] = reward;
+        if (dones) dones[i] = s->done;
+        if (s->done) ++num_done;
+        if (obs) {
+            if (c->obs_format == CHIP8ENV_OBS_BITS) {
+                pack_fb(&s->vm, (uint8_t *)obs + (size_t)i * (FB_ROWS * FB_COLS / 8));
+            } else {
+                memcpy((uint8_t *)obs + (size_t)i * (FB_ROWS * FB_COLS), s->vm.fb, FB_ROWS * FB_COLS);
+            }
+        }
+    }
+    return num_done;
+}
+
+void chip8env_destroy(struct chip8env *env) {
+    if (!env) return;
+    arena8_destroy(env->slots);
+    free(env);
+}
@@ -0,0 +1,76 @@
+#ifndef _CHIP8ENV_H
+#define _CHIP8ENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// VECTORIZED CHIP-8 ENVIRONMENTS (THE libchip8 C ABI)
+//--------------------------------------------------------------
+//
+// One handle holds N independent copies of a ROM (all VMs live in a single allocation made
+// by chip8env_create).  chip8env_step() advances every copy by one frame with its own
+// keypad action and reports, per environment:
+//
+// * reward := change in the (8-bit) score byte at `score_addr` since the previous step
+// * done := the byte at `done_addr`, masked with `done_mask`, is non-zero (or the VM hit
+//   an illegal instruction); a done environment is reset to the ROM's start state at the
+//   beginning of its next step
+// * observation := the framebuffer, written straight into the caller's buffer, either one
+//   byte per pixel (FB_ROWS x FB_COLS = 2048 bytes) or packed 8 pixels per byte with the
+//   leftmost pixel in the MSB (256 bytes), environment after environment
+//
+// ABI rules: only the functions below are exported; struct chip8env_config may only grow
+// at the end (callers set `size` = sizeof their copy, and missing fields get defaults);
+// CHIP8ENV_ABI_VERSION changes only for incompatible changes.
+
+#define CHIP8ENV_ABI_VERSION 1
+
+#if defined(__GNUC__)
+#define CHIP8ENV_API __attribute__((visibility("default")))
+#else
+#define CHIP8ENV_API
+#endif
+
+// observation layouts
+#define CHIP8ENV_OBS_BYTES 0    // 2048 bytes per environment (0 or 1 per pixel)
+#define CHIP8ENV_OBS_BITS 1     // 256 bytes per environment (bit-packed)
+
+struct chip8env_config {
+    uint32_t size;          // sizeof(struct chip8env_config) as the caller knows it
+    uint32_t cpf;           // cycles per frame (0 = 10)
+    uint16_t score_addr;    // RAM address of the score byte (0 = no rewards)
+    uint16_t done_addr;     // RAM address of the game-over byte (0 = never done)
+    uint8_t done_mask;      // bits of the game-over byte that mean "done" (0 = 0xff)
+    uint8_t quirks;         // CHIP8_QUIRK_* flags (as in chip8.h)
+    uint8_t obs_format;     // CHIP8ENV_OBS_*
+    uint8_t reserved;
+    uint64_t seed;          // environment i gets random seed `seed + i`
+};
+
+// opaque handle for a batch of environments
+struct chip8env;
+
+// the ABI version this library implements (compare with CHIP8ENV_ABI_VERSION)
+CHIP8ENV_API int chip8env_abi_version(void);
+
+// create `n` environments running `rom` (NULL on error: bad config, ROM too large, out of memory)
+CHIP8ENV_API struct chip8env *chip8env_create(const uint8_t *rom, size_t romlen, int n,
+                                              const struct chip8env_config *cfg);
+
+// bytes of observation buffer chip8env_step() needs for all environments
+CHIP8ENV_API size_t chip8env_obs_size(const struct chip8env *env);
+
+// put every environment back into the ROM's start state
+CHIP8ENV_API void chip8env_reset(struct chip8env *env);
+
+// advance all environments by one frame
+// `actions[i]` := keypad state (bit N = key N down) for environment i
+// `rewards`, `dones`, `obs` := per-environment outputs (any of them may be NULL to skip it)
+// (returns the number of environments that are done after this step)
+CHIP8ENV_API int chip8env_step(struct chip8env *env, const uint16_t *actions,
+                               float *rewards, uint8_t *dones, void *obs);
+
+// free a batch of environments (NULL is OK)
+CHIP8ENV_API void chip8env_destroy(struct chip8env *env);
+
+#endif
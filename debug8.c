@@ -0,0 +1,274 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+
+// POSIX sockets (all non-blocking: the host polls us, we never wait on the client)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "debug8.h"
+#include "sock8.h"
+
+// helper to send a printf-formatted reply line to the attached client (if any)
+static void reply(struct debug8 *dbg, const char *fmt, ...) {
+    if (dbg->client_fd < 0) return;
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof buf - 1, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (n > (int)sizeof buf - 2) n = sizeof buf - 2;
+    buf[n++] = '\n';
+    send(dbg->client_fd, buf, n, MSG_NOSIGNAL);
+}
+
+// helper to recompute whether debug8_check must run on every cycle
+static void rearm(struct debug8 *dbg) {
+    dbg->armed = (dbg->client_fd >= 0) && (dbg->paused || dbg->num_breakpoints > 0 || dbg->stepping);
+    if (!dbg->armed) dbg->resuming = false;
+}
+
+static void set_breakpoint(struct debug8 *dbg, uint16_t addr, bool on) {
+    addr &= RAM_SIZE - 1;
+    uint64_t bit = 1ull << (addr & 63);
+    bool was = (dbg->breakpoints[addr >> 6] & bit) != 0;
+    if (on && !was) {
+        dbg->breakpoints[addr >> 6] |= bit;
+        dbg->num_breakpoints++;
+    } else if (!on && was) {
+        dbg->breakpoints[addr >> 6] &= ~bit;
+        dbg->num_breakpoints--;
+    }
+}
+
+static void resume(struct debug8 *dbg) {
+    dbg->paused = false;
+    dbg->resuming = true;
+    rearm(dbg);
+}
+
+// watchpoint handler (runs inside chip8_cycle): report the hit and pause after this instruction
+static void watch_hit(void *ctx, const struct chip8_watch_hit *hit) {
+    struct debug8 *dbg = (struct debug8 *)ctx;
+    dbg->paused = true;
+    dbg->stepping = false;
+    rearm(dbg);
+    reply(dbg, "stopped watch pc=%03x addr=%03x old=%02x new=%02x %s",
+            hit->pc, hit->addr, hit->old_val, hit->new_val, hit->write ? "write" : "read");
+}
+
+static void detach(struct debug8 *dbg) {
+    if (dbg->watched_vm) chip8_attach_watches(dbg->watched_vm, NULL);
+    dbg->watched_vm = NULL;
+    memset(&dbg->watches, 0, sizeof dbg->watches);
+    if (dbg->client_fd >= 0) close(dbg->client_fd);
+    dbg->client_fd = -1;
+    dbg->line_len = 0;
+    dbg->stepping = false;
+    memset(dbg->breakpoints, 0, sizeof dbg->breakpoints);
+    dbg->num_breakpoints = 0;
+    dbg->paused = false;
+    rearm(dbg);
+}
+
+static void cmd_regs(struct debug8 *dbg, struct chip8_vm *vm) {
+    char buf[160];
+    int n = snprintf(buf, sizeof buf, "pc=%03x i=%03x", chip8_get_pc(vm), chip8_get_i(vm));
+    for (int r = 0; r < 16; ++r) {
+        n += snprintf(buf + n, sizeof buf - n, " v%x=%02x", r, chip8_get_vr(vm, r));
+    }
+    reply(dbg, "%s", buf);
+}
+
+static void cmd_mem(struct debug8 *dbg, struct chip8_vm *vm, unsigned addr, unsigned len) {
+    if (len == 0) len = 16;
+    if (len > 256) len = 256;
+    for (unsigned row = 0; row < len; row += 16) {
+        char buf[80];
+        int n = snprintf(buf, sizeof buf, "%03x:", (addr + row) & 0xfff);
+        for (unsigned i = row; i < len && i < row + 16; ++i) {
+            n += snprintf(buf + n, sizeof buf - n, " %02x", chip8_get_ram(vm, (addr + i) & 0xfff));
+        }
+        reply(dbg, "%s", buf);
+    }
+}
+
+// helper to parse and run one command line
+static void run_command(struct debug8 *dbg, struct chip8_vm *vm, char *line) {
+    char cmd[16] = "", arg1[16] = "";
+    unsigned a = 0, b = 0;
+    int argc = sscanf(line, "%15s %15s %x", cmd, arg1, &b);
+    if (argc < 1) return; // (blank line)
+    bool has_a = (argc >= 2) && (sscanf(arg1, "%x", &a) == 1);
+
+    if (!strcmp(cmd, "regs")) {
+        cmd_regs(dbg, vm);
+    } else if (!strcmp(cmd, "set") && argc == 3) {
+        if (!strcmp(arg1, "pc")) {
+            chip8_set_pc(vm, b & 0xfff);
+        } else if (!strcmp(arg1, "i")) {
+            chip8_set_i(vm, b & 0xfff);
+        } else if ((arg1[0] == 'v' || arg1[0] == 'V') && sscanf(arg1 + 1, "%x", &a) == 1 && a < 16 && arg1[2] == '\0') {
+            chip8_set_vr(vm, a, b & 0xff);
+        } else {
+            reply(dbg, "error unknown register '%s'", arg1);
+            return;
+        }
+        ++dbg->edits;
+    } else if (!strcmp(cmd, "mem") && has_a) {
+        cmd_mem(dbg, vm, a, (argc == 3) ? b : 16);
+    } else if (!strcmp(cmd, "poke") && has_a && argc == 3) {
+        chip8_set_ram(vm, a & 0xfff, b & 0xff);
+        ++dbg->edits;
+    } else if (!strcmp(cmd, "break") && has_a) {
+        set_breakpoint(dbg, a, true);
+    } else if (!strcmp(cmd, "delete") && has_a) {
+        set_breakpoint(dbg, a, false);
+    } else if (!strcmp(cmd, "breaks")) {
+        for (unsigned addr = 0; addr < RAM_SIZE; ++addr) {
+            if (debug8_is_breakpoint(dbg, addr)) reply(dbg, "break %03x", addr);
+        }
+    } else if ((!strcmp(cmd, "watch") || !strcmp(cmd, "rwatch") || !strcmp(cmd, "unwatch")) && has_a) {
+        if (dbg->watched_vm != vm) {
+            dbg->watches.handler = watch_hit;
+            dbg->watches.ctx = dbg;
+            chip8_attach_watches(vm, &dbg->watches);
+            dbg->watched_vm = vm;
+        }
+        int kinds = (cmd[0] == 'u') ? (CHIP8_WATCH_READ | CHIP8_WATCH_WRITE)
+                  : (cmd[0] == 'r') ? CHIP8_WATCH_READ : CHIP8_WATCH_WRITE;
+        chip8_watch_range(vm, a & 0xfff, (argc == 3 && b) ? b : 1, kinds, cmd[0] != 'u');
+    } else if (!strcmp(cmd, "pause")) {
+        debug8_stop(dbg, vm, "pause");
+    } else if (!strcmp(cmd, "continue")) {
+        dbg->stepping = false;
+        resume(dbg);
+    } else if (!strcmp(cmd, "step")) {
+        dbg->stepping = true;
+        dbg->steps = (argc >= 2 && has_a && a) ? a : 1;
+        resume(dbg);
+    } else if (!strcmp(cmd, "detach")) {
+        reply(dbg, "ok");
+        detach(dbg);
+        return;
+    } else {
+        reply(dbg, "error unknown or malformed command '%s'", cmd);
+        return;
+    }
+    rearm(dbg);
+    reply(dbg, "ok");
+}
+
+struct debug8 *debug8_listen(const char *path) {
+    struct debug8 *dbg = calloc(1, sizeof *dbg);
+    if (!dbg) return NULL;
+    dbg->client_fd = -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path || strlen(path) >= sizeof dbg->path) {
+        fprintf(stderr, "ERROR: debugger socket path too long: '%s'\n", path);
+        free(dbg);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+    strcpy(dbg->path, path);
+
+    if ((dbg->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        free(dbg);
+        return NULL;
+    }
+    if (!sock8_remove_stale(path)) {
+        close(dbg->listen_fd);
+        free(dbg);
+        return NULL;
+    }
+    if (bind(dbg->listen_fd, (struct sockaddr *)&addr, sizeof addr) != 0 || listen(dbg->listen_fd, 1) != 0) {
+        perror("bind/listen");
+        close(dbg->listen_fd);
+        free(dbg);
+        return NULL;
+    }
+    fcntl(dbg->listen_fd, F_SETFL, fcntl(dbg->listen_fd, F_GETFL) | O_NONBLOCK);
+    return dbg;
+}
+
+bool debug8_poll(struct debug8 *dbg, struct chip8_vm *vm) {
+    // anybody new knocking?
+    int cfd = accept(dbg->listen_fd, NULL, NULL);
+    if (cfd >= 0) {
+        if (dbg->client_fd >= 0) {
+            const char busy[] = "error another debugger is attached\n";
+            send(cfd, busy, sizeof busy - 1, MSG_NOSIGNAL);
+            close(cfd);
+        } else {
+            fcntl(cfd, F_SETFL, fcntl(cfd, F_GETFL) | O_NONBLOCK);
+            dbg->client_fd = cfd;
+            reply(dbg, "chip8 debugger attached (pc=%03x)", chip8_get_pc(vm));
+        }
+    }
+    if (dbg->client_fd < 0) return dbg->paused;
+
+    // read whatever the client sent, running each complete line
+    char buf[256];
+    ssize_t n;
+    while ((n = recv(dbg->client_fd, buf, sizeof buf, 0)) > 0) {
+        for (ssize_t i = 0; i < n; ++i) {
+            if (buf[i] == '\n' || dbg->line_len == sizeof dbg->line - 1) {
+                dbg->line[dbg->line_len] = '\0';
+                dbg->line_len = 0;
+                run_command(dbg, vm, dbg->line);
+                if (dbg->client_fd < 0) return dbg->paused; // (detached)
+            } else if (buf[i] != '\r') {
+                dbg->line[dbg->line_len++] = buf[i];
+            }
+        }
+    }
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        detach(dbg); // client hung up
+    }
+    return dbg->paused;
+}
+
+bool debug8_check(struct debug8 *dbg, struct chip8_vm *vm) {
+    if (dbg->paused) return true;
+
+    uint16_t pc = chip8_get_pc(vm);
+    bool resuming = dbg->resuming;
+    dbg->resuming = false;
+
+    if (!resuming && debug8_is_breakpoint(dbg, pc)) {
+        dbg->stepping = false;
+        return debug8_stop(dbg, vm, "breakpoint");
+    }
+    if (dbg->stepping) {
+        if (dbg->steps == 0) {
+            dbg->stepping = false;
+            return debug8_stop(dbg, vm, "step");
+        }
+        dbg->steps--;
+    }
+    return false;
+}
+
+bool debug8_stop(struct debug8 *dbg, struct chip8_vm *vm, const char *reason) {
+    if (!dbg || dbg->client_fd < 0) return false;
+    dbg->paused = true;
+    rearm(dbg);
+    reply(dbg, "stopped %s pc=%03x", reason, chip8_get_pc(vm));
+    return true;
+}
+
+void debug8_close(struct debug8 *dbg) {
+    if (!dbg) return;
+    detach(dbg);
+    close(dbg->listen_fd);
+    unlink(dbg->path);
+    free(dbg);
+}
@@ -0,0 +1,81 @@
+#ifndef _DEBUG8_H
+#define _DEBUG8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// REMOTE DEBUGGER STUB (LINE PROTOCOL OVER A UNIX-DOMAIN SOCKET)
+//--------------------------------------------------------------
+//
+// A host creates one `struct debug8` with debug8_listen() and then:
+//
+// * calls debug8_poll() every now and then (e.g., once per frame, or every loop while
+//   `paused`) to accept a client and run its commands; and
+// * before every chip8_cycle(), checks `dbg->armed` and only if it is set calls
+//   debug8_check() (which says whether to hold the VM instead of executing the instruction).
+//
+// `armed` is only true while a client is attached *and* has the VM paused or has set
+// breakpoints or a pending single-step, so a VM nobody is debugging pays one never-taken
+// branch per cycle.
+//
+// Commands (one per line; numbers in hex; every reply ends with "ok" or "error ..."):
+//
+//     regs                    show PC, I, V0-VF
+//     set pc|i|v0..vf VALUE   change a register
+//     mem ADDR [LEN]          hex dump of RAM
+//     poke ADDR BYTE          change one byte of RAM
+//     break ADDR / delete ADDR / breaks
+//     watch ADDR [LEN] / rwatch ADDR [LEN] / unwatch ADDR [LEN]   (RAM write/read watchpoints)
+//     pause / continue / step [N]
+//     detach                  (also resumes the VM)
+//
+// Whenever the VM stops, the client gets an unsolicited "stopped REASON pc=ADDR" line
+// (watchpoints stop the VM right after the instruction that touched the watched byte,
+// and report "stopped watch pc=ADDR addr=ADDR old=XX new=XX [read|write]").
+
+struct debug8 {
+    uint64_t breakpoints[RAM_SIZE / 64];    // one bit per RAM address
+    int num_breakpoints;
+    bool armed;         // debug8_check() needs to see every cycle
+    bool paused;        // the VM is stopped (debug8_check() returns true until resumed)
+    bool stepping;      // a `step N` is in progress...
+    uint32_t steps;     // ...with this many instructions left to run
+    bool resuming;      // don't re-trigger the breakpoint we just stopped at
+    uint32_t edits;     // bumped by every `set`/`poke` (so a host shadowing the VM knows it changed)
+
+    struct chip8_watchset watches;      // the client's watchpoints...
+    struct chip8_vm *watched_vm;        // ...and the VM they are attached to (NULL if none yet)
+
+    int listen_fd;
+    int client_fd;      // -1 if nobody is attached
+    char line[256];     // partial command line received so far
+    size_t line_len;
+    char path[108];
+};
+
+// start listening for debugger clients on Unix socket `path` (NULL on error)
+struct debug8 *debug8_listen(const char *path);
+
+// service the socket (accept/read/execute commands against `vm`); returns `dbg->paused`
+bool debug8_poll(struct debug8 *dbg, struct chip8_vm *vm);
+
+// is there a breakpoint at `pc`?
+static inline bool debug8_is_breakpoint(const struct debug8 *dbg, uint16_t pc) {
+    pc &= RAM_SIZE - 1;
+    return (dbg->breakpoints[pc >> 6] >> (pc & 63)) & 1;
+}
+
+// call before each cycle while `dbg->armed`; true means "don't run the VM" (it is paused)
+bool debug8_check(struct debug8 *dbg, struct chip8_vm *vm);
+
+// halt the VM and tell the client why (e.g., "error" after chip8_cycle fails)
+// (returns false if no client is attached to take over, i.e., the host should handle it)
+bool debug8_stop(struct debug8 *dbg, struct chip8_vm *vm, const char *reason);
+
+// disconnect any client, stop listening and remove the socket (NULL is OK)
+void debug8_close(struct debug8 *dbg);
+
+#endif
@@ -0,0 +1,144 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// we include nothing but the libchip8 ABI here (like any outside host would)
+#include "chip8env.h"
+
+// LIBCHIP8 ABI SMOKE TEST (AND EXAMPLE HOST)
+//--------------------------------------------------------------
+//
+// Links against the shared library alone and drives a batch of environments through
+// chip8env.h: every environment holds its own keypad action, and the one that is never
+// pressed must never be rewarded, while a pressed one must be (the ROM is expected to
+// count key presses into its score byte, as regress/twoplayer.ch8 does at 0x301).  A ROM
+// that fails on its first instruction must leave every environment done, and the library
+// must not write a byte to the host's stdout along the way.
+
+#define NUM_ENVS 8
+#define STEPS 120
+
+// the score byte regress/twoplayer.ch8 keeps (V1, stored by FX55 at I = 0x300)
+#define SCORE_ADDR 0x301
+
+// observation bytes per environment, packed
+#define OBS_BITS_BYTES 256
+
+// helper to point stdout at a scratch file (returns the saved descriptor, -1 on error)
+static int capture_stdout(FILE **scratch) {
+    fflush(stdout);
+    if ((*scratch = tmpfile()) == NULL) return -1;
+    int saved = dup(STDOUT_FILENO);
+    if (saved < 0 || dup2(fileno(*scratch), STDOUT_FILENO) < 0) {
+        fclose(*scratch);
+        return -1;
+    }
+    return saved;
+}
+
+// helper to put stdout back and return how many bytes were written to it meanwhile
+static long restore_stdout(int saved, FILE *scratch) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    long len = lseek(fileno(scratch), 0, SEEK_END);
+    fclose(scratch);
+    return len;
+}
+
+// entry point: run the checks against the ROM named on the command line
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    struct chip8env *env = NULL, *bad = NULL;
+    uint8_t rom[4096];
+    static uint8_t obs[NUM_ENVS * OBS_BITS_BYTES];
+    uint16_t actions[NUM_ENVS];
+    float rewards[NUM_ENVS], total[NUM_ENVS] = { 0 };
+    uint8_t dones[NUM_ENVS];
+    FILE *scratch = NULL;
+    int saved = -1;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s ROM_FILE\n", argv[0]);
+        goto cleanup;
+    }
+    FILE *fp = fopen(argv[1], "rb");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", argv[1]);
+        goto cleanup;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, fp);
+    fclose(fp);
+
+    if (chip8env_abi_version() != CHIP8ENV_ABI_VERSION) {
+        fprintf(stderr, "ERROR: library implements ABI %d, header says %d\n", chip8env_abi_version(), CHIP8ENV_ABI_VERSION);
+        goto cleanup;
+    }
+    struct chip8env_config cfg = {
+        .size = sizeof cfg,
+        .cpf = 50,
+        .score_addr = SCORE_ADDR,
+        .quirks = 0x03,     // (CHIP8_QUIRKS_DEFAULT; chip8.h is not part of the ABI)
+        .obs_format = CHIP8ENV_OBS_BITS,
+        .seed = 1,
+    };
+    if ((env = chip8env_create(rom, romlen, NUM_ENVS, &cfg)) == NULL) {
+        fprintf(stderr, "ERROR: chip8env_create failed\n");
+        goto cleanup;
+    }
+    if (chip8env_obs_size(env) != sizeof obs) {
+        fprintf(stderr, "ERROR: chip8env_obs_size is %zu, not %zu\n", chip8env_obs_size(env), sizeof obs);
+        goto cleanup;
+    }
+
+    // environment 0 never presses anything; environment i holds key i down
+    if ((saved = capture_stdout(&scratch)) < 0) {
+        fprintf(stderr, "ERROR: cannot capture stdout\n");
+        goto cleanup;
+    }
+    for (int i = 0; i < NUM_ENVS; ++i) actions[i] = i ? (1 << i) : 0;
+    for (int step = 0; step < STEPS; ++step) {
+        if (chip8env_step(env, actions, rewards, dones, obs) != 0) break;
+        for (int i = 0; i < NUM_ENVS; ++i) total[i] += rewards[i] != 0.f;
+    }
+
+    // a ROM whose first instruction (0000) is illegal: every environment is done after one step
+    static const uint8_t illegal[] = { 0x00, 0x00 };
+    if ((bad = chip8env_create(illegal, sizeof illegal, NUM_ENVS, &cfg)) == NULL) {
+        restore_stdout(saved, scratch);
+        fprintf(stderr, "ERROR: chip8env_create failed for the illegal-instruction ROM\n");
+        goto cleanup;
+    }
+    int bad_done = chip8env_step(bad, actions, NULL, dones, NULL);
+    long spam = restore_stdout(saved, scratch);
+
+    if (spam != 0) {
+        fprintf(stderr, "ERROR: the library wrote %ld bytes to stdout\n", spam);
+        goto cleanup;
+    }
+    if (total[0] != 0.f) {
+        fprintf(stderr, "ERROR: the environment with no keys pressed was rewarded\n");
+        goto cleanup;
+    }
+    for (int i = 1; i < NUM_ENVS; ++i) {
+        if (total[i] == 0.f) {
+            fprintf(stderr, "ERROR: environment %d (key %X held) was never rewarded\n", i, i);
+            goto cleanup;
+        }
+    }
+    if (bad_done != NUM_ENVS || memchr(dones, 0, NUM_ENVS)) {
+        fprintf(stderr, "ERROR: only %d of %d environments done after an illegal instruction\n", bad_done, NUM_ENVS);
+        goto cleanup;
+    }
+    printf("%d environments x %d steps OK (ABI %d)\n", NUM_ENVS, STEPS, chip8env_abi_version());
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    chip8env_destroy(env);
+    chip8env_destroy(bad);
+    return ret;
+}
@@ -0,0 +1,291 @@
+// some standard library/system headers
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "explore.h"
+#include "arena8.h"
+
+#define DEFAULT_INTERVAL 6
+#define DEFAULT_CPF 10
+#define DEFAULT_MAX_STATES (1u << 20)
+#define DEFAULT_MAX_FRONTIER 4096
+#define MAX_THREADS 64
+
+// frontier states handed to a worker at a time (amortizes the shared counter)
+#define CHUNK 8
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define LOAD(v) atomic_load_explicit(&(v), memory_order_relaxed)
+
+// a state waiting to be expanded
+struct node {
+    struct chip8_vm vm;
+    uint32_t id;
+};
+
+struct explore {
+    struct explore_config cfg;
+    uint16_t *actions;
+
+    // this level's frontier, and the next one being filled by the workers (arrays of struct node)
+    struct arena8 *cur, *next;
+    size_t ncur;
+    _Atomic size_t nnext;
+    int depth;
+
+    // visited states: open-addressed set of state hashes (0 = empty slot), lock-free
+    struct arena8 *set_mem;
+    _Atomic uint64_t *set;
+    size_t set_mask;
+
+    // per state (by id): where it came from (ids are handed out in discovery order)
+    uint32_t *parent;
+    uint8_t *action;
+    _Atomic size_t total;
+
+    // novelty: one bit per (RAM address or V register, byte value) pair any state so far has had
+    _Atomic uint64_t *atoms;
+
+    _Atomic int64_t goal;
+    int64_t deepest;
+    _Atomic int64_t newest;     // (some state found during the current level)
+    atomic_bool full;
+
+    // per-level work distribution and counters
+    _Atomic size_t next_node;
+    _Atomic size_t tried, new_states, dropped, crashed;
+};
+
+// helper to add a state hash to the visited set (false if it was already there)
+static bool set_insert(struct explore *ex, uint64_t h) {
+    if (!h) h = 1; // (0 marks an empty slot)
+    for (size_t i = h & ex->set_mask;; i = (i + 1) & ex->set_mask) {
+        uint64_t seen = LOAD(ex->set[i]);
+        if (seen == h) return false;
+        if (!seen) {
+            if (atomic_compare_exchange_strong(&ex->set[i], &seen, h)) return true;
+            if (seen == h) return false;    // (someone else just inserted the same state)
+        }
+    }
+}
+
+// helper to mark one (location, value) pair as seen (true if it was new)
+static inline bool mark_atom(struct explore *ex, size_t loc, uint8_t val) {
+    size_t atom = loc * 256 + val;
+    uint64_t bit = 1ull << (atom & 63);
+    _Atomic uint64_t *word = &ex->atoms[atom >> 6];
+    // (plain load first: nearly every pair has been seen before, and that keeps the cache line shared)
+    return !(LOAD(*word) & bit) && !(atomic_fetch_or_explicit(word, bit, memory_order_relaxed) & bit);
+}
+
+// helper to mark every (location, value) pair of a state's RAM and registers as seen (true if any was new)
+// (games keep their variables in either, so both count)
+static bool mark_novel(struct explore *ex, const struct chip8_vm *vm) {
+    bool novel = false;
+    for (size_t addr = 0; addr < RAM_SIZE; ++addr) novel |= mark_atom(ex, addr, vm->ram[addr] & 0xff);
+    for (size_t x = 0; x < 16; ++x) novel |= mark_atom(ex, RAM_SIZE + x, vm->V[x]);
+    return novel;
+}
+
+// helper to hold `keys` down for one interval (false if the VM hit an illegal instruction)
+static bool run_action(const struct explore *ex, struct chip8_vm *vm, uint16_t keys) {
+    bool sound;
+    size_t vtick = (size_t)ex->depth * ex->cfg.interval;
+    for (int v = 0; v < ex->cfg.interval; ++v, ++vtick) {
+        for (int c = 0; c < ex->cfg.cpf; ++c) {
+            if (!chip8_cycle(vm, keys, vtick, &sound)) return false;
+        }
+    }
+    return true;
+}
+
+// helper to try one action from one frontier state
+static void expand(struct explore *ex, const struct node *from, int a, struct chip8_vm *child) {
+    *child = from->vm;
+    if (!run_action(ex, child, ex->actions[a])) {
+        atomic_fetch_add_explicit(&ex->crashed, 1, memory_order_relaxed);
+        return;
+    }
+    if (!set_insert(ex, chip8_state_hash(child))) return;
+
+    size_t id = atomic_fetch_add(&ex->total, 1);
+    if (id >= ex->cfg.max_states) {
+        atomic_store(&ex->full, true);
+        return;
+    }
+    ex->parent[id] = from->id;
+    ex->action[id] = (uint8_t)a;
+    atomic_fetch_add_explicit(&ex->new_states, 1, memory_order_relaxed);
+    atomic_store_explicit(&ex->newest, (int64_t)id, memory_order_relaxed);
+
+    if (ex->cfg.goal_addr >= 0 && (child->ram[ex->cfg.goal_addr] & 0xff) == ex->cfg.goal_val) {
+        int64_t none = -1;
+        atomic_compare_exchange_strong(&ex->goal, &none, (int64_t)id);
+    }
+    if (ex->cfg.mode == EXPLORE_NOVELTY && !mark_novel(ex, child)) return;
+
+    size_t slot = atomic_fetch_add(&ex->nnext, 1);
+    if (slot >= ex->cfg.max_frontier) {
+        atomic_fetch_add_explicit(&ex->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    struct node *to = arena8_slot(ex->next, slot);
+    to->vm = *child;
+    to->id = (uint32_t)id;
+}
+
+// worker thread: grab frontier states a chunk at a time until the level is done
+// (counting the children it actually ran, so a level cut short by a goal or a full set says so)
+static void *worker(void *arg) {
+    struct explore *ex = (struct explore *)arg;
+    struct chip8_vm child;
+    size_t i, tried = 0;
+    while ((i = atomic_fetch_add(&ex->next_node, CHUNK)) < ex->ncur) {
+        for (size_t end = MIN(i + CHUNK, ex->ncur); i < end; ++i) {
+            for (int a = 0; a < ex->cfg.nactions; ++a) {
+                if (atomic_load(&ex->full) || LOAD(ex->goal) >= 0) goto done;
+                expand(ex, arena8_slot(ex->cur, i), a, &child);
+                ++tried;
+            }
+        }
+    }
+done:
+    atomic_fetch_add_explicit(&ex->tried, tried, memory_order_relaxed);
+    return NULL;
+}
+
+struct explore *explore_create(const uint8_t *rom, size_t romlen, const struct explore_config *cfg) {
+    uint8_t program[RAM_SIZE];
+    struct explore *ex = calloc(1, sizeof *ex);
+    if (!ex || romlen > sizeof program) goto fail;
+
+    ex->cfg = *cfg;
+    struct explore_config *c = &ex->cfg;
+    if (!c->interval) c->interval = DEFAULT_INTERVAL;
+    if (!c->cpf) c->cpf = DEFAULT_CPF;
+    if (!c->max_states) c->max_states = DEFAULT_MAX_STATES;
+    if (!c->max_frontier) c->max_frontier = DEFAULT_MAX_FRONTIER;
+    if (c->threads <= 0) c->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    c->threads = c->threads < 1 ? 1 : MIN(c->threads, MAX_THREADS);
+    if (c->max_states > UINT32_MAX || c->goal_addr >= RAM_SIZE || c->nactions > 256) goto fail;
+
+    // no keys plus each single key, unless told otherwise
+    ex->actions = malloc(sizeof ex->actions[0] * (c->actions ? c->nactions : 17));
+    if (!ex->actions) goto fail;
+    if (c->actions) {
+        memcpy(ex->actions, c->actions, sizeof ex->actions[0] * c->nactions);
+    } else {
+        c->nactions = 17;
+        ex->actions[0] = 0;
+        for (int k = 0; k < 16; ++k) ex->actions[k + 1] = 1 << k;
+    }
+    if (c->nactions < 1) goto fail;
+    c->actions = ex->actions;
+
+    // a set at most half full stays fast to probe
+    size_t slots = 1;
+    while (slots < 2 * c->max_states) slots <<= 1;
+    ex->set_mask = slots - 1;
+    ex->parent = malloc(sizeof ex->parent[0] * c->max_states);
+    ex->action = malloc(sizeof ex->action[0] * c->max_states);
+    ex->atoms = calloc((RAM_SIZE + 16) * 256 / 64, sizeof ex->atoms[0]);
+
+    // the set and the frontiers are probed/streamed through at random by every worker, so they go
+    // on huge pages, faulted in up front (fresh arena memory is all zeros, i.e., an empty set)
+    int flags = c->arena_flags ? c->arena_flags : ARENA8_THP | ARENA8_PREFAULT;
+    ex->set_mem = arena8_create(sizeof ex->set[0] * slots, 1, flags);
+    ex->cur = arena8_create(sizeof(struct node), c->max_frontier, flags);
+    ex->next = arena8_create(sizeof(struct node), c->max_frontier, flags);
+    if (!ex->set_mem || !ex->parent || !ex->action || !ex->atoms || !ex->cur || !ex->next) goto fail;
+    ex->set = arena8_slot(ex->set_mem, 0);
+
+    // the start state is state 0 (its own parent)
+    struct node *start = arena8_slot(ex->cur, 0);
+    memcpy(program, rom, romlen);
+    if (!chip8_load(&start->vm, program, romlen)) goto fail;
+    chip8_set_quirks(&start->vm, c->quirks);
+    start->id = 0;
+    ex->ncur = 1;
+    ex->parent[0] = 0;
+    ex->action[0] = 0;
+    atomic_init(&ex->total, 1);
+    atomic_init(&ex->goal, -1);
+    set_insert(ex, chip8_state_hash(&start->vm));
+    mark_novel(ex, &start->vm);
+    return ex;
+
+fail:
+    explore_destroy(ex);
+    return NULL;
+}
+
+bool explore_step(struct explore *ex, struct explore_level *lvl) {
+    if (!ex->ncur || LOAD(ex->goal) >= 0 || atomic_load(&ex->full)) return false;
+
+    atomic_store(&ex->next_node, 0);
+    atomic_store(&ex->nnext, 0);
+    atomic_store(&ex->tried, 0);
+    atomic_store(&ex->new_states, 0);
+    atomic_store(&ex->dropped, 0);
+    atomic_store(&ex->crashed, 0);
+
+    // (the calling thread is worker #0)
+    pthread_t threads[MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < ex->cfg.threads; ++t) {
+        if (pthread_create(&threads[started], NULL, worker, ex) == 0) ++started;
+    }
+    worker(ex);
+    for (int t = 0; t < started; ++t) pthread_join(threads[t], NULL);
+
+    size_t kept = MIN(LOAD(ex->nnext), ex->cfg.max_frontier);
+    struct arena8 *tmp = ex->cur;
+    ex->cur = ex->next;
+    ex->next = tmp;
+    lvl->expanded = ex->ncur;
+    lvl->tried = LOAD(ex->tried);
+    ex->ncur = kept;
+    ++ex->depth;
+    if (LOAD(ex->new_states)) ex->deepest = LOAD(ex->newest);
+
+    lvl->depth = ex->depth;
+    lvl->new_states = LOAD(ex->new_states);
+    lvl->kept = kept;
+    lvl->dropped = LOAD(ex->dropped);
+    lvl->crashed = LOAD(ex->crashed);
+    lvl->total = MIN(LOAD(ex->total), ex->cfg.max_states);
+    return true;
+}
+
+int64_t explore_goal(const struct explore *ex) {
+    return atomic_load_explicit(&ex->goal, memory_order_relaxed);
+}
+
+int64_t explore_deepest(const struct explore *ex) {
+    return ex->deepest;
+}
+
+int explore_path(const struct explore *ex, int64_t state, uint16_t *keys, int max) {
+    int len = 0;
+    for (uint32_t id = (uint32_t)state; id; id = ex->parent[id]) ++len;
+    int i = len;
+    for (uint32_t id = (uint32_t)state; id; id = ex->parent[id]) {
+        if (--i < max) keys[i] = ex->actions[ex->action[id]];
+    }
+    return len;
+}
+
+void explore_destroy(struct explore *ex) {
+    if (!ex) return;
+    free(ex->actions);
+    arena8_destroy(ex->set_mem);
+    free(ex->parent);
+    free(ex->action);
+    free((void *)ex->atoms);
+    arena8_destroy(ex->cur);
+    arena8_destroy(ex->next);
+    free(ex);
+}
@@ -0,0 +1,78 @@
+#ifndef _EXPLORE_H
+#define _EXPLORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// PARALLEL STATE-SPACE EXPLORER
+//--------------------------------------------------------------
+//
+// Starting from a freshly loaded ROM, every state is expanded by trying each keypad action
+// (a key mask held for `interval` vticks of `cpf` cycles each).  Children are deduplicated by
+// chip8_state_hash() in a lock-free, open-addressed hash set shared by all worker threads, and
+// the search proceeds level by level (one level = one more branch point), each level's
+// frontier split dynamically across the workers.
+//
+// EXPLORE_BFS keeps every new state (up to `max_frontier` per level).  EXPLORE_NOVELTY only
+// keeps states that make some RAM byte or V register hold a value no earlier state had there
+// (width-1 novelty pruning), which reaches deep game states with a frontier orders of magnitude
+// smaller.
+//
+// Each state remembers only its parent and action, so the key presses that lead to any state
+// can be recovered with explore_path() after the fact.
+
+enum explore_mode {
+    EXPLORE_BFS,
+    EXPLORE_NOVELTY,
+};
+
+struct explore_config {
+    const uint16_t *actions;    // key masks to branch on (NULL = no keys plus each single key)
+    int nactions;
+    int interval;               // vticks each action is held for (0 = 6)
+    int cpf;                    // cycles per vtick (0 = 10)
+    uint8_t quirks;             // CHIP8_QUIRK_* flags for every VM
+    enum explore_mode mode;
+    int threads;                // worker threads (0 = one per online CPU)
+    size_t max_states;          // stop once this many distinct states were seen (0 = 1M)
+    size_t max_frontier;        // most states expanded per level (0 = 4096)
+    int goal_addr;              // stop at the first state with RAM[goal_addr] == goal_val (-1 = no goal)
+    uint8_t goal_val;
+    int arena_flags;            // ARENA8_* backing of the visited set and frontiers (0 = THP + prefault)
+};
+
+// what one level of the search did
+struct explore_level {
+    int depth;                  // branch points from the start state to the new states
+    size_t expanded;            // states of the previous level that were expanded
+    size_t tried;               // children run (expanded x actions, unless the search stopped early)
+    size_t new_states;          // children never seen before
+    size_t kept;                // ...of which made it into the next frontier
+    size_t dropped;             // ...of which didn't fit (frontier full)
+    size_t crashed;             // children that hit an illegal instruction
+    size_t total;               // distinct states seen so far
+};
+
+struct explore;
+
+// set up a search (NULL if the ROM can't be loaded or the memory can't be allocated)
+struct explore *explore_create(const uint8_t *rom, size_t romlen, const struct explore_config *cfg);
+
+// expand the current frontier into the next one and describe it in `*lvl`
+// (false, with nothing done, once the frontier is empty, a limit is reached or the goal was found)
+bool explore_step(struct explore *ex, struct explore_level *lvl);
+
+// the state that reached the goal (-1 if none yet) and some state at the deepest level reached
+int64_t explore_goal(const struct explore *ex);
+int64_t explore_deepest(const struct explore *ex);
+
+// the key masks leading from the start state to `state` (one per branch point), at most `max`;
+// returns the path length (which may exceed `max`)
+int explore_path(const struct explore *ex, int64_t state, uint16_t *keys, int max);
+
+void explore_destroy(struct explore *ex);
+
+#endif
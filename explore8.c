@@ -0,0 +1,228 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// we include the state-space explorer (and the ROM database for per-title quirks/speed) here
+#include "explore.h"
+#include "arena8.h"
+#include "romdb.h"
+#include "movie.h"  // (and the gameplay movie recorder, for playing a found path back)
+
+// makefile-overridable path of the per-ROM settings database (can also be set with the env var GUI8_ROMDB)
+#ifndef EXPLORE8_ROMDB
+#define EXPLORE8_ROMDB "chip8.romdb"
+#endif
+
+// longest key path we write out
+#define MAX_PATH 100000
+
+// cycles per vtick explore_create uses when neither the command line nor the ROM database gives one
+#define DEFAULT_CPF 10
+
+// helper to return the (monotonic) time in seconds
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// helper to parse a comma-separated list of hex key masks ("0,2,10"); returns how many (-1 on error)
+static int parse_actions(char *list, uint16_t *actions, int max) {
+    int n = 0;
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        char *end;
+        unsigned long mask = strtoul(tok, &end, 16);
+        if (*end || mask > 0xffff || n == max) return -1;
+        actions[n++] = (uint16_t)mask;
+    }
+    return n;
+}
+
+// helper to write a key path (one key mask per step of `interval` vticks) as a regress8 input script
+// (one "vtick keymask" line, in hex, wherever the keys change)
+static bool write_path(const char *path, const uint16_t *keys, int len, int interval, const char *why) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot create '%s'\n", path);
+        return false;
+    }
+    fprintf(fp, "# explore8: %s after %d steps of %d vticks\n", why, len, interval);
+    for (int i = 0; i < len; ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) fprintf(fp, "%x %04x\n", i * interval, keys[i]);
+    }
+    fprintf(fp, "%x %04x\n", len * interval, 0);
+    bool ok = !ferror(fp);
+    if (fclose(fp) != 0) ok = false;
+    if (!ok) fprintf(stderr, "ERROR: cannot write '%s'\n", path);
+    return ok;
+}
+
+// helper to play a key path back from power-on (the way the search ran it) and record it as a
+// gameplay movie, one frame per vtick
+static bool write_movie(const char *path, const uint8_t *rom, size_t romlen, const struct explore_config *cfg,
+                        const uint16_t *keys, int len) {
+    static struct chip8_vm vm;
+    int cpf = cfg->cpf ? cfg->cpf : DEFAULT_CPF;
+    bool sound = false, ok = true;
+
+    if (!chip8_load(&vm, (uint8_t *)rom, romlen)) return false;
+    chip8_set_quirks(&vm, cfg->quirks);
+    struct movie_writer *mw = movie_create(path, romdb_hash_rom(rom, romlen), cfg->quirks);
+    if (!mw) {
+        fprintf(stderr, "ERROR: cannot create movie '%s'\n", path);
+        return false;
+    }
+    for (int i = 0; ok && i < len; ++i) {
+        for (int v = 0; ok && v < cfg->interval; ++v) {
+            size_t vtick = (size_t)i * cfg->interval + v;
+            movie_input(mw, chip8_get_cycles(&vm), keys[i], vtick);
+            for (int c = 0; ok && c < cpf; ++c) ok = chip8_cycle(&vm, keys[i], vtick, &sound);
+            if (ok) ok = movie_write_frame(mw, chip8_get_cycles(&vm), &vm.fb[0][0], sound);
+        }
+    }
+    if (!movie_finish(mw)) ok = false;
+    if (!ok) fprintf(stderr, "ERROR: cannot record the path into '%s'\n", path);
+    return ok;
+}
+
+// entry point: search a ROM's state space from power-on and report (and optionally save a path to)
+// the goal state or the deepest state found
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    FILE *romfile = NULL;
+    struct romdb *romdb = NULL;
+    struct explore *ex = NULL;
+    uint8_t rom[RAM_SIZE];
+    uint16_t actions[256];
+    struct explore_config cfg = {
+        .interval = 6,
+        .quirks = CHIP8_QUIRKS_DEFAULT,
+        .mode = EXPLORE_NOVELTY,
+        .goal_addr = -1,
+    };
+    int max_depth = 1000;
+    const char *out_path = NULL, *movie_path = NULL;
+    static uint16_t path_keys[MAX_PATH];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:j:i:c:a:n:f:d:g:o:M:H")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (!strcmp(optarg, "bfs")) cfg.mode = EXPLORE_BFS;
+            else if (!strcmp(optarg, "novelty")) cfg.mode = EXPLORE_NOVELTY;
+            else goto usage;
+            break;
+        case 'j': cfg.threads = atoi(optarg); break;
+        case 'i': cfg.interval = atoi(optarg); break;
+        case 'c': cfg.cpf = atoi(optarg); break;
+        case 'a':
+            if ((cfg.nactions = parse_actions(optarg, actions, 256)) < 1) goto usage;
+            cfg.actions = actions;
+            break;
+        case 'n': cfg.max_states = strtoull(optarg, NULL, 10); break;
+        case 'f': cfg.max_frontier = strtoull(optarg, NULL, 10); break;
+        case 'd': max_depth = atoi(optarg); break;
+        case 'g': {
+            unsigned addr, val;
+            if (sscanf(optarg, "%x=%x", &addr, &val) != 2 || addr >= RAM_SIZE || val > 0xff) goto usage;
+            cfg.goal_addr = (int)addr;
+            cfg.goal_val = (uint8_t)val;
+            break;
+        }
+        case 'o': out_path = optarg; break;
+        case 'M': movie_path = optarg; break;
+        case 'H': cfg.arena_flags = ARENA8_HUGETLB | ARENA8_THP | ARENA8_PREFAULT; break;
+        default: goto usage;
+        }
+    }
+    if (optind != argc - 1 || cfg.interval < 1 || cfg.cpf < 0) {
+usage:
+        fprintf(stderr, "usage: %s [-m bfs|novelty] [-j THREADS] [-i VTICKS] [-c CPF] [-a MASKS] [-n STATES]\n"
+                        "       %*s [-f FRONTIER] [-d DEPTH] [-g ADDR=VAL] [-o KEYS_FILE] [-M MOVIE] [-H] ROM_FILE\n"
+                        "  -m  search strategy (default: novelty = keep only states with a never-seen RAM byte or register value)\n"
+                        "  -j  worker threads (default: one per CPU)\n"
+                        "  -i  vticks each key mask is held for (default: 6)\n"
+                        "  -c  cycles per vtick (default: from the ROM database, else 10)\n"
+                        "  -a  comma-separated hex key masks to branch on (default: none + each single key)\n"
+                        "  -n  stop after this many distinct states (default: 1048576)\n"
+                        "  -f  most states expanded per level (default: 4096)\n"
+                        "  -d  stop after this many levels (default: 1000)\n"
+                        "  -g  stop at the first state with RAM[ADDR] == VAL (both hex)\n"
+                        "  -o  write the keys reaching the goal (or the deepest state) as a regress8 input script\n"
+                        "  -M  play those keys back and record them as a gameplay movie (see movie8)\n"
+                        "  -H  put the search's memory on reserved huge pages (see /proc/sys/vm/nr_hugepages), if any are free\n",
+                        argv[0], (int)strlen(argv[0]), "");
+        goto cleanup;
+    }
+
+    // read the ROM and pick up its quirks/speed from the database, unless given on the command line
+    if ((romfile = fopen(argv[optind], "rb")) == NULL) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", argv[optind]);
+        goto cleanup;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, romfile);
+    const char *romdb_path = getenv("GUI8_ROMDB");
+    if ((romdb = romdb_open(romdb_path ? romdb_path : EXPLORE8_ROMDB)) != NULL) {
+        const struct romdb_entry *rome = romdb_lookup(romdb, romdb_hash_rom(rom, romlen));
+        if (rome) {
+            cfg.quirks = rome->quirks;
+            if (!cfg.cpf) cfg.cpf = rome->cpf;
+        }
+    }
+
+    if ((ex = explore_create(rom, romlen, &cfg)) == NULL) {
+        fprintf(stderr, "ERROR: cannot set up the search (bad ROM or options, or out of memory)\n");
+        goto cleanup;
+    }
+
+    // one line per level, then a summary
+    double t0 = now_sec();
+    struct explore_level lvl = { 0 };
+    size_t total = 1, tried = 0;
+    printf("%6s %10s %10s %10s %8s %8s %12s\n", "depth", "expanded", "new", "kept", "dropped", "crashed", "total");
+    while (lvl.depth < max_depth && explore_step(ex, &lvl)) {
+        printf("%6d %10zu %10zu %10zu %8zu %8zu %12zu\n",
+               lvl.depth, lvl.expanded, lvl.new_states, lvl.kept, lvl.dropped, lvl.crashed, lvl.total);
+        fflush(stdout);
+        total = lvl.total;
+        tried += lvl.tried;
+    }
+    double secs = now_sec() - t0;
+    printf("%zu states in %.2f s (%.0f states/s, %.1fM states/min; %.1fM children tried/min)\n",
+           total, secs, total / secs, total / secs * 60 / 1e6, tried / secs * 60 / 1e6);
+
+    int64_t goal = explore_goal(ex);
+    if (cfg.goal_addr >= 0) {
+        if (goal >= 0) printf("goal RAM[0x%03x] == 0x%02x reached\n", cfg.goal_addr, cfg.goal_val);
+        else printf("goal RAM[0x%03x] == 0x%02x not reached\n", cfg.goal_addr, cfg.goal_val);
+    }
+    if (out_path || movie_path) {
+        int64_t state = (goal >= 0) ? goal : explore_deepest(ex);
+        const char *why = (goal >= 0) ? "goal reached" : "deepest state";
+        int len = explore_path(ex, state, path_keys, MAX_PATH);
+        if (len > MAX_PATH) {
+            fprintf(stderr, "ERROR: path of %d steps is too long to write\n", len);
+            goto cleanup;
+        }
+        if (out_path) {
+            if (!write_path(out_path, path_keys, len, cfg.interval, why)) goto cleanup;
+            printf("wrote the key path to '%s'\n", out_path);
+        }
+        if (movie_path) {
+            if (!write_movie(movie_path, rom, romlen, &cfg, path_keys, len)) goto cleanup;
+            printf("recorded the key path into '%s'\n", movie_path);
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+cleanup:
+    explore_destroy(ex);
+    romdb_close(romdb);
+    if (romfile) fclose(romfile);
+    return ret;
+}
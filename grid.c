@@ -0,0 +1,185 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "grid.h"
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+// border colors (ARGB)
+#define GAP_COLOR 0xff202020u
+#define FAILED_COLOR 0xffc02020u
+
+// helper to return the (monotonic) time in microseconds
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// helper to fill a `w` x `h` rectangle of the atlas at (x, y)
+static void fill(struct grid *g, int x, int y, int w, int h, uint32_t color) {
+    for (int row = y; row < y + h; ++row) {
+        uint32_t *p = (uint32_t *)((uint8_t *)g->pixels + (size_t)row * g->pitch) + x;
+        for (int col = 0; col < w; ++col) p[col] = color;
+    }
+}
+
+// helper to run one frame of a tile (if there is one in this cell) and draw the cell
+static void run_cell(struct grid *g, int cell) {
+    int cell_w = FB_COLS * g->scale + GRID_GAP, cell_h = FB_ROWS * g->scale + GRID_GAP;
+    int x, y;
+    grid_cell_origin(g, cell, g->scale, &x, &y);
+    if (cell >= g->n) {
+        fill(g, x, y, cell_w, cell_h, GAP_COLOR);
+        return;
+    }
+
+    struct grid_tile *t = &g->tiles[cell];
+    uint64_t t0 = now_us();
+    if (!t->failed) {
+        bool sound;
+        int n;
+        for (n = 0; n < t->target_cpf; ++n) {
+            if (!chip8_cycle(&t->vm, g->keys, g->vtick, &sound)) {
+                t->failed = true;
+                break;
+            }
+            if (t->idle_pc && chip8_get_pc(&t->vm) == t->idle_pc) {
+                ++n;
+                break;
+            }
+        }
+        t->cpf = n;
+        ++t->frames;
+    }
+
+    uint32_t *dst = (uint32_t *)((uint8_t *)g->pixels + (size_t)y * g->pitch) + x;
+    scale8_argb(&t->vm.fb[0][0], FB_COLS, FB_ROWS, g->scale, dst, g->pitch, g->opts);
+    uint32_t border = t->failed ? FAILED_COLOR : GAP_COLOR;
+    fill(g, x + cell_w - GRID_GAP, y, GRID_GAP, cell_h, border);
+    fill(g, x, y + cell_h - GRID_GAP, cell_w - GRID_GAP, GRID_GAP, border);
+    t->emu_us = (uint32_t)(now_us() - t0);
+}
+
+// helper to grab and run cells until the frame has none left
+static void run_cells(struct grid *g) {
+    int cell, ncells = g->cols * g->rows;
+    while ((cell = atomic_fetch_add(&g->next_cell, 1)) < ncells) run_cell(g, cell);
+}
+
+// worker thread: wait for a frame, help run it, report back, repeat
+static void *worker(void *arg) {
+    struct grid *g = (struct grid *)arg;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        while (g->generation == seen) pthread_cond_wait(&g->go, &g->lock);
+        seen = g->generation;
+        if (g->quit) break;
+        pthread_mutex_unlock(&g->lock);
+
+        run_cells(g);
+
+        pthread_mutex_lock(&g->lock);
+        if (--g->busy == 0) pthread_cond_signal(&g->done);
+    }
+    pthread_mutex_unlock(&g->lock);
+    return NULL;
+}
+
+struct grid *grid_create(int cap, int nthreads) {
+    if (cap < 1) return NULL;
+    struct grid *g = calloc(1, sizeof *g);
+    if (!g) return NULL;
+    if ((g->tiles = malloc(sizeof g->tiles[0] * cap)) == NULL) {
+        free(g);
+        return NULL;
+    }
+    g->cap = cap;
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->go, NULL);
+    pthread_cond_init(&g->done, NULL);
+
+    // (no point in more workers than tiles)
+    if (nthreads <= 0) nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = MIN(MIN(nthreads, cap), GRID_MAX_THREADS);
+    g->nthreads = 1;
+    for (int t = 1; t < nthreads; ++t) {
+        if (pthread_create(&g->threads[t], NULL, worker, g) != 0) break;
+        ++g->nthreads;
+    }
+    return g;
+}
+
+bool grid_add(struct grid *g, const uint8_t *rom, size_t romlen, const char *name,
+              int target_cpf, uint8_t quirks, uint16_t idle_pc, uint64_t seed) {
+    uint8_t program[RAM_SIZE];
+    if (g->n == g->cap || romlen > sizeof program) return false;
+    struct grid_tile *t = &g->tiles[g->n];
+    memset(t, 0, sizeof *t);
+    memcpy(program, rom, romlen);
+    if (!chip8_load(&t->vm, program, romlen)) return false;
+    chip8_set_quirks(&t->vm, quirks);
+    chip8_seed(&t->vm, seed);
+    snprintf(t->name, sizeof t->name, "%s", name);
+    t->target_cpf = target_cpf;
+    t->idle_pc = idle_pc;
+
+    // re-pick the layout: as many columns as rows (2:1 tiles then fill a 2:1 window), dropping empty rows
+    ++g->n;
+    for (g->cols = 1; g->cols * g->cols < g->n; ++g->cols) {}
+    g->rows = (g->n + g->cols - 1) / g->cols;
+    return true;
+}
+
+void grid_atlas_size(struct grid *g, int scale, int *width, int *height) {
+    *width = g->cols * (FB_COLS * scale + GRID_GAP);
+    *height = g->rows * (FB_ROWS * scale + GRID_GAP);
+}
+
+void grid_cell_origin(const struct grid *g, int i, int scale, int *x, int *y) {
+    *x = (i % g->cols) * (FB_COLS * scale + GRID_GAP);
+    *y = (i / g->cols) * (FB_ROWS * scale + GRID_GAP);
+}
+
+void grid_frame(struct grid *g, uint16_t keys, size_t vtick, uint32_t *pixels, int pitch, int scale,
+                const struct scale8_opts *opts) {
+    g->keys = keys;
+    g->vtick = vtick;
+    g->pixels = pixels;
+    g->pitch = pitch;
+    g->scale = scale;
+    g->opts = opts;
+    atomic_store(&g->next_cell, 0);
+
+    pthread_mutex_lock(&g->lock);
+    g->busy = g->nthreads - 1;
+    ++g->generation;
+    pthread_cond_broadcast(&g->go);
+    pthread_mutex_unlock(&g->lock);
+
+    run_cells(g);
+
+    pthread_mutex_lock(&g->lock);
+    while (g->busy) pthread_cond_wait(&g->done, &g->lock);
+    pthread_mutex_unlock(&g->lock);
+}
+
+void grid_destroy(struct grid *g) {
+    if (!g) return;
+    pthread_mutex_lock(&g->lock);
+    g->quit = true;
+    ++g->generation;
+    pthread_cond_broadcast(&g->go);
+    pthread_mutex_unlock(&g->lock);
+    for (int t = 1; t < g->nthreads; ++t) pthread_join(g->threads[t], NULL);
+    pthread_mutex_destroy(&g->lock);
+    pthread_cond_destroy(&g->go);
+    pthread_cond_destroy(&g->done);
+    free(g->tiles);
+    free(g);
+}
@@ -0,0 +1,82 @@
+#ifndef _GRID_H
+#define _GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "chip8.h"
+#include "scale.h"
+
+// MANY VMS IN ONE ATLAS (GRID VIEW)
+//--------------------------------------------------------------
+//
+// A grid holds any number of independent VMs ("tiles"), each with its own ROM, speed and
+// RNG seed.  grid_frame() advances every tile by one virtual frame on a pool of worker
+// threads; each worker also upscales the tiles it ran straight into its cell of the caller's
+// ARGB atlas (e.g., a locked streaming texture), so the host presents all of them with one
+// texture upload and one draw call.  Cells are laid out row-major, separated by GRID_GAP
+// pixels of border, which turns red for a tile that hit an illegal instruction (it then
+// stays frozen on its last frame).
+
+#define GRID_GAP 2
+#define GRID_MAX_THREADS 64
+
+struct grid_tile {
+    struct chip8_vm vm;
+    char name[64];
+    int target_cpf;             // cycles per frame (a frame ends early at `idle_pc`)
+    uint16_t idle_pc;           // PC of the ROM's busy-wait loop (0 if unknown)
+    bool failed;
+    int cpf;                    // cycles run in the last frame
+    uint32_t frames;            // frames run so far
+    uint32_t emu_us;            // time the last frame took (emulation + upscale)
+};
+
+struct grid {
+    int n, cap;
+    int cols, rows;
+    struct grid_tile *tiles;
+
+    // the worker pool (the thread calling grid_frame is worker #0)
+    pthread_t threads[GRID_MAX_THREADS];
+    int nthreads;
+    pthread_mutex_t lock;
+    pthread_cond_t go, done;
+    uint64_t generation;        // bumped for every frame (and to quit)
+    int busy;                   // workers still on the current frame
+    bool quit;
+    _Atomic int next_cell;
+
+    // the current frame's job
+    uint16_t keys;
+    size_t vtick;
+    uint32_t *pixels;
+    int pitch, scale;
+    const struct scale8_opts *opts;
+};
+
+// set up a grid with room for `cap` tiles and `nthreads` workers in all (0 = one per online CPU)
+// (NULL on error)
+struct grid *grid_create(int cap, int nthreads);
+
+// add a tile running `rom`, seeded with `seed` (false if the grid is full or the ROM doesn't load)
+bool grid_add(struct grid *g, const uint8_t *rom, size_t romlen, const char *name,
+              int target_cpf, uint8_t quirks, uint16_t idle_pc, uint64_t seed);
+
+// size of the atlas at `scale` (the cols x rows layout is picked to suit a 2:1 window)
+void grid_atlas_size(struct grid *g, int scale, int *width, int *height);
+
+// where tile `i`'s framebuffer lands in the atlas
+void grid_cell_origin(const struct grid *g, int i, int scale, int *x, int *y);
+
+// run one frame of every tile with the keypad state `keys` and draw them all into `pixels`
+// (an atlas of grid_atlas_size(scale), `pitch` bytes per row); returns once every cell is drawn
+void grid_frame(struct grid *g, uint16_t keys, size_t vtick, uint32_t *pixels, int pitch, int scale,
+                const struct scale8_opts *opts);
+
+void grid_destroy(struct grid *g);
+
+#endif
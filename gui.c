@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>   // to actually use these we'll need to add "-lm" to our linking command (on *nix platforms, anyway)
 
 // we use SDL2 for cross-platform graphics/sound/keyboard support
@@ -10,6 +11,20 @@
 
 // we include the CHIP-8 VM API here
 #include "chip8.h"  // this needs to be here in our working directory
+#include "romdb.h"  // (and the per-ROM settings database)
+#include "scale.h"  // (and the CPU framebuffer upscaler)
+#include "metrics.h"  // (and the live metrics exporter)
+#include "debug8.h" // (and the remote debugger stub)
+#include "movie.h"  // (and the gameplay movie recorder)
+#include "input8.h" // (and the timestamped keypad event queue)
+#include "shm8.h"   // (and the shared-memory state export)
+#include "trace.h"  // (and the instruction tracer)
+#include "audio8.h" // (and the wavetable tone generator)
+#include "hud.h"    // (and the in-window performance HUD)
+#include "grid.h"   // (and the multi-VM grid view)
+#include "netplay.h"    // (and rollback netplay)
+#include "shadow.h" // (and the shadow-execution validator)
+#include "analyze.h"    // (and the static ROM analyzer)
 
 // ------------- PREPROCESSOR DEFINES & MACROS --------------
 // (optional reading, but helpful illustration of techniques)
@@ -19,10 +34,6 @@
 #define WIN_WIDTH 640   // 10x 64, or 5x 128
 #define WIN_HEIGHT 320  // 10x 32, or 5x 64
 
-// calculated "pixel size" of the CHIP-8 pixels as drawn inside our window
-#define PIX_WIDTH (WIN_WIDTH / FB_COLS)
-#define PIX_HEIGHT (WIN_HEIGHT / FB_ROWS)
-
 // program name to show in window title bar
 #define TITLE "CHIP-8"
 
@@ -59,10 +70,58 @@
 #define GUI8_DEFAULT_TARGET_CPF 1000
 #endif
 
-// macro for condensing foreground/background color setting code for SDL2 render logic
-#define FOREGROUND(ren) SDL_SetRenderDrawColor((ren), GUI8_FG_R, GUI8_FG_G, GUI8_FG_B, 255);
-#define BACKGROUND(ren) SDL_SetRenderDrawColor((ren), GUI8_BG_R, GUI8_BG_G, GUI8_BG_B, 255);
-#define GRIDCOLOR(ren) SDL_SetRenderDrawColor((ren), 255, 255, 255, 255);
+// makefile-overridable path of the per-ROM settings database (can also be set with the env var of the same name)
+#ifndef GUI8_ROMDB
+#define GUI8_ROMDB "chip8.romdb"
+#endif
+
+// environment variable naming the Unix socket to serve live metrics on (metrics are off if unset)
+#define GUI8_METRICS_ENV "GUI8_METRICS_SOCKET"
+
+// environment variable naming the Unix socket a debugger can attach to (no debugging if unset)
+#define GUI8_DEBUG_ENV "GUI8_DEBUG_SOCKET"
+
+// environment variable naming a file to record a gameplay movie into (no recording if unset)
+#define GUI8_RECORD_ENV "GUI8_RECORD"
+
+// environment variable giving the number of frames to run ahead (0/unset = off; at most GUI8_MAX_RUNAHEAD)
+#define GUI8_RUNAHEAD_ENV "GUI8_RUNAHEAD"
+#define GUI8_MAX_RUNAHEAD 8
+
+// environment variable naming a POSIX shared-memory segment (e.g., "/gui8") to mirror the VM into (off if unset)
+#define GUI8_SHM_ENV "GUI8_SHM"
+
+// environment variable naming a file to write an instruction trace into (F5 pauses/resumes; off if unset)
+#define GUI8_TRACE_ENV "GUI8_TRACE"
+
+// environment variable switching to the grid view: a number N runs N copies of the ROM (seeded 0..N-1),
+// anything else names a file listing more ROMs to run alongside it (one path per line, '#' comments)
+#define GUI8_GRID_ENV "GUI8_GRID"
+#define GUI8_MAX_GRID 1024
+
+// environment variable switching to two-player rollback netplay over UDP: "LOCAL_PORT:PEER_HOST:PEER_PORT"
+// (both sides run the same ROM and OR their keypads together), with makefile-overridable prediction
+// depth and input delay (frames; see netplay.h)
+#define GUI8_NETPLAY_ENV "GUI8_NETPLAY"
+#ifndef GUI8_NETPLAY_ROLLBACK
+#define GUI8_NETPLAY_ROLLBACK 8
+#endif
+#ifndef GUI8_NETPLAY_DELAY
+#define GUI8_NETPLAY_DELAY 1
+#endif
+
+// environment variable turning on shadow execution: the reference interpreter checks the core after
+// every instruction ("insn"), every straight-line block ("block"), or for one vtick out of every N
+// (a number; cheap enough to leave on); divergences are reported on stderr and in the metrics
+#define GUI8_SHADOW_ENV "GUI8_SHADOW"
+
+// environment variable naming a directory to cache static ROM analyses in (off if unset): the analysis
+// supplies an idle PC for ROMs the database has none for, and pre-fills the sprite cache
+#define GUI8_ANALYSIS_ENV "GUI8_ANALYSIS"
+
+// macro for packing RGB colors into the 0xAARRGGBB pixels our framebuffer texture uses
+#define ARGB(r, g, b) (0xff000000u | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+#define GRIDCOLOR ARGB(255, 255, 255)
 
 // intervals for 60Hz and makefile-overridable-FPS-interval timers
 #define Tms60Hz (1000 / 60)
@@ -71,9 +130,16 @@
 // audio sampling rate (for generating the beep sound)
 #define SAMPLING_RATE 48000
 
-// makefile-overridable audio sampling function (options: square_sampler, sine_sampler, triangle_sampler, sawtooth_sampler)
-#ifndef SAMPLER_FUNC
-#define SAMPLER_FUNC triangle_sampler
+// makefile-overridable initial beep waveform (options: AUDIO8_SQUARE, AUDIO8_TRIANGLE, AUDIO8_SINE, AUDIO8_SAWTOOTH),
+// pitch (Hz) and volume (0-256); F6 cycles through the waveforms at runtime
+#ifndef GUI8_WAVEFORM
+#define GUI8_WAVEFORM AUDIO8_TRIANGLE
+#endif
+#ifndef GUI8_TONE_HZ
+#define GUI8_TONE_HZ 440.f
+#endif
+#ifndef GUI8_VOLUME
+#define GUI8_VOLUME 128
 #endif
 
 // -------------------- KEYBOARD SUBSYSTEM --------------------
@@ -146,41 +212,82 @@ static const struct keypad_scancode {
 // (auto-generates a for-loop using "var" as a pointer to the next keypad_scancode object)
 #define FOREACH_KEY(var) for (const struct keypad_scancode *var = chip8_keypad_scancodes; var->keycap; ++var)
 
+// helper function to track a key binding going down/up (`*held` has one bit per entry of
+// `chip8_keypad_scancodes`) and return the resulting CHIP-8 keypad state
+// (so that, e.g., releasing W doesn't release keypad '5' while Up Arrow is still held)
+static uint16_t update_keypad(uint32_t *held, SDL_Scancode scancode, bool down) {
+    uint16_t keybits = 0u;
+    int i = 0;
+    FOREACH_KEY(kp) {
+        if (kp->scancode == scancode) {
+            if (down) *held |= 1u << i; else *held &= ~(1u << i);
+        }
+        if (*held & (1u << i)) keybits |= kp->keymask;
+        ++i;
+    }
+    return keybits;
+}
+
 
 // -------------------- GRAPHICS SUBSYSTEM --------------------
 // ------------------------------------------------------------
 
 
+// the selectable foreground/background color schemes (F3 cycles through them)
+static const struct palette {
+    uint32_t fg;
+    uint32_t bg;
+} palettes[] = {
+    { ARGB(GUI8_FG_R, GUI8_FG_G, GUI8_FG_B), ARGB(GUI8_BG_R, GUI8_BG_G, GUI8_BG_B) },   // makefile-configured
+    { ARGB(GUI8_BG_R, GUI8_BG_G, GUI8_BG_B), ARGB(GUI8_FG_R, GUI8_FG_G, GUI8_FG_B) },   // ...and inverted
+    { ARGB(255, 255, 255), ARGB(0, 0, 0) },                                             // classic white-on-black
+};
+#define NUM_PALETTES ((int)(sizeof palettes / sizeof palettes[0]))
+
 // helper function to render the CHIP-8 VM's internal framebuffer to the screen
-static void render_framebuffer(struct chip8_vm *vm, SDL_Renderer *ren, bool render_grid) {
-    int dx = PIX_WIDTH;
-    int dy = PIX_HEIGHT;
+// (the framebuffer is upscaled on the CPU straight into a streaming texture sized to the
+// largest integer multiple that fits the window, which is then drawn with one RenderCopy;
+// `*tex`/`*tex_scale` cache that texture and get replaced whenever the window size changes;
+// the caller presents, so overlays like the HUD can go on top first)
+static void render_framebuffer(const struct chip8_vm *vm, SDL_Renderer *ren, SDL_Texture **tex, int *tex_scale,
+                               const struct scale8_opts *opts) {
+    int out_w, out_h;
+    if (SDL_GetRendererOutputSize(ren, &out_w, &out_h) != 0) {
+        out_w = WIN_WIDTH;
+        out_h = WIN_HEIGHT;
+    }
 
-    // draw the framebuffer onto our app window/screen
-    BACKGROUND(ren);
-    SDL_RenderClear(ren);
-    SDL_Rect rr = { .y = 0, .w = dx, .h = dy };
-    for (int y = 0; y < FB_ROWS; ++y, rr.y += dy) {
-        rr.x = 0;
-        for (int x = 0; x < FB_COLS; ++x, rr.x += dx) {
-            switch (vm->fb[y][x]) {
-            case 0:
-                break;
-            case 1:
-                FOREGROUND(ren);
-                SDL_RenderFillRect(ren, &rr);
-                break;
-            default:
-                GRIDCOLOR(ren);
-                SDL_RenderFillRect(ren, &rr);
-            }
-            if (render_grid) {
-                GRIDCOLOR(ren);
-                SDL_RenderDrawRect(ren, &rr);
-            }
+    int scale = scale8_fit(FB_COLS, FB_ROWS, out_w, out_h);
+    if (!*tex || (scale != *tex_scale)) {
+        if (*tex) SDL_DestroyTexture(*tex);
+        *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                 FB_COLS * scale, FB_ROWS * scale);
+        if (!*tex) {
+            SDL_PERRORF("SDL_CreateTexture");
+            return;
         }
+        *tex_scale = scale;
     }
-    SDL_RenderPresent(ren);
+
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(*tex, NULL, &pixels, &pitch) != 0) {
+        SDL_PERRORF("SDL_LockTexture");
+        return;
+    }
+    scale8_argb(&vm->fb[0][0], FB_COLS, FB_ROWS, scale, (uint32_t *)pixels, pitch, opts);
+    SDL_UnlockTexture(*tex);
+
+    // draw the framebuffer onto our app window/screen (centered, letterboxed in the background color)
+    SDL_Rect dst = {
+        .w = FB_COLS * scale,
+        .h = FB_ROWS * scale,
+    };
+    dst.x = (out_w - dst.w) / 2;
+    dst.y = (out_h - dst.h) / 2;
+    SDL_SetRenderDrawColor(ren, (opts->bg >> 16) & 0xff, (opts->bg >> 8) & 0xff, opts->bg & 0xff, 255);
+    SDL_RenderClear(ren);
+    SDL_RenderCopy(ren, *tex, NULL, &dst);
 }
 
 
@@ -188,88 +295,68 @@ static void render_framebuffer(struct chip8_vm *vm, SDL_Renderer *ren, bool rend
 // (there be math _and_ pointer dragons in here, so shield your eyes)
 // ------------------------------------------------------------------
 
-// extent and current position within a looping buffer of U8 audio samples
-struct tone_loop {
-    Uint8 *start;
-    Uint8 *end;
-    Uint8 *cursor;
+// the tone generator plus what we need to notice the audio device starving:
+// when the callback last ran, the metrics counter to bump if it ran too late,
+// and the longest gap between callbacks since the HUD last looked (microseconds)
+struct audio_out {
+    struct audio8 gen;
+    Uint64 last_cb;
+    _Atomic uint64_t *underruns;
+    _Atomic uint32_t max_gap_us;
 };
 
-// constructor to allocate a `tone_loop` buffer and filling it with one second
-// of audio samples (at sampling rate `srate`; i.e., `srate` sample values)
-// calculated using the provided `sampler` function pointer (which takes a
-// floating point offset from 0.0 to 1.0 (start to finish) and an opaque
-// "context" pointer (type `void *`) to maintain its own arguments/state
-struct tone_loop *gen_tone_loop(int srate, Uint8 (*sampler)(float, void *), void *ctx) {
-    char *hunk = malloc(sizeof(struct tone_loop) + srate);
-    if (!hunk) return NULL;
-    struct tone_loop *tlp = (struct tone_loop *)hunk;
-    tlp->start = (Uint8*)&tlp[1];
-    tlp->end = tlp->start + srate;
-    tlp->cursor = tlp->start;
-
-    float srr = 1.0f / (float)srate;
-    for (int i = 0; i < srate; ++i) {
-        tlp->start[i] = sampler((float)i * srr, ctx);
-    }
-
-    return tlp;
-}
-
-// waveform parameters used by the sampler functions (frequency, volume level)
-// (all of our sampler functions expect a pointer to one of these for `ctx`)
-struct tone_context {
-    float freq;
-    float level;
+// an XO-CHIP pattern to show off pattern playback with (F6) until the core can load its own
+// (a 50% duty cycle pulse with a short "blip" in front; pitch 64 = 4000 bits/s, i.e., 31.25 Hz per cycle)
+static const uint8_t demo_pattern[16] = {
+    0xf0, 0xf0, 0xf0, 0xf0, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
+#define DEMO_PATTERN_PITCH 176   // (4000 * 2^(112/48) = ~20 kbit/s: a ~160 Hz buzz)
 
-// sample a single cycle of a pure sine-wave signal (sounds very mellow)
-Uint8 sine_sampler(float t, void *ctx) {
-    struct tone_context *tcp = (struct tone_context *)ctx;
-    return (Uint8)(tcp->level * sinf(2.f * M_PI * tcp->freq * t) + tcp->level);
-}
+// callback function to feed audio sample data on-demand to the SDL2 sound system during playback
+void audio_cb(void *userdata, Uint8 *buffer, int len) {
+    struct audio_out *ao = (struct audio_out *)userdata;
+    int nsamples = len / (int)sizeof(int16_t);
 
-// sample a single full cycle of a square-wave ("on/off") signal (sounds very beepy/computery)
-Uint8 square_sampler(float t, void *ctx) {
-    struct tone_context *tcp = (struct tone_context *)ctx;
-    return (Uint8)(tcp->level * copysignf(1.0f, sinf(2.f * M_PI * tcp->freq * t)) + tcp->level);
-}
+    // if more than two buffers' worth of time went by since the last callback, the device ran dry
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (ao->last_cb) {
+        Uint64 gap = now - ao->last_cb;
+        if (ao->underruns && gap * ao->gen.srate > 2 * (Uint64)nsamples * SDL_GetPerformanceFrequency()) {
+            metrics_add(ao->underruns, 1);
+        }
+        // (we're the only writer; the main thread just swaps in a 0 once per frame)
+        uint32_t gap_us = (uint32_t)(gap * 1000000 / SDL_GetPerformanceFrequency());
+        if (gap_us > atomic_load_explicit(&ao->max_gap_us, memory_order_relaxed)) {
+            atomic_store_explicit(&ao->max_gap_us, gap_us, memory_order_relaxed);
+        }
+    }
+    ao->last_cb = now;
 
-// sample a single full cycle of a sawtooth-wave (ramp-up/cliff-down) signal (sounds very harsh/nasal)
-Uint8 sawtooth_sampler(float t, void *ctx) {
-    struct tone_context *tcp = (struct tone_context *)ctx;
-    float p = 1.0f / tcp->freq;
-    float t_p = t / p;
-    return (Uint8)(tcp->level * (2.f * (t_p - floorf(0.5f + t_p))) + tcp->level);
+    audio8_render(&ao->gen, (int16_t *)buffer, nsamples);
 }
 
-// sample a single full cycle of a triangle-wave (ramp-up/ramp-down) signal (a less-mellow sine-like sound)
-Uint8 triangle_sampler(float t, void *ctx) {
-    struct tone_context *tcp = (struct tone_context *)ctx;
-    float p = 1.0f / tcp->freq;
-    float t_p = t / p;
-    return (Uint8)(4.f * fabsf(t_p - floorf(t_p + .5f)) * tcp->level);
 
-}
+// ------------------------- MAIN PROGRAM LOGIC ------------------------
+// ---------------------------------------------------------------------
 
-// callback function to feed audio sample data on-demand to the SDL2 sound system during playback
-void tone_loop_cb(void *userdata, Uint8 *buffer, int len) {
-    struct tone_loop *tlp = (struct tone_loop *)userdata;
-    while (len > 0) {
-        int sz = tlp->end - tlp->cursor;
-        if (sz > len) sz = len;
-        memcpy(buffer, tlp->cursor, sz);
-        tlp->cursor += sz;
-        buffer += sz;
-        len -= sz;
-        if (tlp->cursor == tlp->end) tlp->cursor = tlp->start;
+// helper function to speculatively run a copy of `vm` `frames` frames (of `cpf` cycles each) into
+// the future, holding the keypad state `keys`, leaving the result in `*ahead` (for display only)
+// (a VM is one flat struct, so the "snapshot" is a plain struct copy and "restoring" is simply
+// not touching `vm`; the copy gets no watchpoints or tracer, so speculation never trips the
+// debugger or shows up in traces)
+static void run_ahead(const struct chip8_vm *vm, struct chip8_vm *ahead, int frames, int cpf,
+                      uint16_t keys, size_t vtick) {
+    bool sound;
+    *ahead = *vm;
+    chip8_attach_watches(ahead, NULL);
+    chip8_attach_tracer(ahead, NULL);
+    for (int f = 1; f <= frames; ++f) {
+        for (int c = 0; c < cpf; ++c) {
+            if (!chip8_cycle(ahead, keys, vtick + f, &sound)) return; // (show whatever we got up to)
+        }
     }
 }
 
-
-// ------------------------- MAIN PROGRAM LOGIC ------------------------
-// ---------------------------------------------------------------------
-
 // helper function to checkif `ms` millesecond-scale ticks have elapsed since the value of `*ticks`;
 // if so, updates the value of `*ticks` to be "now"
 bool has_elapsed(Uint64 *ticks, int ms) {
@@ -280,6 +367,309 @@ bool has_elapsed(Uint64 *ticks, int ms) {
     return elapsed;
 }
 
+// helper to add a ROM file to the grid with its ROM database settings (false on error, with a message)
+static bool grid_add_file(struct grid *grid, const char *path, const struct romdb *romdb, int cpf, bool cpf_from_cli,
+                          uint64_t seed) {
+    uint8_t rom[RAM_SIZE];
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", path);
+        return false;
+    }
+    size_t len = fread(rom, 1, sizeof rom, fp);
+    fclose(fp);
+
+    uint8_t quirks = CHIP8_QUIRKS_DEFAULT;
+    uint16_t idle_pc = 0;
+    const struct romdb_entry *rome = romdb ? romdb_lookup(romdb, romdb_hash_rom(rom, len)) : NULL;
+    if (rome) {
+        quirks = rome->quirks;
+        idle_pc = rome->idle_pc;
+        if (rome->cpf && !cpf_from_cli) cpf = rome->cpf;
+    }
+    if (!grid_add(grid, rom, len, path, cpf ? cpf : GUI8_DEFAULT_TARGET_CPF, quirks, idle_pc, seed)) {
+        fprintf(stderr, "ERROR: cannot add '%s' to the grid (too many ROMs, or it doesn't load)\n", path);
+        return false;
+    }
+    return true;
+}
+
+// helper to build the grid GUI8_GRID asks for (NULL on error, with a message)
+static struct grid *make_grid(const char *spec, const char *rom_path, const struct romdb *romdb, int cpf, bool cpf_from_cli) {
+    char *end;
+    long copies = strtol(spec, &end, 10);
+    bool by_seed = (*spec && !*end);
+    struct grid *grid = grid_create(by_seed ? (int)MAX(copies, 1) : GUI8_MAX_GRID, 0);
+    if (!grid || (by_seed && (copies < 1 || copies > GUI8_MAX_GRID))) {
+        fprintf(stderr, "ERROR: cannot set up a grid of %s VMs\n", spec);
+        grid_destroy(grid);
+        return NULL;
+    }
+
+    if (by_seed) {
+        for (long i = 0; i < copies; ++i) {
+            if (!grid_add_file(grid, rom_path, romdb, cpf, cpf_from_cli, (uint64_t)i)) goto fail;
+        }
+    } else {
+        char line[512];
+        if (!grid_add_file(grid, rom_path, romdb, cpf, cpf_from_cli, 0)) goto fail;
+        FILE *list = fopen(spec, "r");
+        if (!list) {
+            fprintf(stderr, "ERROR: cannot open ROM list '%s'\n", spec);
+            goto fail;
+        }
+        while (fgets(line, sizeof line, list)) {
+            line[strcspn(line, "\r\n")] = 0;
+            if (!line[0] || line[0] == '#') continue;
+            if (!grid_add_file(grid, line, romdb, cpf, cpf_from_cli, 0)) {
+                fclose(list);
+                goto fail;
+            }
+        }
+        fclose(list);
+    }
+    return grid;
+fail:
+    grid_destroy(grid);
+    return NULL;
+}
+
+// the grid view's main loop: every VM gets the same keypad state and one virtual frame per 60Hz tick,
+// and all of them are composited (by the grid's workers) into one streaming texture drawn with one RenderCopy
+// (F3 cycles the palette, F4 toggles the per-tile "FPS/CPF" stats; no sound)
+static void run_grid(struct grid *grid, SDL_Window *win, SDL_Renderer *ren) {
+    SDL_Texture *tex = NULL;
+    int tex_scale = 0, palette = 0;
+    bool running = true, show_stats = true;
+    uint32_t held_keys = 0;
+    uint16_t keybits = 0;
+    Uint64 frame_ticks = 0, fps_ticks = SDL_GetTicks64();
+    size_t vtick = 0;
+    int frames = 0;
+    uint32_t *last_frames = calloc(grid->n, sizeof *last_frames);
+    uint32_t *tile_fps = calloc(grid->n, sizeof *tile_fps);
+    struct scale8_opts opts = {
+        .fg = palettes[0].fg,
+        .bg = palettes[0].bg,
+        .error = GRIDCOLOR,
+        .grid = GRIDCOLOR,
+    };
+    if (!last_frames || !tile_fps) running = false;
+
+    printf("grid view: %d VMs in %d x %d tiles\n", grid->n, grid->cols, grid->rows);
+    while (running) {
+        SDL_Event ev;
+        while (SDL_PollEvent(&ev)) {
+            if (ev.type == SDL_QUIT) running = false;
+            if (ev.type != SDL_KEYDOWN && ev.type != SDL_KEYUP) continue;
+            keybits = update_keypad(&held_keys, ev.key.keysym.scancode, ev.type == SDL_KEYDOWN);
+            if (ev.type == SDL_KEYUP) continue;
+            switch (ev.key.keysym.scancode) {
+            case SDL_SCANCODE_ESCAPE:
+                running = false;
+                break;
+            case SDL_SCANCODE_F3:
+                palette = (palette + 1) % NUM_PALETTES;
+                opts.fg = palettes[palette].fg;
+                opts.bg = palettes[palette].bg;
+                break;
+            case SDL_SCANCODE_F4:
+                show_stats = !show_stats;
+                break;
+            default:
+                break;
+            }
+        }
+
+        // once per second: per-tile frame rates, and the totals in the title bar
+        if (has_elapsed(&fps_ticks, 1000)) {
+            int failed = 0;
+            for (int i = 0; i < grid->n; ++i) {
+                tile_fps[i] = grid->tiles[i].frames - last_frames[i];
+                last_frames[i] = grid->tiles[i].frames;
+                failed += grid->tiles[i].failed;
+            }
+            char title[96];
+            snprintf(title, sizeof title, "CHIP-8 grid: %d VMs (FPS=%d, %d failed)", grid->n, frames, failed);
+            SDL_SetWindowTitle(win, title);
+            frames = 0;
+        }
+
+        if (!has_elapsed(&frame_ticks, TmsFrHz)) {
+            SDL_Delay(1);
+            continue;
+        }
+
+        // (re)size the atlas texture to the largest scale that fits the window
+        int out_w, out_h, atlas_w, atlas_h, scale = 1;
+        if (SDL_GetRendererOutputSize(ren, &out_w, &out_h) != 0) {
+            out_w = WIN_WIDTH;
+            out_h = WIN_HEIGHT;
+        }
+        for (;;) {
+            grid_atlas_size(grid, scale + 1, &atlas_w, &atlas_h);
+            if (atlas_w > out_w || atlas_h > out_h) break;
+            ++scale;
+        }
+        grid_atlas_size(grid, scale, &atlas_w, &atlas_h);
+        if (!tex || scale != tex_scale) {
+            if (tex) SDL_DestroyTexture(tex);
+            if ((tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, atlas_w, atlas_h)) == NULL) {
+                SDL_PERRORF("SDL_CreateTexture");
+                break;
+            }
+            tex_scale = scale;
+        }
+
+        // run and draw every VM straight into the texture
+        void *pixels;
+        int pitch;
+        if (SDL_LockTexture(tex, NULL, &pixels, &pitch) != 0) {
+            SDL_PERRORF("SDL_LockTexture");
+            break;
+        }
+        grid_frame(grid, keybits, ++vtick, (uint32_t *)pixels, pitch, scale, &opts);
+        SDL_UnlockTexture(tex);
+
+        SDL_Rect dst = { (out_w - atlas_w) / 2, (out_h - atlas_h) / 2, atlas_w, atlas_h };
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+        SDL_RenderClear(ren);
+        SDL_RenderCopy(ren, tex, NULL, &dst);
+        if (show_stats) {
+            for (int i = 0; i < grid->n; ++i) {
+                char text[24];
+                int x, y, len = snprintf(text, sizeof text, "%u/%d", tile_fps[i], grid->tiles[i].cpf);
+                grid_cell_origin(grid, i, scale, &x, &y);
+                SDL_Rect box = { dst.x + x, dst.y + y, len * HUD_TEXT_W + 2, HUD_TEXT_H };
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+                SDL_RenderFillRect(ren, &box);
+                SDL_SetRenderDrawColor(ren, 0xff, 0xff, 0x40, 255);
+                hud_text(ren, box.x + 2, box.y + 1, text);
+            }
+        }
+        SDL_RenderPresent(ren);
+        ++frames;
+    }
+
+    if (tex) SDL_DestroyTexture(tex);
+    free(last_frames);
+    free(tile_fps);
+}
+
+// helper to start the netplay session GUI8_NETPLAY asks for from `vm`'s current state (NULL on error, with a message)
+static struct netplay *make_netplay(const char *spec, const struct chip8_vm *vm, int cpf) {
+    // (the peer host is everything between the first and last ':', so IPv6 addresses work too)
+    char buf[256];
+    snprintf(buf, sizeof buf, "%s", spec);
+    char *first = strchr(buf, ':'), *last = strrchr(buf, ':');
+    if (!first || first == last) {
+        fprintf(stderr, "ERROR: %s must look like LOCAL_PORT:PEER_HOST:PEER_PORT\n", GUI8_NETPLAY_ENV);
+        return NULL;
+    }
+    *first = *last = 0;
+
+    struct netplay_transport t;
+    if (!netplay_udp_open(&t, buf, first + 1, last + 1)) return NULL;
+    struct netplay_config cfg = {
+        .cpf = cpf,
+        .max_rollback = GUI8_NETPLAY_ROLLBACK,
+        .input_delay = GUI8_NETPLAY_DELAY,
+    };
+    struct netplay *np = netplay_create(vm, &t, &cfg);
+    if (!np) {
+        fprintf(stderr, "ERROR: cannot start a netplay session\n");
+        t.close(t.ctx);
+        return NULL;
+    }
+    printf("netplay: UDP port %s <-> %s:%s (rollback %d, input delay %d)\n", buf, first + 1, last + 1,
+           GUI8_NETPLAY_ROLLBACK, GUI8_NETPLAY_DELAY);
+    return np;
+}
+
+// the netplay main loop: one frame per 60Hz tick through the rollback session, whose (possibly predicted)
+// VM is what gets drawn; F3 cycles the palette, F4 toggles the rollback stats overlay
+static void run_netplay(struct netplay *np, SDL_Window *win, SDL_Renderer *ren, struct audio_out *audio) {
+    SDL_Texture *tex = NULL;
+    int tex_scale = 0, palette = 0;
+    bool running = true, show_stats = true, sound = false;
+    uint32_t held_keys = 0;
+    uint16_t keybits = 0;
+    Uint64 tick_ticks = SDL_GetTicks64(), title_ticks = tick_ticks;
+    uint64_t last_frames = 0;
+    struct scale8_opts opts = {
+        .fg = palettes[0].fg,
+        .bg = palettes[0].bg,
+        .error = GRIDCOLOR,
+        .grid = GRIDCOLOR,
+    };
+
+    while (running) {
+        SDL_Event ev;
+        while (SDL_PollEvent(&ev)) {
+            if (ev.type == SDL_QUIT) running = false;
+            if (ev.type != SDL_KEYDOWN && ev.type != SDL_KEYUP) continue;
+            keybits = update_keypad(&held_keys, ev.key.keysym.scancode, ev.type == SDL_KEYDOWN);
+            if (ev.type == SDL_KEYUP) continue;
+            switch (ev.key.keysym.scancode) {
+            case SDL_SCANCODE_ESCAPE:
+                running = false;
+                break;
+            case SDL_SCANCODE_F3:
+                palette = (palette + 1) % NUM_PALETTES;
+                opts.fg = palettes[palette].fg;
+                opts.bg = palettes[palette].bg;
+                break;
+            case SDL_SCANCODE_F4:
+                show_stats = !show_stats;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (!has_elapsed(&tick_ticks, Tms60Hz)) {
+            SDL_Delay(1);
+            continue;
+        }
+        if (netplay_frame(np, keybits, &sound) < 0) {
+            fprintf(stderr, "ERROR: netplay session failed\n");
+            break;
+        }
+        audio8_set_gate(&audio->gen, sound);
+
+        const struct netplay_stats *st = netplay_stats(np);
+        render_framebuffer(netplay_vm(np), ren, &tex, &tex_scale, &opts);
+        if (show_stats) {
+            char lines[3][64];
+            snprintf(lines[0], sizeof lines[0], "lead %d  stalls %llu", st->lead, (unsigned long long)st->stalls);
+            snprintf(lines[1], sizeof lines[1], "rollbacks %llu  deepest %d", (unsigned long long)st->rollbacks, st->max_depth);
+            snprintf(lines[2], sizeof lines[2], "cost %.1f us avg  %.1f us max",
+                     st->rollbacks ? st->rollback_ns / 1e3 / st->rollbacks : 0., st->max_rollback_ns / 1e3);
+            SDL_Rect box = { 0, 0, 30 * HUD_TEXT_W + 4, 3 * HUD_TEXT_H + 2 };
+            SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+            SDL_RenderFillRect(ren, &box);
+            SDL_SetRenderDrawColor(ren, 0xff, 0xff, 0x40, 255);
+            for (int i = 0; i < 3; ++i) hud_text(ren, 2, 1 + i * HUD_TEXT_H, lines[i]);
+        }
+        SDL_RenderPresent(ren);
+
+        // once per second: frame rate and link health in the title bar
+        if (has_elapsed(&title_ticks, 1000)) {
+            uint64_t hash;
+            uint32_t confirmed = netplay_confirmed(np, &hash);
+            char title[128];
+            snprintf(title, sizeof title, "CHIP-8 netplay (FPS=%llu, confirmed frame %u, %llu/%llu packets out/in)",
+                     (unsigned long long)(st->frames - last_frames), confirmed,
+                     (unsigned long long)st->sent, (unsigned long long)st->received);
+            SDL_SetWindowTitle(win, title);
+            last_frames = st->frames;
+        }
+    }
+
+    audio8_set_gate(&audio->gen, false);
+    if (tex) SDL_DestroyTexture(tex);
+}
+
 
 // entry point that fires up SDL2 and drives the CHIP-8 fetch/decode/execute cycle
 int main(int argc, char **argv) {
@@ -287,13 +677,35 @@ int main(int argc, char **argv) {
     bool sdl_init = false;
     SDL_Window *win = NULL;
     SDL_Renderer *ren = NULL;
+    SDL_Texture *fbtex = NULL;
+    int fbtex_scale = 0;
     SDL_AudioDeviceID snd = 0;
-    struct tone_loop *tlp = NULL;
+    static struct audio_out audio;      // (static: it is shared with the audio callback thread)
 
     char progbuf[RAM_SIZE];
     struct chip8_vm vm;
     FILE *romfile = NULL;
     int target_cpf = GUI8_DEFAULT_TARGET_CPF;
+    bool cpf_from_cli = false;
+    struct romdb *romdb = NULL;
+    uint16_t idle_pc = 0;   // PC of the ROM's busy-wait loop (from the database; 0 if unknown)
+    static struct metrics metrics;  // (static: it is shared with the metrics server thread)
+    struct metrics_server *metrics_srv = NULL;
+    struct debug8 *dbg = NULL;
+    static const bool never = false;
+    const bool *dbg_armed = &never; // (points at `dbg->armed` once we have a debugger socket)
+    struct movie_writer *movie = NULL;
+    static struct input8_queue input;   // keypad events, stamped with the VM cycle they take effect at
+    static struct chip8_vm ahead;       // speculative copy of `vm` for run-ahead
+    int runahead = 0;                   // frames to run ahead (0 = off)
+    struct shm8 *shm = NULL;
+    struct trace_writer *tracer = NULL;
+    struct grid *grid = NULL;           // (grid view only)
+    struct netplay *np = NULL;          // (netplay only)
+    struct shadow *sh = NULL;           // (shadow execution only)
+    uint32_t dbg_edits = 0;             // debugger edits already dealt with (shadow resynced, movie stopped)
+    bool bot = false;                   // has a shared-memory reader taken over the keypad...
+    uint16_t bot_keys = 0;              // ...and if so, with what keypad state?
 
     // if we have no ROM file name as a CLI arg, print a usage message and quit
     if (argc < 2) {
@@ -303,6 +715,7 @@ int main(int argc, char **argv) {
 
     if (argc > 2) {
         target_cpf = atoi(argv[2]);
+        cpf_from_cli = true;
     }
 
     // open the ROM file (for binary reading) and read up to (sizeof progbuf) bytes into `progbuf`
@@ -319,6 +732,128 @@ int main(int argc, char **argv) {
         goto cleanup;
     }
 
+    // look the ROM up in the settings database (if we have one) to pick its quirks and speed
+    uint64_t romhash = romdb_hash_rom((uint8_t *)progbuf, proglen);
+    const char *romdb_path = getenv("GUI8_ROMDB");
+    if ((romdb = romdb_open(romdb_path ? romdb_path : GUI8_ROMDB)) != NULL) {
+        const struct romdb_entry *rome = romdb_lookup(romdb, romhash);
+        if (rome) {
+            printf("found '%s' in ROM database (CPF=%u, quirks=0x%02x, idle PC=0x%03x)\n",
+                    rome->name, rome->cpf, rome->quirks, rome->idle_pc);
+            chip8_set_quirks(&vm, rome->quirks);
+            if (rome->cpf && !cpf_from_cli) target_cpf = rome->cpf;
+            idle_pc = rome->idle_pc;
+        } else {
+            printf("ROM %016llx not in database; using defaults\n", (unsigned long long)romhash);
+        }
+    }
+
+    // and warm the VM up from the ROM's static analysis (cached next to earlier ones), if asked to
+    const char *analysis_dir = getenv(GUI8_ANALYSIS_ENV);
+    if (analysis_dir) {
+        struct chip8_analysis *an = chip8_analysis_cached(analysis_dir, (uint8_t *)progbuf, proglen, vm.quirks);
+        if (!an) {
+            fprintf(stderr, "ERROR: cannot analyze ROM\n");
+            goto cleanup;
+        }
+        if (!idle_pc) idle_pc = an->idle_pc;
+        chip8_analysis_prewarm(an, &vm);
+        printf("static analysis: %u instructions, %u loops, %u sprites, idle PC=0x%03x\n",
+                an->insns, an->nloops, an->nsprites, idle_pc);
+        chip8_analysis_free(an);
+    }
+
+    // start the live metrics server, if asked to
+    metrics_init(&metrics);
+    const char *metrics_path = getenv(GUI8_METRICS_ENV);
+    if (metrics_path) {
+        if ((metrics_srv = metrics_serve(metrics_path, &metrics)) == NULL) {
+            goto cleanup;
+        }
+        printf("serving metrics on '%s'\n", metrics_path);
+    }
+
+    // and open the debugger socket, if asked to
+    const char *debug_path = getenv(GUI8_DEBUG_ENV);
+    if (debug_path) {
+        if ((dbg = debug8_listen(debug_path)) == NULL) {
+            goto cleanup;
+        }
+        dbg_armed = &dbg->armed;
+        printf("debugger can attach at '%s'\n", debug_path);
+    }
+
+    // and start recording a movie, if asked to
+    const char *movie_path = getenv(GUI8_RECORD_ENV);
+    if (movie_path) {
+        if ((movie = movie_create(movie_path, romhash, vm.quirks)) == NULL) {
+            fprintf(stderr, "ERROR: cannot create movie '%s'\n", movie_path);
+            goto cleanup;
+        }
+        printf("recording movie to '%s'\n", movie_path);
+    }
+
+    // and speculate a few frames ahead of the real VM, if asked to
+    const char *runahead_str = getenv(GUI8_RUNAHEAD_ENV);
+    if (runahead_str) {
+        runahead = atoi(runahead_str);
+        if (runahead < 0 || runahead > GUI8_MAX_RUNAHEAD) {
+            fprintf(stderr, "ERROR: %s must be between 0 and %d\n", GUI8_RUNAHEAD_ENV, GUI8_MAX_RUNAHEAD);
+            goto cleanup;
+        }
+        if (runahead) printf("running %d frame(s) ahead\n", runahead);
+    }
+
+    // and mirror the VM into shared memory, if asked to
+    const char *shm_name = getenv(GUI8_SHM_ENV);
+    if (shm_name) {
+        if ((shm = shm8_create(shm_name)) == NULL) {
+            goto cleanup;
+        }
+        printf("mirroring VM state into shared memory '%s'\n", shm_name);
+    }
+
+    // and trace every instruction, if asked to
+    const char *trace_path = getenv(GUI8_TRACE_ENV);
+    if (trace_path) {
+        if ((tracer = trace_create(trace_path, romhash)) == NULL) {
+            goto cleanup;
+        }
+        chip8_attach_tracer(&vm, trace_tracer(tracer));
+        printf("tracing instructions into '%s' (F5 pauses/resumes)\n", trace_path);
+    }
+
+    // and check the core against the reference interpreter, if asked to
+    const char *shadow_spec = getenv(GUI8_SHADOW_ENV);
+    if (shadow_spec) {
+        struct shadow_config shcfg = { 0 };
+        if (!shadow_parse(shadow_spec, &shcfg)) {
+            fprintf(stderr, "ERROR: %s must be 'insn', 'block' or a number of vticks\n", GUI8_SHADOW_ENV);
+            goto cleanup;
+        }
+        if ((sh = shadow_create(&vm, &shcfg)) == NULL) {
+            fprintf(stderr, "ERROR: cannot start shadow execution\n");
+            goto cleanup;
+        }
+        printf("shadow-executing against the reference interpreter (%s)\n", shadow_spec);
+    }
+
+    // or run a whole grid of VMs instead, if asked to
+    const char *grid_spec = getenv(GUI8_GRID_ENV);
+    if (grid_spec) {
+        if ((grid = make_grid(grid_spec, argv[1], romdb, cpf_from_cli ? target_cpf : 0, cpf_from_cli)) == NULL) {
+            goto cleanup;
+        }
+    }
+
+    // or play against a peer over the network, if asked to
+    const char *netplay_spec = getenv(GUI8_NETPLAY_ENV);
+    if (netplay_spec && !grid) {
+        if ((np = make_netplay(netplay_spec, &vm, target_cpf ? target_cpf : GUI8_DEFAULT_TARGET_CPF)) == NULL) {
+            goto cleanup;
+        }
+    }
+
     // initialze the SDL2 library and set up a window/rendering system
     printf("initializing SDL...\n");
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_AUDIO) != 0) {
@@ -327,7 +862,7 @@ int main(int argc, char **argv) {
     }
     sdl_init = true;
 
-    if ((win = SDL_CreateWindow(TITLE, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIN_WIDTH, WIN_HEIGHT, SDL_WINDOW_SHOWN)) == NULL) {
+    if ((win = SDL_CreateWindow(TITLE, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIN_WIDTH, WIN_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE)) == NULL) {
         SDL_PERRORF("SDL_CreateWindow");
         goto cleanup;
     }
@@ -336,45 +871,84 @@ int main(int argc, char **argv) {
         SDL_PERRORF("SDL_CreateRenderer");
         goto cleanup;
     }
+    printf("framebuffer upscaler: %s\n", scale8_isa());
 
-    // generate the audio samples for our CHIP-8 buzzer/beeper tone
-    struct tone_context tc = {
-        .freq = 440.f,
-        .level = 127.5f,
-    };
-    if ((tlp = gen_tone_loop(SAMPLING_RATE, SAMPLER_FUNC, (void *)&tc)) == NULL) {
-        fprintf(stderr, "ERROR allocating audio samples\n");
-        goto cleanup;
-    }
+    // set up the tone generator for our CHIP-8 buzzer/beeper (silent until the VM turns the sound on)
+    int waveform = GUI8_WAVEFORM;
+    audio8_init(&audio.gen, SAMPLING_RATE);
+    audio8_set_wave(&audio.gen, waveform);
+    audio8_set_freq(&audio.gen, GUI8_TONE_HZ);
+    audio8_set_volume(&audio.gen, GUI8_VOLUME);
+    audio.underruns = &metrics.audio_underruns;
 
-    // initialize the SDL2 sound system to play our audio samples
+    // initialize the SDL2 sound system to play it (the device runs all the time; the generator's gate
+    // follows the CHIP-8 sound timer, so beeps start/stop with sample accuracy and without device churn)
     const SDL_AudioSpec spec_wanted = {
         .freq = SAMPLING_RATE,
-        .format = AUDIO_U8,
+        .format = AUDIO_S16SYS,
         .channels = 1,
         .samples = 512,
-        .callback = tone_loop_cb,
-        .userdata = (void *)tlp,
+        .callback = audio_cb,
+        .userdata = (void *)&audio,
     };
     SDL_AudioSpec spec_got;
     if ((snd = SDL_OpenAudioDevice(NULL, 0, &spec_wanted, &spec_got, 0)) == 0) {
         SDL_PERRORF("SDL_OpenAudioDevice");
         goto cleanup;
     }
+    SDL_PauseAudioDevice(snd, 0);
+
+    // key presses/releases get queued for the VM as they arrive (see the SDL_KEYDOWN/SDL_KEYUP handling)
+    input8_init(&input);
+    uint32_t held_keys = 0;             // which key bindings are down right now
+    uint16_t keybits = 0;               // the keypad state the VM is running with
+    uint16_t pad_now = 0;               // the keypad state as of the latest key event (for run-ahead)
+    Uint64 runahead_ticks = 0;          // time spent on run-ahead this second (performance counter ticks)
+    uint64_t frame_cycle0 = 0;          // VM cycle count when the current frame interval began
+
+    // performance HUD (F4) and what it samples each frame (only collected while it is shown)
+    static struct hud hud;
+    bool show_hud = false;
+    Uint64 hud_emu = 0;                 // performance counter ticks spent executing this frame
+    Uint64 hud_render = 0;              // ... and rendering the last frame
+    Uint64 hud_frame_pc = 0;            // performance counter at the last rendered frame
+    Uint64 hud_late = 0;                // worst vtick lateness this frame (ms)
+    size_t hud_vtick0 = 0;              // vtick at the last rendered frame
+
+    // the grid view has a loop of its own
+    if (grid) {
+        run_grid(grid, win, ren);
+        ret = EXIT_SUCCESS;
+        goto cleanup;
+    }
+
+    // and so does netplay
+    if (np) {
+        run_netplay(np, win, ren, &audio);
+        ret = EXIT_SUCCESS;
+        goto cleanup;
+    }
 
-    // get access to SDL2's "keystate array" (one byte per key; 0 if up, 1 if down)
-    int keystate_len;
-    const Uint8 *keystate = SDL_GetKeyboardState(&keystate_len);
-   
     // PREPARE TO ENTER THE MAIN GAME LOOP...	
     SDL_Event ev;
     bool running = true, sound_on = false;		// game loop termination flag, sound on/off flag
+    bool turbo = false;                         // fast-forwarding? (Tab toggles)
+    int turbo_cpf = 0;                          // cycles per virtual frame while fast-forwarding
+    int sec_vticks = 0;                         // vticks delivered this second (for the fast-forward speed readout)
     int frames = 0, cycles = 0, cpf = 0;	    // counters for tracking frames-per-second (FPS) and cycles-per-frame (CPF)
+    Uint64 idle_ms = 0;                         // time spent sleeping this second (for the idle-% metric)
     Uint64 vsync_ticks = SDL_GetTicks64();		// clock ticks for the primary 60Hz "vsync timer" that CHIP-8 depends on for timing
     Uint64 fps_ticks = vsync_ticks;				// clock ticks for FPS timer (i.e., once-per-second)
     Uint64 frame_ticks = 0;						// clock ticks for frame-render (i.e., our target FPS)
     size_t vtick = 0;							// count the elapsed "vsync timer ticks," for helping CHIP-8 know what time it is
-    bool render_grid = false;					// debugging help: draw a visible pixel grid (on/off)
+    int palette = 0;                            // index of the current color scheme in `palettes`
+    struct scale8_opts scale_opts = {           // upscaler colors and effects (grid is a debugging help)
+        .fg = palettes[0].fg,
+        .bg = palettes[0].bg,
+        .error = GRIDCOLOR,
+        .grid = GRIDCOLOR,
+        .effects = 0,
+    };
 
     // ENTER THE MAIN GAME LOOP!
     while (running) {
@@ -387,11 +961,72 @@ quitting:
                 running = false;
                 break;
             case SDL_KEYDOWN: // or via Escape key press
+            case SDL_KEYUP:
+                if (!ev.key.repeat) {
+                    // timestamp the new keypad state with a virtual cycle: a key event that happened
+                    // X% of the way through this frame interval takes effect X% of the way through the
+                    // *next* frame's cycles, so input latency is always exactly one frame, and a tap
+                    // shorter than a frame still lasts (proportionally) as many cycles as it should
+                    uint64_t budget = target_cpf ? target_cpf : MAX(cpf, 1);
+                    Uint32 dt = ev.key.timestamp - (Uint32)frame_ticks;
+                    if (dt > TmsFrHz) dt = TmsFrHz; // (also catches events stamped before the interval began)
+                    uint64_t stamp = frame_cycle0 + budget + dt * budget / TmsFrHz;
+                    uint16_t pad = update_keypad(&held_keys, ev.key.keysym.scancode, ev.type == SDL_KEYDOWN);
+                    pad_now = pad;
+                    if (!input8_push(&input, stamp, pad)) {
+                        // (the VM isn't consuming events, e.g., it is stopped in the debugger;
+                        // we're also the consumer, so make room by applying everything queued)
+                        input8_keys_at(&input, UINT64_MAX);
+                        input8_push(&input, stamp, pad);
+                    }
+                }
+                if (ev.type == SDL_KEYUP) break;
                 switch (ev.key.keysym.scancode) {
                 case SDL_SCANCODE_ESCAPE:
                     goto quitting;
                 case SDL_SCANCODE_F1:
-                    render_grid = !render_grid;
+                    scale_opts.effects ^= SCALE8_GRID;
+                    break;
+                case SDL_SCANCODE_F2:
+                    scale_opts.effects ^= SCALE8_SCANLINES;
+                    break;
+                case SDL_SCANCODE_F3:
+                    palette = (palette + 1) % NUM_PALETTES;
+                    scale_opts.fg = palettes[palette].fg;
+                    scale_opts.bg = palettes[palette].bg;
+                    break;
+                case SDL_SCANCODE_F4:
+                    show_hud = !show_hud;
+                    if (show_hud) {
+                        hud_reset(&hud);
+                        hud_frame_pc = 0;
+                    }
+                    break;
+                case SDL_SCANCODE_F6:
+                    waveform = (waveform + 1) % AUDIO8_NUM_WAVES;
+                    if (waveform == AUDIO8_PATTERN) {
+                        audio8_set_pattern(&audio.gen, demo_pattern, DEMO_PATTERN_PITCH);
+                    } else {
+                        audio8_set_wave(&audio.gen, waveform);
+                        audio8_set_freq(&audio.gen, GUI8_TONE_HZ);
+                    }
+                    printf("beep waveform: %s\n", audio8_wave_name(waveform));
+                    break;
+                case SDL_SCANCODE_F5:
+                    if (tracer) {
+                        bool on = !vm.trace;
+                        chip8_attach_tracer(&vm, on ? trace_tracer(tracer) : NULL);
+                        if (!on) trace_flush(tracer); // (so the file is complete up to here)
+                        printf("tracing %s (%llu instructions so far)\n", on ? "resumed" : "paused",
+                                (unsigned long long)trace_records(tracer));
+                    }
+                    break;
+                case SDL_SCANCODE_TAB:
+                    // fast-forward: vticks stop following the wall clock and instead advance after every
+                    // virtual frame's worth of cycles, as fast as we can run them
+                    turbo = !turbo;
+                    turbo_cpf = target_cpf ? target_cpf : MAX(cpf, 1);
+                    vsync_ticks = SDL_GetTicks64(); // (the 60Hz clock resumes from now, not from before)
                     break;
                 default:
                     break;
@@ -402,66 +1037,199 @@ quitting:
             }
         }
 
-        // update `vticks` on a 60Hz timer interval
-        if (has_elapsed(&vsync_ticks, Tms60Hz)) {
+        // update `vticks` on a 60Hz timer interval (noting how late past the interval we noticed it)
+        // (unless fast-forwarding, see below)
+        Uint64 last_vsync = vsync_ticks;
+        if (!turbo && has_elapsed(&vsync_ticks, Tms60Hz)) {
             ++vtick;
+            ++sec_vticks;
+            metrics_add(&metrics.vticks, 1);
+            metrics_observe(&metrics.vtick_lateness_ms, vsync_ticks - last_vsync - Tms60Hz);
+            hud_late = MAX(hud_late, vsync_ticks - last_vsync - Tms60Hz);
         }
 
         // once per second, update the visual FPS/CPF counters (in the window title bar)
         if (has_elapsed(&fps_ticks, 1000)) {
-            char title_buff[128];
-            snprintf(title_buff, sizeof title_buff, "CHIP-8 (FPS=%d, CPF=%d)", frames, cpf);
+            char title_buff[160];
+            int len = snprintf(title_buff, sizeof title_buff, "CHIP-8 (FPS=%d, CPF=%d", frames, cpf);
+            if (turbo) {
+                // (speed relative to a real CHIP-8's 60 vticks per second)
+                len += snprintf(title_buff + len, sizeof title_buff - len, ", fast-forward %.1fx", sec_vticks / 60.0);
+            }
+            if (runahead) {
+                // (run-ahead cost: average per rendered frame)
+                Uint64 us = runahead_ticks * 1000000 / SDL_GetPerformanceFrequency() / MAX(frames, 1);
+                len += snprintf(title_buff + len, sizeof title_buff - len, ", run-ahead=%d: %llu us/frame",
+                        runahead, (unsigned long long)us);
+            }
+            snprintf(title_buff + len, sizeof title_buff - len, ")");
+            runahead_ticks = 0;
+            sec_vticks = 0;
             SDL_SetWindowTitle(win, title_buff);
+            metrics_set(&metrics.fps, frames);
+            metrics_set(&metrics.idle_percent, idle_ms / 10);
             frames = 0;
+            idle_ms = 0;
         }
 
-        // scan through our defined key bindings and set the "keypad keys down" bitmask used by CHIP-8
-        // (i.e., figure out what keys are currently down/up)
-        uint16_t keybits = 0u;
-        FOREACH_KEY(kp) {
-            if (keystate[kp->scancode]) keybits |= kp->keymask;
+        // EXECUTE CHIP-8 VM FETCH/DECODE/EXECUTE cycles: a single one per trip around this loop
+        // normally, but a whole virtual frame's worth (followed by a vtick) while fast-forwarding
+        // (unless an attached debugger has the VM stopped--or wants it stopped right here)
+        int batch = turbo ? turbo_cpf : 1, n;
+        Uint64 emu_t0 = show_hud ? SDL_GetPerformanceCounter() : 0;
+        if (dbg && dbg->edits != dbg_edits) {
+            // (the debugger changed the VM behind chip8_cycle's back: the shadow has to catch up, and
+            // a replay of the movie never could)
+            if (sh) shadow_resync(sh);
+            if (movie) {
+                fprintf(stderr, "ERROR: debugger edited the VM (movie recording stopped)\n");
+                movie_finish(movie);
+                movie = NULL;
+            }
+            dbg_edits = dbg->edits;
         }
+        for (n = 0; n < batch; ++n) {
+            // pick up the keypad state for exactly the cycle we are about to run
+            keybits = input8_keys_at(&input, chip8_get_cycles(&vm));
+            if (bot) keybits = bot_keys;
+            if (movie) movie_input(movie, chip8_get_cycles(&vm), keybits, vtick);
 
-        // EXECUTE A SINGLE CHIP-8 VM FETCH/DECODE/EXECUTE cycle
-        bool old_sound_on = sound_on;
-        uint16_t old_pc = chip8_get_pc(&vm);
-        if (!chip8_cycle(&vm, keybits, vtick, &sound_on)) {
-            fprintf(stderr, "ERROR: illegal instruction @ PC=0x%04x (instruction=0x%02x%02x)\n",
-                    old_pc,
-                    chip8_get_ram(&vm, old_pc),
-                    chip8_get_ram(&vm, old_pc + 1));
-            running = false;
-        }
-        ++cycles;
+            uint16_t old_pc = chip8_get_pc(&vm);
+            if (*dbg_armed && debug8_check(dbg, &vm)) {
+                debug8_poll(dbg, &vm);  // keep taking commands while stopped
+                SDL_Delay(1);
+                break;
+            } else if (!(sh ? shadow_cycle(sh, &vm, keybits, vtick, &sound_on) : chip8_cycle(&vm, keybits, vtick, &sound_on))) {
+                fprintf(stderr, "ERROR: illegal instruction @ PC=0x%04x (instruction=0x%02x%02x)\n",
+                        old_pc,
+                        chip8_get_ram(&vm, old_pc),
+                        chip8_get_ram(&vm, old_pc + 1));
+                metrics_add(&metrics.errors, 1);
 
-        // if CHIP-8 turned the sound ON, un-pause the audio device to get our tone generator going
-        if (old_sound_on && !sound_on) {
-            SDL_PauseAudioDevice(snd, 1);
-        } else if (!old_sound_on && sound_on) {
-            // otherwise, if we turned the sound OFF, pause the tone generator
-            SDL_PauseAudioDevice(snd, 0);
+                // a debugger (if attached) gets to look around instead of us quitting
+                chip8_set_pc(&vm, old_pc);
+                if (!debug8_stop(dbg, &vm, "error")) {
+                    running = false;
+                }
+                break;
+            } else {
+                ++cycles;
+            }
         }
+        if (show_hud) hud_emu += SDL_GetPerformanceCounter() - emu_t0;
+        if (turbo && n == batch) {
+            ++vtick;
+            ++sec_vticks;
+            metrics_add(&metrics.vticks, 1);
+        }
+
+        // sound the tone while CHIP-8 has the sound on (muted while fast-forwarding)
+        audio8_set_gate(&audio.gen, sound_on && !turbo);
 
         // is it time to render a new frame?
+        Uint64 last_frame = frame_ticks;
         if (has_elapsed(&frame_ticks, TmsFrHz)) {
-            render_framebuffer(&vm, ren, render_grid);
+            Uint64 render_t0 = show_hud ? SDL_GetPerformanceCounter() : 0;
+            if (show_hud) {
+                // (one sample per series per frame; render time is the previous frame's,
+                // since this one's isn't known until it's presented)
+                double to_ms = 1000.0 / SDL_GetPerformanceFrequency();
+                size_t vticks = vtick - hud_vtick0;
+                float values[HUD_NUM_SERIES] = {
+                    [HUD_FRAME_MS] = hud_frame_pc ? (float)((render_t0 - hud_frame_pc) * to_ms) : 0,
+                    [HUD_EMU_MS] = (float)(hud_emu * to_ms),
+                    [HUD_RENDER_MS] = (float)(hud_render * to_ms),
+                    [HUD_VTICK_LATE_MS] = (float)hud_late,
+                    [HUD_CYCLES_PER_VTICK] = vticks ? (float)(chip8_get_cycles(&vm) - frame_cycle0) / vticks : 0,
+                    [HUD_AUDIO_GAP_MS] = atomic_exchange(&audio.max_gap_us, 0) / 1000.f,
+                };
+                if (hud_frame_pc) hud_push(&hud, values);
+                hud_frame_pc = render_t0;
+            }
+            hud_emu = hud_late = 0;
+            hud_vtick0 = vtick;
+            if (runahead) {
+                // show where the game will be `runahead` frames from now if the keys stay as they are now
+                // (skipped while a debugger has the VM stopped, so it shows the real state)
+                Uint64 t0 = SDL_GetPerformanceCounter();
+                int ra_cpf = target_cpf ? target_cpf : MAX(cpf, 1);
+                bool stopped = dbg && dbg->paused;
+                run_ahead(&vm, &ahead, stopped ? 0 : runahead, ra_cpf, pad_now, vtick);
+                Uint64 spent = SDL_GetPerformanceCounter() - t0;
+                runahead_ticks += spent;
+                metrics_observe(&metrics.runahead_us, spent * 1000000 / SDL_GetPerformanceFrequency());
+                render_framebuffer(&ahead, ren, &fbtex, &fbtex_scale, &scale_opts);
+            } else {
+                render_framebuffer(&vm, ren, &fbtex, &fbtex_scale, &scale_opts);
+            }
+            if (show_hud) hud_draw(&hud, ren);
+            SDL_RenderPresent(ren);
+            if (show_hud) hud_render = SDL_GetPerformanceCounter() - render_t0;
+            if (dbg) debug8_poll(dbg, &vm); // (check in with the debugger socket once per frame)
+            if (shm) {
+                // (and with the shared-memory segment: publish our state, see if a bot is driving)
+                shm8_publish(shm, &vm, keybits, vtick);
+                bot = shm8_input_override(shm, &bot_keys);
+            }
+            if (movie && !movie_write_frame(movie, chip8_get_cycles(&vm), &vm.fb[0][0], sound_on)) {
+                fprintf(stderr, "ERROR: cannot write movie frame (recording stopped)\n");
+                movie_finish(movie);
+                movie = NULL;
+            }
+            frame_cycle0 = chip8_get_cycles(&vm);
             ++frames;
             cpf = cycles;
             cycles = 0;
-        } else if (target_cpf && (cycles >= target_cpf)) {
+
+            // publish this frame's counts (once per frame keeps the atomics out of the per-cycle path)
+            metrics_add(&metrics.frames_rendered, 1);
+            metrics_add(&metrics.instructions, cpf);
+            metrics_set(&metrics.cpf, cpf);
+            metrics_observe(&metrics.cycles_per_frame, cpf);
+            if (sh) {
+                metrics_set(&metrics.shadow_checks, shadow_stats(sh)->checks);
+                metrics_set(&metrics.shadow_divergences, shadow_stats(sh)->divergences);
+            }
+            if (last_frame && (frame_ticks - last_frame >= 2 * TmsFrHz)) {
+                metrics_add(&metrics.frames_skipped, (frame_ticks - last_frame) / TmsFrHz - 1);
+            }
+        } else if (!turbo && ((target_cpf && (cycles >= target_cpf)) || (idle_pc && (chip8_get_pc(&vm) == idle_pc)))) {
             // we can sleep until the next frame is ready
+            // (we either ran enough cycles, or the ROM is just spinning in its known busy-wait loop)
             Uint64 next = (frame_ticks + TmsFrHz);
             Uint64 now = SDL_GetTicks64();
-            SDL_Delay(MAX(next - now - 1, 1));
+            // (the frame can already be due, and the unsigned difference would wrap)
+            Uint32 nap = (now + 1 < next) ? (Uint32)(next - now - 1) : 1;
+            SDL_Delay(nap);
+            idle_ms += nap;
+            metrics_add(&metrics.idle_ms, nap);
         }
     }
 
+    if (sh) {
+        shadow_flush(sh, &vm);
+        const struct shadow_stats *st = shadow_stats(sh);
+        printf("shadow execution: %llu of %llu instructions checked in %llu comparisons, %llu divergence(s)\n",
+               (unsigned long long)st->shadowed, (unsigned long long)st->cycles,
+               (unsigned long long)st->checks, (unsigned long long)st->divergences);
+    }
+
     ret = EXIT_SUCCESS;
 cleanup:
     if (snd) SDL_CloseAudioDevice(snd);
+    if (fbtex) SDL_DestroyTexture(fbtex);
     if (ren) SDL_DestroyRenderer(ren);
     if (win) SDL_DestroyWindow(win);
     if (sdl_init) SDL_Quit();
     if (romfile) fclose(romfile);
+    romdb_close(romdb);
+    metrics_stop(metrics_srv);
+    debug8_close(dbg);
+    shm8_close(shm);
+    grid_destroy(grid);
+    netplay_destroy(np);
+    shadow_destroy(sh);
+    if (!trace_close(tracer)) fprintf(stderr, "ERROR: trace file may be incomplete\n");
+    if (!movie_finish(movie)) fprintf(stderr, "ERROR: movie file may be incomplete\n");
     return ret;
 }
@@ -0,0 +1,120 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hud.h"
+
+// layout (in window pixels)
+#define FONT_SCALE 2                        // each font pixel is a 2x2 block
+#define GLYPH_W HUD_TEXT_W                  // 3 pixels + 1 spacing, doubled
+#define TEXT_H HUD_TEXT_H
+#define GRAPH_W HUD_HISTORY                 // one column per frame
+#define PANEL_W (40 * GLYPH_W)              // (room for the longest caption)
+#define GRAPH_H 28
+#define ROW_H (TEXT_H + GRAPH_H + 6)
+#define MARGIN 6
+
+// what each series is called, which color its bars are, and the smallest full-scale value
+// (so a flat, quiet graph doesn't get magnified into noise)
+static const struct series_style {
+    const char *label;
+    const char *unit;
+    uint8_t r, g, b;
+    float min_scale;
+} styles[HUD_NUM_SERIES] = {
+    [HUD_FRAME_MS]          = { "FRAME",  "MS", 0x40, 0xe0, 0x40, 33.f },
+    [HUD_EMU_MS]            = { "EMU",    "MS", 0x40, 0xa0, 0xff, 4.f },
+    [HUD_RENDER_MS]         = { "RENDER", "MS", 0xff, 0xc0, 0x40, 4.f },
+    [HUD_VTICK_LATE_MS]     = { "VTICK LATE", "MS", 0xff, 0x60, 0x60, 4.f },
+    [HUD_CYCLES_PER_VTICK]  = { "CYCLES/VTICK", "", 0xc0, 0x80, 0xff, 16.f },
+    [HUD_AUDIO_GAP_MS]      = { "AUDIO GAP", "MS", 0x40, 0xe0, 0xe0, 16.f },
+};
+
+// 3x5 font: 5 rows of 3 bits (MSB = left), row 0 in bits 14-12
+static const char font_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ./=:-%";
+static const uint16_t font_glyphs[] = {
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7292,
+    0x7bef, 0x7bcf, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4,
+    0x396b, 0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d,
+    0x2b6a, 0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a,
+    0x5bfd, 0x5aad, 0x5a92, 0x72a7, 0x0002, 0x12a4, 0x0e38, 0x0410,
+    0x01c0, 0x52a5,
+};
+
+void hud_reset(struct hud *h) {
+    memset(h, 0, sizeof *h);
+}
+
+void hud_push(struct hud *h, const float values[HUD_NUM_SERIES]) {
+    for (int s = 0; s < HUD_NUM_SERIES; ++s) h->samples[s][h->pos] = values[s];
+    h->pos = (h->pos + 1) % HUD_HISTORY;
+    if (h->count < HUD_HISTORY) ++h->count;
+}
+
+static int cmp_float(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+void hud_text(SDL_Renderer *ren, int x, int y, const char *text) {
+    for (; *text; ++text, x += GLYPH_W) {
+        const char *c = strchr(font_chars, *text);
+        if (*text == ' ' || !c) continue;
+        uint16_t glyph = font_glyphs[c - font_chars];
+        for (int row = 0; row < 5; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                if (glyph & (1 << (14 - 3 * row - col))) {
+                    SDL_Rect px = { x + col * FONT_SCALE, y + row * FONT_SCALE, FONT_SCALE, FONT_SCALE };
+                    SDL_RenderFillRect(ren, &px);
+                }
+            }
+        }
+    }
+}
+
+void hud_draw(const struct hud *h, SDL_Renderer *ren) {
+    SDL_Rect panel = { MARGIN, MARGIN, PANEL_W + 2 * MARGIN, HUD_NUM_SERIES * ROW_H + MARGIN };
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 0xb0);
+    SDL_RenderFillRect(ren, &panel);
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+
+    for (int s = 0; s < HUD_NUM_SERIES; ++s) {
+        const struct series_style *st = &styles[s];
+        int x0 = panel.x + MARGIN, y0 = panel.y + MARGIN + s * ROW_H;
+        float sorted[HUD_HISTORY], p50 = 0, p99 = 0, last = 0;
+
+        if (h->count) {
+            // (until the ring wraps, the samples are exactly its first `count` slots)
+            memcpy(sorted, h->samples[s], sizeof sorted[0] * h->count);
+            qsort(sorted, h->count, sizeof sorted[0], cmp_float);
+            p50 = sorted[h->count / 2];
+            p99 = sorted[(h->count * 99) / 100];
+            last = h->samples[s][(h->pos + HUD_HISTORY - 1) % HUD_HISTORY];
+        }
+
+        char text[64];
+        snprintf(text, sizeof text, "%s %.1f%s  P50 %.1f  P99 %.1f", st->label, last, st->unit, p50, p99);
+        SDL_SetRenderDrawColor(ren, 0xff, 0xff, 0xff, 0xff);
+        hud_text(ren, x0, y0, text);
+
+        // bars, oldest on the left, scaled so p99 sits at ~80% of the graph height
+        float full = p99 * 1.25f;
+        if (full < st->min_scale) full = st->min_scale;
+        int gy = y0 + TEXT_H;
+        SDL_SetRenderDrawColor(ren, 0x30, 0x30, 0x30, 0xff);
+        SDL_RenderDrawLine(ren, x0, gy + GRAPH_H, x0 + GRAPH_W - 1, gy + GRAPH_H);
+        SDL_SetRenderDrawColor(ren, st->r, st->g, st->b, 0xff);
+        for (int i = 0; i < h->count; ++i) {
+            int slot = (h->pos + HUD_HISTORY - h->count + i) % HUD_HISTORY;
+            float v = h->samples[s][slot];
+            int bar = (int)(v / full * GRAPH_H + 0.5f);
+            if (bar > GRAPH_H) bar = GRAPH_H;
+            if (bar > 0) {
+                int x = x0 + GRAPH_W - h->count + i;
+                SDL_RenderDrawLine(ren, x, gy + GRAPH_H - bar, x, gy + GRAPH_H - 1);
+            }
+        }
+    }
+}
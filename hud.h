@@ -0,0 +1,52 @@
+#ifndef _HUD_H
+#define _HUD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+
+// IN-WINDOW PERFORMANCE HUD (ROLLING GRAPHS WITH p50/p99)
+//--------------------------------------------------------------
+//
+// The host pushes one sample per series per rendered frame and, while the HUD is shown,
+// calls hud_draw() between its RenderCopy and RenderPresent.  Each series is drawn as a
+// bar graph of the last HUD_HISTORY frames (auto-scaled to its p99) with its latest value
+// and p50/p99 printed above it, using a built-in 3x5 pixel font (no SDL_ttf needed).
+
+enum hud_series {
+    HUD_FRAME_MS,           // time between rendered frames
+    HUD_EMU_MS,             // time spent in chip8_cycle batches during the frame
+    HUD_RENDER_MS,          // time spent rendering (upscale + run-ahead + present)
+    HUD_VTICK_LATE_MS,      // worst vtick lateness during the frame
+    HUD_CYCLES_PER_VTICK,   // instructions executed per 60Hz tick
+    HUD_AUDIO_GAP_MS,       // longest gap between audio callbacks (what the device buffer must cover)
+    HUD_NUM_SERIES
+};
+
+#define HUD_HISTORY 240
+
+// size of a hud_text() character cell
+#define HUD_TEXT_W 8
+#define HUD_TEXT_H 12
+
+struct hud {
+    float samples[HUD_NUM_SERIES][HUD_HISTORY];
+    int pos;        // slot the next sample goes into
+    int count;      // number of valid samples (up to HUD_HISTORY)
+};
+
+// forget all samples
+void hud_reset(struct hud *h);
+
+// record one frame's worth of samples (`values` indexed by enum hud_series)
+void hud_push(struct hud *h, const float values[HUD_NUM_SERIES]);
+
+// draw the HUD in the top-left corner of the current render target
+void hud_draw(const struct hud *h, SDL_Renderer *ren);
+
+// draw `text` (digits, capitals and ./=:-%; anything else comes out blank) with the HUD's font
+// in the current draw color, top-left corner at (x, y); HUD_TEXT_W/HUD_TEXT_H pixels per character
+void hud_text(SDL_Renderer *ren, int x, int y, const char *text);
+
+#endif
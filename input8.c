@@ -0,0 +1,38 @@
+// some standard library/system headers
+#include <string.h>
+
+#include "input8.h"
+
+void input8_init(struct input8_queue *q) {
+    memset(q->ring, 0, sizeof q->ring);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->last_cycle = 0;
+    q->keys = 0;
+}
+
+bool input8_push(struct input8_queue *q, uint64_t cycle, uint16_t keys) {
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&q->tail, memory_order_acquire) == INPUT8_QUEUE_SIZE) {
+        return false;
+    }
+    if (cycle < q->last_cycle) cycle = q->last_cycle;
+    q->last_cycle = cycle;
+
+    // fill in the slot first, then publish it by moving `head` (release pairs with the consumer's acquire)
+    q->ring[head % INPUT8_QUEUE_SIZE].cycle = cycle;
+    q->ring[head % INPUT8_QUEUE_SIZE].keys = keys;
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+uint16_t input8_apply(struct input8_queue *q, uint64_t cycle) {
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    while (tail != head && q->ring[tail % INPUT8_QUEUE_SIZE].cycle <= cycle) {
+        q->keys = q->ring[tail % INPUT8_QUEUE_SIZE].keys;
+        ++tail;
+    }
+    atomic_store_explicit(&q->tail, tail, memory_order_release);
+    return q->keys;
+}
@@ -0,0 +1,58 @@
+#ifndef _INPUT8_H
+#define _INPUT8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// TIMESTAMPED KEYPAD INPUT QUEUE
+//--------------------------------------------------------------
+//
+// Instead of sampling the keyboard before every cycle, a host turns each key press/release
+// into one event: "from virtual cycle C on, the keypad state is MASK" (C counts instructions,
+// as chip8_get_cycles() does).  The VM side then asks for the keypad state at the cycle it
+// is about to run, so a tap shorter than a batch/frame of cycles still gets seen, for the
+// same number of cycles, every time.
+//
+// The queue is a lock-free single-producer/single-consumer ring: one thread may push
+// (e.g., an SDL event watch) while another runs the VM.  Pushed timestamps are kept
+// non-decreasing (an event stamped "in the past" just applies at the next cycle).
+
+// capacity of the ring (power of two); a full queue drops new events (see input8_push)
+#define INPUT8_QUEUE_SIZE 256
+
+struct input8_event {
+    uint64_t cycle;     // first cycle this keypad state applies to
+    uint16_t keys;      // keypad state (bit N = key N down)
+};
+
+struct input8_queue {
+    struct input8_event ring[INPUT8_QUEUE_SIZE];
+    _Atomic uint32_t head;  // next slot the producer writes
+    _Atomic uint32_t tail;  // next slot the consumer reads
+
+    uint64_t last_cycle;    // (producer only) stamp of the newest event pushed
+    uint16_t keys;          // (consumer only) keypad state as of the last input8_keys_at()
+};
+
+// empty the queue (all keys up)
+void input8_init(struct input8_queue *q);
+
+// (producer) queue a new keypad state taking effect at `cycle` (false if the queue is full)
+bool input8_push(struct input8_queue *q, uint64_t cycle, uint16_t keys);
+
+// slow path of input8_keys_at (applies every event due by `cycle`)
+uint16_t input8_apply(struct input8_queue *q, uint64_t cycle);
+
+// (consumer) the keypad state to run cycle number `cycle` with (call with non-decreasing `cycle`)
+static inline uint16_t input8_keys_at(struct input8_queue *q, uint64_t cycle) {
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&q->head, memory_order_acquire)
+            || q->ring[tail % INPUT8_QUEUE_SIZE].cycle > cycle) {
+        return q->keys;
+    }
+    return input8_apply(q, cycle);
+}
+
+#endif
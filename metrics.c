@@ -0,0 +1,182 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <errno.h>
+
+// POSIX sockets/threads for the server
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "metrics.h"
+#include "sock8.h"
+
+struct metrics_server {
+    int fd;                     // listening socket
+    pthread_t thread;
+    const struct metrics *m;
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+};
+
+// helper to read a monotonic clock in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void metrics_init(struct metrics *m) {
+    memset(m, 0, sizeof *m);
+    m->start_ns = now_ns();
+}
+
+// append-to-buffer helper state for metrics_format
+struct fmtbuf {
+    char *buf;
+    size_t len;
+    size_t pos;
+};
+
+static void emit(struct fmtbuf *fb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = (fb->pos < fb->len) ? fb->len - fb->pos : 0;
+    int n = vsnprintf(room ? fb->buf + fb->pos : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0) fb->pos += n;
+}
+
+// helper to read a counter
+#define LOAD(field) atomic_load_explicit(&(field), memory_order_relaxed)
+
+static void emit_scalar(struct fmtbuf *fb, const char *name, const char *type, const char *help, uint64_t v) {
+    emit(fb, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n", name, help, name, type, name, (unsigned long long)v);
+}
+
+static void emit_hist(struct fmtbuf *fb, const char *name, const char *help, const struct metrics_hist *h) {
+    uint64_t cumulative = 0;
+    emit(fb, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    for (int i = 0; i < METRICS_HIST_BUCKETS - 1; ++i) {
+        cumulative += LOAD(h->buckets[i]);
+        emit(fb, "%s_bucket{le=\"%llu\"} %llu\n", name, (unsigned long long)((1ull << i) - 1), (unsigned long long)cumulative);
+    }
+    cumulative += LOAD(h->buckets[METRICS_HIST_BUCKETS - 1]);
+    emit(fb, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+    emit(fb, "%s_sum %llu\n%s_count %llu\n", name, (unsigned long long)LOAD(h->sum), name, (unsigned long long)cumulative);
+}
+
+size_t metrics_format(const struct metrics *m, char *buf, size_t len) {
+    struct fmtbuf fb = { .buf = buf, .len = len, .pos = 0 };
+    if (len) buf[0] = '\0';
+
+    emit_scalar(&fb, "chip8_instructions_total", "counter", "CHIP-8 instructions executed.", LOAD(m->instructions));
+    emit_scalar(&fb, "chip8_vticks_total", "counter", "60Hz timer ticks delivered to the VM.", LOAD(m->vticks));
+    emit_scalar(&fb, "chip8_frames_rendered_total", "counter", "Frames drawn.", LOAD(m->frames_rendered));
+    emit_scalar(&fb, "chip8_frames_skipped_total", "counter", "Frame intervals missed without drawing.", LOAD(m->frames_skipped));
+    emit_scalar(&fb, "chip8_audio_underruns_total", "counter", "Late audio callbacks.", LOAD(m->audio_underruns));
+    emit_scalar(&fb, "chip8_errors_total", "counter", "Failed CHIP-8 cycles (illegal instructions, stack errors).", LOAD(m->errors));
+    emit_scalar(&fb, "chip8_shadow_checks_total", "counter", "Core vs. reference interpreter state comparisons.", LOAD(m->shadow_checks));
+    emit_scalar(&fb, "chip8_shadow_divergences_total", "counter", "Comparisons where the core and reference disagreed.", LOAD(m->shadow_divergences));
+    emit(&fb, "# HELP chip8_idle_seconds_total Time spent sleeping between frames.\n"
+              "# TYPE chip8_idle_seconds_total counter\nchip8_idle_seconds_total %.3f\n", LOAD(m->idle_ms) / 1000.0);
+    emit(&fb, "# HELP chip8_uptime_seconds Time since the host started.\n"
+              "# TYPE chip8_uptime_seconds gauge\nchip8_uptime_seconds %.3f\n", (now_ns() - m->start_ns) / 1e9);
+    emit_scalar(&fb, "chip8_fps", "gauge", "Frames drawn during the last second.", LOAD(m->fps));
+    emit_scalar(&fb, "chip8_cpf", "gauge", "Cycles executed during the last frame.", LOAD(m->cpf));
+    emit_scalar(&fb, "chip8_idle_percent", "gauge", "Percentage of the last second spent sleeping.", LOAD(m->idle_percent));
+    emit_hist(&fb, "chip8_cycles_per_frame", "CHIP-8 cycles executed per rendered frame.", &m->cycles_per_frame);
+    emit_hist(&fb, "chip8_vtick_lateness_ms", "How late each 60Hz tick was delivered.", &m->vtick_lateness_ms);
+    emit_hist(&fb, "chip8_runahead_us", "Time spent on run-ahead speculation per rendered frame.", &m->runahead_us);
+
+    return (fb.pos < len) ? fb.pos : (len ? len - 1 : 0);
+}
+
+// helper to answer one client: plain HTTP/1.0 if it sent a GET, otherwise just the raw text
+static void serve_client(struct metrics_server *srv, int cfd) {
+    char req[512];
+    bool http = false;
+    struct pollfd pfd = { .fd = cfd, .events = POLLIN };
+    if (poll(&pfd, 1, 100) > 0) {
+        ssize_t n = recv(cfd, req, sizeof req - 1, 0);
+        http = (n >= 4) && (memcmp(req, "GET ", 4) == 0);
+    }
+
+    char body[16384];
+    size_t blen = metrics_format(srv->m, body, sizeof body);
+    if (http) {
+        char hdr[160];
+        int hlen = snprintf(hdr, sizeof hdr,
+                "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n", blen);
+        send(cfd, hdr, hlen, MSG_NOSIGNAL);
+    }
+    send(cfd, body, blen, MSG_NOSIGNAL);
+}
+
+// server thread: accept connections until the listening socket is shut down
+static void *server_main(void *arg) {
+    struct metrics_server *srv = (struct metrics_server *)arg;
+    for (;;) {
+        int cfd = accept(srv->fd, NULL, NULL);
+        if (cfd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        serve_client(srv, cfd);
+        close(cfd);
+    }
+    return NULL;
+}
+
+struct metrics_server *metrics_serve(const char *path, const struct metrics *m) {
+    struct metrics_server *srv = calloc(1, sizeof *srv);
+    if (!srv) return NULL;
+    srv->m = m;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path) {
+        fprintf(stderr, "ERROR: metrics socket path too long: '%s'\n", path);
+        free(srv);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+    strcpy(srv->path, path);
+
+    if ((srv->fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        free(srv);
+        return NULL;
+    }
+    if (!sock8_remove_stale(path)) {
+        close(srv->fd);
+        free(srv);
+        return NULL;
+    }
+    if (bind(srv->fd, (struct sockaddr *)&addr, sizeof addr) != 0 || listen(srv->fd, 8) != 0) {
+        perror("bind/listen");
+        close(srv->fd);
+        free(srv);
+        return NULL;
+    }
+    if (pthread_create(&srv->thread, NULL, server_main, srv) != 0) {
+        fprintf(stderr, "ERROR: cannot start metrics thread\n");
+        close(srv->fd);
+        unlink(path);
+        free(srv);
+        return NULL;
+    }
+    return srv;
+}
+
+void metrics_stop(struct metrics_server *srv) {
+    if (!srv) return;
+    shutdown(srv->fd, SHUT_RDWR);   // wakes the thread out of accept()
+    pthread_join(srv->thread, NULL);
+    close(srv->fd);
+    unlink(srv->path);
+    free(srv);
+}
@@ -0,0 +1,88 @@
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// LIVE RUNTIME METRICS (PROMETHEUS TEXT FORMAT OVER A UNIX-DOMAIN SOCKET)
+//--------------------------------------------------------------
+//
+// A host owns one `struct metrics` block and bumps its fields with relaxed atomic adds
+// (no locks anywhere; hosts should batch per-cycle counts and publish them once per frame).
+// metrics_serve() starts a background thread that answers every connection on a local
+// socket with a snapshot in Prometheus text exposition format, e.g.:
+//
+//     curl --unix-socket /tmp/gui8.sock http://localhost/metrics
+//     socat - UNIX-CONNECT:/tmp/gui8.sock
+
+// histogram buckets are powers of two: bucket `i` counts values in [2^(i-1), 2^i - 1]
+// (so bucket 0 is exactly 0, bucket 1 is exactly 1, bucket 2 is 2..3, ...); the last one is +Inf
+#define METRICS_HIST_BUCKETS 22
+
+struct metrics_hist {
+    _Atomic uint64_t buckets[METRICS_HIST_BUCKETS];
+    _Atomic uint64_t sum;
+};
+
+struct metrics {
+    // counters
+    _Atomic uint64_t instructions;      // CHIP-8 instructions executed
+    _Atomic uint64_t frames_rendered;   // frames drawn
+    _Atomic uint64_t frames_skipped;    // frame intervals that went by without a frame being drawn
+    _Atomic uint64_t vticks;            // 60Hz timer ticks delivered to the VM
+    _Atomic uint64_t audio_underruns;   // audio callbacks that arrived too late to keep the stream gapless
+    _Atomic uint64_t idle_ms;           // time spent sleeping (waiting for the next frame)
+    _Atomic uint64_t errors;            // failed chip8_cycle() calls
+    _Atomic uint64_t shadow_checks;     // shadow-execution comparisons made (see shadow.h)...
+    _Atomic uint64_t shadow_divergences;// ...and the ones that found the core and reference disagreeing
+
+    // gauges (refreshed once per second by the host)
+    _Atomic uint64_t fps;
+    _Atomic uint64_t cpf;
+    _Atomic uint64_t idle_percent;
+
+    // distributions
+    struct metrics_hist cycles_per_frame;
+    struct metrics_hist vtick_lateness_ms;
+    struct metrics_hist runahead_us;    // cost of each frame's speculative run-ahead (snapshot + K frames)
+
+    // (set by metrics_init; used to report uptime)
+    uint64_t start_ns;
+};
+
+// opaque handle for a running metrics server thread
+struct metrics_server;
+
+// zero all counters and note the start time
+void metrics_init(struct metrics *m);
+
+// add `n` to a counter/gauge (relaxed; never blocks)
+static inline void metrics_add(_Atomic uint64_t *ctr, uint64_t n) {
+    atomic_fetch_add_explicit(ctr, n, memory_order_relaxed);
+}
+
+static inline void metrics_set(_Atomic uint64_t *gauge, uint64_t v) {
+    atomic_store_explicit(gauge, v, memory_order_relaxed);
+}
+
+// record one observation of `v` in histogram `h`
+static inline void metrics_observe(struct metrics_hist *h, uint64_t v) {
+    int i = v ? 64 - __builtin_clzll(v) : 0;
+    if (i >= METRICS_HIST_BUCKETS) i = METRICS_HIST_BUCKETS - 1;
+    atomic_fetch_add_explicit(&h->buckets[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, v, memory_order_relaxed);
+}
+
+// render a snapshot of `m` in Prometheus text format into `buf` (returns length, truncated to `len - 1`)
+size_t metrics_format(const struct metrics *m, char *buf, size_t len);
+
+// start serving `m` on Unix-domain socket `path` (replacing any stale socket file there)
+// (NULL on error, with a message on stderr)
+struct metrics_server *metrics_serve(const char *path, const struct metrics *m);
+
+// stop the server thread and remove its socket file (NULL is OK)
+void metrics_stop(struct metrics_server *srv);
+
+#endif
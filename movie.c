@@ -0,0 +1,377 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "movie.h"
+
+#define MOVIE_MAGIC "C8MOVIE2"
+#define HEADER_BYTES (8 + 2 * 4 + 8 + 1)
+
+// bytes per packed framebuffer row (8 pixels per byte) and per changed-rows mask
+#define ROW_BYTES (FB_COLS / 8)
+#define MASK_BYTES ((FB_ROWS + 7) / 8)
+
+// worst case for one encoded row: alternating nonzero/zero bytes make every byte its own run, and
+// each literal run costs a token plus the byte (so never more than 2 bytes per input byte)
+#define MAX_ROW_BYTES (2 * ROW_BYTES)
+
+// worst case for one encoded frame's header and image: flags + cycle count + mask + every row at its worst
+// (the inputs are written separately)
+#define MAX_VARINT_BYTES 10
+#define MAX_FRAME_BYTES (1 + MAX_VARINT_BYTES + MASK_BYTES + FB_ROWS * MAX_ROW_BYTES)
+
+// worst case for one encoded input: cycle delta + keys + vtick increment
+#define MAX_INPUT_BYTES (MAX_VARINT_BYTES + 2 + MAX_VARINT_BYTES)
+
+struct movie_writer {
+    FILE *fp;
+    uint8_t prev[FB_ROWS][ROW_BYTES];   // packed copy of the last frame written
+    uint64_t frames;
+    uint64_t cycle;                     // cycle count of the last frame written
+    uint64_t cpf;                       // cycles run during that frame
+    struct movie_input *inputs;         // inputs logged since (some may be for later frames)
+    int ninputs, max_inputs;
+    struct movie_input last;            // the latest input logged (what chip8_cycle gets now)
+    struct movie_input written;         // the latest input written out (the next one is coded against it)
+    bool failed;
+};
+
+struct movie_reader {
+    FILE *fp;
+    uint64_t rom_hash;
+    uint8_t quirks;
+    uint8_t prev[FB_ROWS][ROW_BYTES];   // packed copy of the last frame decoded
+    uint64_t frames;
+    uint64_t cycle;                     // cycle count of the last frame decoded
+    uint64_t cpf;
+    struct movie_input last;            // the latest input decoded
+    struct movie_input *inputs;         // the last frame's inputs
+    int max_inputs;
+    struct movie_input replay;          // what movie_replay_frame is feeding chip8_cycle
+};
+
+// little-endian (de)serialization helpers
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = (v >> (8 * i)) & 0xff;
+    return p + 8;
+}
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+// helper to read a varint from `fp` (false on a short/overlong one)
+static bool read_varint(FILE *fp, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(fp);
+        if (c == EOF) return false;
+        *v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+// helper to pack one framebuffer row (1 byte per pixel) into bits, leftmost pixel in the MSB
+static void pack_row(const uint8_t *src, uint8_t *dst) {
+    for (int b = 0; b < ROW_BYTES; ++b, src += 8) {
+        dst[b] = ((src[0] & 1) << 7) | ((src[1] & 1) << 6) | ((src[2] & 1) << 5) | ((src[3] & 1) << 4)
+               | ((src[4] & 1) << 3) | ((src[5] & 1) << 2) | ((src[6] & 1) << 1) | (src[7] & 1);
+    }
+}
+
+static void unpack_row(const uint8_t *src, uint8_t *dst) {
+    for (int b = 0; b < ROW_BYTES; ++b) {
+        for (int i = 0; i < 8; ++i) *dst++ = (src[b] >> (7 - i)) & 1;
+    }
+}
+
+// helper to run-length encode `n` bytes (mostly zeros, being XOR deltas); returns the end of the output
+static uint8_t *rle_encode(const uint8_t *src, int n, uint8_t *out) {
+    int i = 0;
+    while (i < n) {
+        int run = 0;
+        if (src[i] == 0) {
+            while (i + run < n && src[i + run] == 0 && run < 128) ++run;
+            *out++ = run - 1;
+        } else {
+            while (i + run < n && src[i + run] != 0 && run < 128) ++run;
+            *out++ = 0x80 | (run - 1);
+            memcpy(out, src + i, run);
+            out += run;
+        }
+        i += run;
+    }
+    return out;
+}
+
+// helper to decode exactly `n` run-length encoded bytes from `fp` (false on a corrupt/short stream)
+static bool rle_decode(FILE *fp, uint8_t *dst, int n) {
+    int i = 0;
+    while (i < n) {
+        int tok = fgetc(fp);
+        if (tok == EOF) return false;
+        int run = (tok & 0x7f) + 1;
+        if (i + run > n) return false;
+        if (tok & 0x80) {
+            if (fread(dst + i, 1, run, fp) != (size_t)run) return false;
+        } else {
+            memset(dst + i, 0, run);
+        }
+        i += run;
+    }
+    return true;
+}
+
+struct movie_writer *movie_create(const char *path, uint64_t rom_hash, uint8_t quirks) {
+    struct movie_writer *mw = calloc(1, sizeof *mw);
+    if (!mw) return NULL;
+    if ((mw->fp = fopen(path, "wb")) == NULL) {
+        free(mw);
+        return NULL;
+    }
+    setvbuf(mw->fp, NULL, _IOFBF, 64 * 1024); // (we write a handful of bytes per frame)
+
+    uint8_t hdr[HEADER_BYTES], *p = hdr;
+    memcpy(p, MOVIE_MAGIC, 8);
+    p = put_u16(p + 8, FB_COLS);
+    p = put_u16(p, FB_ROWS);
+    p = put_u16(p, 60);
+    p = put_u16(p, MOVIE_KEYFRAME_INTERVAL);
+    p = put_u64(p, rom_hash);
+    *p = quirks;
+    mw->failed = (fwrite(hdr, sizeof hdr, 1, mw->fp) != 1);
+    return mw;
+}
+
+void movie_input(struct movie_writer *mw, uint64_t cycle, uint16_t keys, size_t vtick) {
+    if (keys == mw->last.keys && vtick == mw->last.vtick) return;
+    if (cycle < mw->last.cycle || vtick < mw->last.vtick) {
+        mw->failed = true;  // (the log can't go back in time)
+        return;
+    }
+
+    // (a second change on the same cycle replaces the first: chip8_cycle only ever sees the last one)
+    if (!mw->ninputs || mw->inputs[mw->ninputs - 1].cycle != cycle) {
+        if (mw->ninputs == mw->max_inputs) {
+            int max = mw->max_inputs ? 2 * mw->max_inputs : 64;
+            struct movie_input *grown = realloc(mw->inputs, max * sizeof *grown);
+            if (!grown) {
+                mw->failed = true;
+                return;
+            }
+            mw->inputs = grown;
+            mw->max_inputs = max;
+        }
+        ++mw->ninputs;
+    }
+    mw->last = (struct movie_input){ .cycle = cycle, .keys = keys, .vtick = vtick };
+    mw->inputs[mw->ninputs - 1] = mw->last;
+}
+
+// helper to write out the first `n` logged inputs (coded against the ones written before them)
+static void write_inputs(struct movie_writer *mw, int n) {
+    uint8_t buf[MAX_INPUT_BYTES], *p = put_varint(buf, n);
+    if (fwrite(buf, p - buf, 1, mw->fp) != 1) mw->failed = true;
+    for (int i = 0; i < n; ++i) {
+        const struct movie_input *in = &mw->inputs[i];
+        int what = (in->keys != mw->written.keys ? MOVIE_IN_KEYS : 0) | (in->vtick != mw->written.vtick ? MOVIE_IN_VTICK : 0);
+        p = put_varint(buf, ((in->cycle - mw->written.cycle) << 2) | what);
+        if (what & MOVIE_IN_KEYS) p = put_u16(p, in->keys);
+        if (what & MOVIE_IN_VTICK) p = put_varint(p, in->vtick - mw->written.vtick);
+        if (fwrite(buf, p - buf, 1, mw->fp) != 1) mw->failed = true;
+        mw->written = *in;
+    }
+    mw->ninputs -= n;
+    memmove(mw->inputs, mw->inputs + n, mw->ninputs * sizeof *mw->inputs);
+}
+
+bool movie_write_frame(struct movie_writer *mw, uint64_t cycle, const uint8_t *fb, bool sound) {
+    uint8_t buf[MAX_FRAME_BYTES];
+    uint8_t *p = buf + 1;
+    uint8_t flags = sound ? MOVIE_F_SOUND : 0;
+    bool keyframe = (mw->frames % MOVIE_KEYFRAME_INTERVAL) == 0;
+
+    if (cycle < mw->cycle) mw->failed = true;
+    if (mw->failed) return false;
+    if (keyframe) flags |= MOVIE_F_KEYFRAME;
+    if (cycle - mw->cycle != mw->cpf) {
+        flags |= MOVIE_F_CYCLES;
+        mw->cpf = cycle - mw->cycle;
+        p = put_varint(p, mw->cpf);
+    }
+    mw->cycle = cycle;
+
+    // the inputs that took effect up to the end of this frame go with it
+    int n = 0;
+    while (n < mw->ninputs && mw->inputs[n].cycle <= cycle) ++n;
+    if (n) flags |= MOVIE_F_INPUT;
+
+    // XOR every row against the previous frame (or a blank screen, for keyframes) and
+    // emit the changed ones (after the inputs, which go out first)
+    uint8_t *mask = p;
+    uint8_t *rows = p + MASK_BYTES;
+    memset(mask, 0, MASK_BYTES);
+    for (int y = 0; y < FB_ROWS; ++y) {
+        uint8_t cur[ROW_BYTES], delta[ROW_BYTES];
+        uint8_t any = 0;
+        pack_row(fb + y * FB_COLS, cur);
+        for (int b = 0; b < ROW_BYTES; ++b) {
+            delta[b] = cur[b] ^ (keyframe ? 0 : mw->prev[y][b]);
+            any |= delta[b];
+        }
+        memcpy(mw->prev[y], cur, ROW_BYTES);
+        if (any) {
+            mask[y / 8] |= 1 << (y % 8);
+            rows = rle_encode(delta, ROW_BYTES, rows);
+        }
+    }
+    if (rows != p + MASK_BYTES) flags |= MOVIE_F_FB;
+
+    buf[0] = flags;
+    if (fwrite(buf, p - buf, 1, mw->fp) != 1) mw->failed = true;
+    if (n) write_inputs(mw, n);
+    if ((flags & MOVIE_F_FB) && fwrite(p, rows - p, 1, mw->fp) != 1) mw->failed = true;
+    mw->frames++;
+    return !mw->failed;
+}
+
+bool movie_finish(struct movie_writer *mw) {
+    if (!mw) return true;
+    bool ok = !mw->failed && (fputc(MOVIE_F_END, mw->fp) != EOF);
+    ok = (fclose(mw->fp) == 0) && ok;
+    free(mw->inputs);
+    free(mw);
+    return ok;
+}
+
+struct movie_reader *movie_open(const char *path) {
+    struct movie_reader *mr = calloc(1, sizeof *mr);
+    if (!mr) return NULL;
+    if ((mr->fp = fopen(path, "rb")) == NULL) {
+        free(mr);
+        return NULL;
+    }
+
+    uint8_t hdr[HEADER_BYTES];
+    if (fread(hdr, sizeof hdr, 1, mr->fp) != 1 || memcmp(hdr, MOVIE_MAGIC, 8) != 0
+            || get_u16(hdr + 8) != FB_COLS || get_u16(hdr + 10) != FB_ROWS) {
+        fclose(mr->fp);
+        free(mr);
+        return NULL;
+    }
+    mr->rom_hash = get_u64(hdr + 16);
+    mr->quirks = hdr[24];
+    return mr;
+}
+
+uint64_t movie_rom_hash(const struct movie_reader *mr) {
+    return mr->rom_hash;
+}
+
+uint8_t movie_quirks(const struct movie_reader *mr) {
+    return mr->quirks;
+}
+
+// helper to decode a frame's inputs into `mr->inputs` (false on a corrupt/short stream)
+static bool read_inputs(struct movie_reader *mr, uint64_t frame_cycle, int *count) {
+    uint64_t n;
+    if (!read_varint(mr->fp, &n) || n == 0 || n > frame_cycle - mr->last.cycle + 1) return false;
+    if ((int)n > mr->max_inputs) {
+        struct movie_input *grown = realloc(mr->inputs, n * sizeof *grown);
+        if (!grown) return false;
+        mr->inputs = grown;
+        mr->max_inputs = (int)n;
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t v, vticks;
+        uint8_t kb[2];
+        if (!read_varint(mr->fp, &v)) return false;
+        mr->last.cycle += v >> 2;
+        if (mr->last.cycle > frame_cycle) return false;
+        if (v & MOVIE_IN_KEYS) {
+            if (fread(kb, 2, 1, mr->fp) != 1) return false;
+            mr->last.keys = get_u16(kb);
+        }
+        if (v & MOVIE_IN_VTICK) {
+            if (!read_varint(mr->fp, &vticks)) return false;
+            mr->last.vtick += vticks;
+        }
+        mr->inputs[i] = mr->last;
+    }
+    *count = (int)n;
+    return true;
+}
+
+bool movie_read_frame(struct movie_reader *mr, struct movie_frame *out) {
+    int flags = fgetc(mr->fp);
+    if (flags == EOF || (flags & MOVIE_F_END)) return false;
+
+    if ((flags & MOVIE_F_CYCLES) && !read_varint(mr->fp, &mr->cpf)) return false;
+    mr->cycle += mr->cpf;
+    out->ninputs = 0;
+    if ((flags & MOVIE_F_INPUT) && !read_inputs(mr, mr->cycle, &out->ninputs)) return false;
+    if (flags & MOVIE_F_KEYFRAME) {
+        memset(mr->prev, 0, sizeof mr->prev);
+    }
+    if (flags & MOVIE_F_FB) {
+        uint8_t mask[MASK_BYTES];
+        if (fread(mask, MASK_BYTES, 1, mr->fp) != 1) return false;
+        for (int y = 0; y < FB_ROWS; ++y) {
+            if (!(mask[y / 8] & (1 << (y % 8)))) continue;
+            uint8_t delta[ROW_BYTES];
+            if (!rle_decode(mr->fp, delta, ROW_BYTES)) return false;
+            for (int b = 0; b < ROW_BYTES; ++b) mr->prev[y][b] ^= delta[b];
+        }
+    }
+
+    out->number = mr->frames++;
+    out->cycle = mr->cycle;
+    out->keys = mr->last.keys;
+    out->inputs = mr->inputs;
+    out->sound = (flags & MOVIE_F_SOUND) != 0;
+    out->keyframe = (flags & MOVIE_F_KEYFRAME) != 0;
+    for (int y = 0; y < FB_ROWS; ++y) unpack_row(mr->prev[y], out->fb[y]);
+    return true;
+}
+
+bool movie_replay_frame(struct movie_reader *mr, const struct movie_frame *fr, struct chip8_vm *vm, bool *sound) {
+    int i = 0;
+    while (chip8_get_cycles(vm) < fr->cycle) {
+        // (pick up every input taking effect on the cycle we are about to run)
+        while (i < fr->ninputs && fr->inputs[i].cycle <= chip8_get_cycles(vm)) mr->replay = fr->inputs[i++];
+        if (!chip8_cycle(vm, mr->replay.keys, mr->replay.vtick, sound)) return false;
+    }
+    // (inputs logged for the very cycle the frame ends on belong to the next frame's first cycle)
+    while (i < fr->ninputs) mr->replay = fr->inputs[i++];
+    return true;
+}
+
+void movie_close(struct movie_reader *mr) {
+    if (!mr) return;
+    fclose(mr->fp);
+    free(mr->inputs);
+    free(mr);
+}
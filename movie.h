@@ -0,0 +1,106 @@
+#ifndef _MOVIE_H
+#define _MOVIE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// GAMEPLAY MOVIES: CYCLE-STAMPED INPUT LOG + SOUND STATE + XOR-DELTA RLE FRAMEBUFFERS
+//--------------------------------------------------------------
+//
+// File layout (all integers little-endian; "varint" = LEB128, 7 bits per byte, low group first):
+//
+//     header  "C8MOVIE2", u16 cols, u16 rows, u16 fps, u16 keyframe_interval, u64 rom_hash, u8 quirks
+//     frame*  u8 flags
+//             [varint cycles]             if MOVIE_F_CYCLES (cycles run this frame changed)
+//             [varint count, inputs]      if MOVIE_F_INPUT (keypad state or vtick changed)
+//             [row mask, changed rows]    if MOVIE_F_FB (framebuffer changed)
+//     end     u8 MOVIE_F_END
+//
+// A movie starts from the ROM freshly loaded (chip8_load, then chip8_set_quirks(quirks)), with
+// no keys down and vtick 0.  Every change to what chip8_cycle is passed is logged with the
+// cycle it takes effect on (chip8_get_cycles() before that cycle runs), so a replay feeds each
+// cycle exactly what the recording did and ends every frame on the same cycle: see
+// movie_replay_frame().  An input is a varint ((cycles since the previous input) << 2 |
+// MOVIE_IN_KEYS if a u16 keypad state follows | MOVIE_IN_VTICK if a varint vtick increment
+// follows).  Frames end after the cycle count they carry; it is only stored when it differs
+// from the previous frame's.
+//
+// A framebuffer update is a bit mask of changed rows ((rows + 7) / 8 bytes), followed by
+// each changed row packed 8 pixels per byte, XORed with the previous frame's row, and
+// run-length encoded (token < 0x80: that many + 1 zero bytes; token >= 0x80: (token & 0x7f) + 1
+// literal bytes follow).  Keyframes (MOVIE_F_KEYFRAME) are XORed against a blank screen so
+// a reader can start decoding there.  A frame where nothing changed costs one byte.
+
+#define MOVIE_F_KEYFRAME 0x01   // framebuffer is coded against a blank screen
+#define MOVIE_F_SOUND    0x02   // the beeper is on at the end of this frame
+#define MOVIE_F_INPUT    0x04   // inputs taking effect during this frame follow
+#define MOVIE_F_FB       0x08   // a framebuffer update follows
+#define MOVIE_F_CYCLES   0x10   // a new cycles-per-frame count follows
+#define MOVIE_F_END      0x80   // end of movie
+
+#define MOVIE_IN_KEYS    0x01   // (input) a new keypad state follows
+#define MOVIE_IN_VTICK   0x02   // (input) a vtick increment follows
+
+// default distance between keyframes (5 seconds at 60 FPS)
+#define MOVIE_KEYFRAME_INTERVAL 300
+
+// one logged input: from cycle `cycle` on, chip8_cycle gets `keys` and `vtick`
+struct movie_input {
+    uint64_t cycle;
+    uint16_t keys;
+    size_t vtick;
+};
+
+// one decoded movie frame
+struct movie_frame {
+    uint64_t number;                // frame index (0 = first)
+    uint64_t cycle;                 // VM cycle count the frame was taken at
+    uint16_t keys;                  // keypad state at the end of the frame
+    bool sound;                     // beeper state
+    bool keyframe;
+    int ninputs;                    // inputs logged during the frame (cycles up to `cycle`)...
+    const struct movie_input *inputs; // ...in order (valid until the next movie_read_frame)
+    uint8_t fb[FB_ROWS][FB_COLS];   // framebuffer (0 or 1 per pixel)
+};
+
+// opaque writer/reader handles
+struct movie_writer;
+struct movie_reader;
+
+// start recording a run of the ROM with the given romdb_hash_rom() hash, under the given
+// CHIP8_QUIRK_* flags, to `path` (NULL on error)
+struct movie_writer *movie_create(const char *path, uint64_t rom_hash, uint8_t quirks);
+
+// log what chip8_cycle is passed from cycle `cycle` on (cheap to call before every cycle: only
+// changes are logged; `vtick` never goes backwards)
+void movie_input(struct movie_writer *mw, uint64_t cycle, uint16_t keys, size_t vtick);
+
+// append one frame taken at VM cycle count `cycle` (`fb` is FB_ROWS x FB_COLS bytes, as in
+// `struct chip8_vm`)
+bool movie_write_frame(struct movie_writer *mw, uint64_t cycle, const uint8_t *fb, bool sound);
+
+// finish the movie (writes the end marker; false if anything failed along the way) (NULL is OK)
+bool movie_finish(struct movie_writer *mw);
+
+// open a recorded movie (NULL on error or unsupported format)
+struct movie_reader *movie_open(const char *path);
+
+// the hash of the ROM the movie was recorded from, and the quirks it ran under
+uint64_t movie_rom_hash(const struct movie_reader *mr);
+uint8_t movie_quirks(const struct movie_reader *mr);
+
+// decode the next frame into `*out` (false at the end of the movie or on a corrupt file)
+bool movie_read_frame(struct movie_reader *mr, struct movie_frame *out);
+
+// run `vm` (loaded from the movie's ROM with its quirks, and replayed frame by frame from the
+// start) up to the end of frame `fr`, feeding every cycle its logged inputs; false if a cycle
+// fails (the VM stops there)
+bool movie_replay_frame(struct movie_reader *mr, const struct movie_frame *fr, struct chip8_vm *vm, bool *sound);
+
+// close a movie opened with movie_open (NULL is OK)
+void movie_close(struct movie_reader *mr);
+
+#endif
@@ -0,0 +1,202 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// we include the movie reader API here
+#include "movie.h"
+#include "romdb.h"  // (for checking a replay's ROM against the movie's)
+
+// Y4M luma levels for pixels off/on (video-range black and white)
+#define Y4M_BLACK 16
+#define Y4M_WHITE 235
+
+// largest integer upscale we allow for exported frames
+#define MAX_SCALE 32
+
+// helper to print a summary of a movie (frame count, cycles, size, data rate, key/sound activity)
+static bool movie_info(const char *path, struct movie_reader *mr) {
+    struct movie_frame fr;
+    uint64_t frames = 0, keyframes = 0, key_changes = 0, inputs = 0, sound_edges = 0, cycles = 0;
+    uint16_t keys = 0;
+    bool sound = false;
+
+    while (movie_read_frame(mr, &fr)) {
+        ++frames;
+        if (fr.keyframe) ++keyframes;
+        if (fr.keys != keys) ++key_changes;
+        inputs += fr.ninputs;
+        cycles = fr.cycle;
+        if (fr.sound != sound) ++sound_edges;
+        keys = fr.keys;
+        sound = fr.sound;
+    }
+
+    struct stat st;
+    double secs = frames / 60.0;
+    long long bytes = (stat(path, &st) == 0) ? (long long)st.st_size : -1;
+    printf("ROM hash:     %016llx\n", (unsigned long long)movie_rom_hash(mr));
+    printf("frames:       %llu (%.1f s, %llu keyframes)\n", (unsigned long long)frames, secs, (unsigned long long)keyframes);
+    printf("quirks:       0x%02x\n", movie_quirks(mr));
+    printf("cycles:       %llu\n", (unsigned long long)cycles);
+    printf("key changes:  %llu (between frames; %llu inputs logged)\n", (unsigned long long)key_changes, (unsigned long long)inputs);
+    printf("sound edges:  %llu\n", (unsigned long long)sound_edges);
+    printf("file size:    %lld bytes (%.1f bytes/s)\n", bytes, secs > 0 ? bytes / secs : 0.0);
+    return true;
+}
+
+// helper to write every frame as a binary PBM (P4) image named PREFIX-NNNNNN.pbm
+static bool movie_pbm(struct movie_reader *mr, const char *prefix, int scale) {
+    struct movie_frame fr;
+    int w = FB_COLS * scale, h = FB_ROWS * scale;
+    uint8_t row[(FB_COLS * MAX_SCALE + 7) / 8];
+
+    while (movie_read_frame(mr, &fr)) {
+        char name[1024];
+        snprintf(name, sizeof name, "%s-%06llu.pbm", prefix, (unsigned long long)fr.number);
+        FILE *fp = fopen(name, "wb");
+        if (!fp) {
+            fprintf(stderr, "ERROR: cannot create '%s'\n", name);
+            return false;
+        }
+        fprintf(fp, "P4\n%d %d\n", w, h);
+        for (int y = 0; y < h; ++y) {
+            memset(row, 0, sizeof row);
+            for (int x = 0; x < w; ++x) {
+                if (fr.fb[y / scale][x / scale]) row[x / 8] |= 0x80 >> (x % 8); // (PBM: 1 = black ink)
+            }
+            fwrite(row, (w + 7) / 8, 1, fp);
+        }
+        if (fclose(fp) != 0) return false;
+    }
+    return true;
+}
+
+// helper to write the whole movie as one monochrome YUV4MPEG2 stream (60 FPS)
+static bool movie_y4m(struct movie_reader *mr, const char *out, int scale) {
+    struct movie_frame fr;
+    int w = FB_COLS * scale, h = FB_ROWS * scale;
+    FILE *fp = strcmp(out, "-") ? fopen(out, "wb") : stdout;
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot create '%s'\n", out);
+        return false;
+    }
+    uint8_t *plane = malloc((size_t)w * h);
+    if (!plane) {
+        if (fp != stdout) fclose(fp);
+        return false;
+    }
+
+    fprintf(fp, "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 Cmono\n", w, h);
+    while (movie_read_frame(mr, &fr)) {
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                plane[y * w + x] = fr.fb[y / scale][x / scale] ? Y4M_WHITE : Y4M_BLACK;
+            }
+        }
+        fputs("FRAME\n", fp);
+        fwrite(plane, (size_t)w * h, 1, fp);
+    }
+    free(plane);
+    return (fp == stdout) ? (fflush(fp) == 0) : (fclose(fp) == 0);
+}
+
+// helper to rerun the movie's inputs on its ROM and check that every frame comes out exactly as recorded
+static bool movie_replay(struct movie_reader *mr, const char *rom_path) {
+    static struct chip8_vm vm;
+    static struct movie_frame fr;
+    uint8_t rom[RAM_SIZE];
+    uint64_t frames = 0;
+    bool sound = false;
+
+    FILE *fp = fopen(rom_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", rom_path);
+        return false;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, fp);
+    fclose(fp);
+    if (romdb_hash_rom(rom, romlen) != movie_rom_hash(mr)) {
+        fprintf(stderr, "ERROR: '%s' is not the ROM the movie was recorded from\n", rom_path);
+        return false;
+    }
+    if (!chip8_load(&vm, rom, romlen)) {
+        fprintf(stderr, "ERROR: cannot load '%s'\n", rom_path);
+        return false;
+    }
+    chip8_set_quirks(&vm, movie_quirks(mr));
+
+    while (movie_read_frame(mr, &fr)) {
+        if (!movie_replay_frame(mr, &fr, &vm, &sound)) {
+            fprintf(stderr, "ERROR: frame %llu: illegal instruction @ PC=0x%04x during the replay\n",
+                    (unsigned long long)fr.number, chip8_get_pc(&vm));
+            return false;
+        }
+        for (int y = 0; y < FB_ROWS; ++y) {
+            for (int x = 0; x < FB_COLS; ++x) {
+                if ((vm.fb[y][x] & 1) != fr.fb[y][x]) {
+                    fprintf(stderr, "ERROR: frame %llu (cycle %llu): replay differs at pixel (%d, %d)\n",
+                            (unsigned long long)fr.number, (unsigned long long)fr.cycle, x, y);
+                    return false;
+                }
+            }
+        }
+        if (sound != fr.sound) {
+            fprintf(stderr, "ERROR: frame %llu (cycle %llu): replay differs in the sound state\n",
+                    (unsigned long long)fr.number, (unsigned long long)fr.cycle);
+            return false;
+        }
+        ++frames;
+    }
+    printf("%llu frames (%llu cycles) replayed exactly\n", (unsigned long long)frames, (unsigned long long)chip8_get_cycles(&vm));
+    return true;
+}
+
+// entry point: decode a movie recorded by gui8 (or a headless runner) and summarize/export/replay it
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    struct movie_reader *mr = NULL;
+    int scale = 1;
+
+    if (argc < 3 || (strcmp(argv[1], "info") && argc < 4)) {
+        fprintf(stderr, "usage: %s info MOVIE\n"
+                        "       %s pbm MOVIE OUT_PREFIX [SCALE]\n"
+                        "       %s y4m MOVIE OUT.y4m|- [SCALE]\n"
+                        "       %s replay MOVIE ROM_FILE\n", argv[0], argv[0], argv[0], argv[0]);
+        goto cleanup;
+    }
+    if (argc > 4 && strcmp(argv[1], "replay")) {
+        scale = atoi(argv[4]);
+        if (scale < 1 || scale > MAX_SCALE) {
+            fprintf(stderr, "ERROR: SCALE must be between 1 and %d\n", MAX_SCALE);
+            goto cleanup;
+        }
+    }
+
+    if ((mr = movie_open(argv[2])) == NULL) {
+        fprintf(stderr, "ERROR: cannot open movie '%s'\n", argv[2]);
+        goto cleanup;
+    }
+
+    bool ok;
+    if (!strcmp(argv[1], "info")) {
+        ok = movie_info(argv[2], mr);
+    } else if (!strcmp(argv[1], "pbm")) {
+        ok = movie_pbm(mr, argv[3], scale);
+    } else if (!strcmp(argv[1], "y4m")) {
+        ok = movie_y4m(mr, argv[3], scale);
+    } else if (!strcmp(argv[1], "replay")) {
+        ok = movie_replay(mr, argv[3]);
+    } else {
+        fprintf(stderr, "ERROR: unknown command '%s'\n", argv[1]);
+        ok = false;
+    }
+    if (ok) ret = EXIT_SUCCESS;
+
+cleanup:
+    movie_close(mr);
+    return ret;
+}
@@ -0,0 +1,410 @@
+// some standard library/system headers
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "netplay.h"
+#include "arena8.h"
+
+#define DEFAULT_CPF 10
+#define DEFAULT_MAX_ROLLBACK 8
+
+// snapshots kept (state at the start of each of the last RING frames)
+#define RING (NETPLAY_MAX_ROLLBACK + 1)
+
+// inputs kept per side, by frame (a power of two comfortably past what either side can be
+// ahead of the other: 2 x (max rollback + max delay + 1) frames)
+#define INPUTS 128
+#define SLOT(f) ((f) & (INPUTS - 1))
+
+#define HEADER 22
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+struct netplay {
+    struct netplay_config cfg;
+    struct netplay_transport t;
+    uint64_t session;
+
+    struct chip8_vm vm;         // the state at the start of frame `frame`
+    uint32_t frame;             // next frame to simulate
+    struct arena8 *snaps;       // slot f % RING = the state at the start of frame f (for the last RING frames)
+    bool sound;
+
+    uint16_t local[INPUTS];     // our input by frame (known for frames < local_next)
+    uint32_t local_next;
+    uint16_t remote[INPUTS];    // the peer's input by frame (known for frames < remote_next)
+    uint32_t remote_next;
+    uint16_t used[INPUTS];      // the peer input each simulated frame actually ran with (known or predicted)
+    uint32_t peer_ack;          // our inputs for frames < peer_ack have reached the peer
+
+    struct netplay_stats stats;
+};
+
+// helper to return the (monotonic) time in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// helpers to store/fetch little-endian integers in a packet
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// helper to return the peer input frame `f` runs with: the real one if we have it, otherwise
+// a guess that the peer still holds whatever it held last
+static uint16_t remote_keys(const struct netplay *np, uint32_t f) {
+    if (f < np->remote_next) return np->remote[SLOT(f)];
+    return np->remote_next ? np->remote[SLOT(np->remote_next - 1)] : 0;
+}
+
+// helper to snapshot the VM and run frame `frame` (false if the VM hit an illegal instruction)
+static bool simulate(struct netplay *np) {
+    uint32_t f = np->frame;
+    uint64_t t0 = now_ns();
+    *(struct chip8_vm *)arena8_slot(np->snaps, f % RING) = np->vm;
+    np->stats.snapshot_ns += now_ns() - t0;
+    uint16_t peer = remote_keys(np, f);
+    np->used[SLOT(f)] = peer;
+    uint16_t keys = np->local[SLOT(f)] | peer;
+    for (int c = 0; c < np->cfg.cpf; ++c) {
+        if (!chip8_cycle(&np->vm, keys, f, &np->sound)) return false;
+    }
+    ++np->frame;
+    return true;
+}
+
+// helper to take in every pending packet; sets `*bad_frame` to the first already-simulated frame
+// that ran with a wrong guess of the peer's input, if any (false on a transport error)
+static bool receive(struct netplay *np, uint32_t *bad_frame) {
+    uint8_t buf[NETPLAY_MAX_PACKET + 1];
+    int n;
+    while ((n = np->t.recv(np->t.ctx, buf, sizeof buf)) != 0) {
+        if (n < 0) return false;
+        ++np->stats.received;
+
+        uint16_t count = (n >= HEADER) ? get16(buf + 20) : 0;
+        if (n < HEADER || memcmp(buf, "C8NP", 4) != 0 || n != HEADER + 2 * count || count > NETPLAY_WINDOW) {
+            ++np->stats.bad_packets;
+            continue;
+        }
+        uint64_t session = (uint64_t)get32(buf + 4) | ((uint64_t)get32(buf + 8) << 32);
+        if (session != np->session) {
+            ++np->stats.bad_packets;
+            continue;
+        }
+        uint32_t ack = get32(buf + 12), first = get32(buf + 16);
+        if (ack > np->peer_ack && ack <= np->local_next) np->peer_ack = ack;
+
+        // (inputs are only taken in order: anything after a gap comes again in a later packet)
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t f = first + i;
+            if (f < np->remote_next) continue;
+            if (f > np->remote_next) break;
+            uint16_t keys = get16(buf + HEADER + 2 * i);
+            np->remote[SLOT(f)] = keys;
+            ++np->remote_next;
+            if (f < np->frame && np->used[SLOT(f)] != keys && f < *bad_frame) *bad_frame = f;
+        }
+    }
+    return true;
+}
+
+// helper to send the peer every input of ours it hasn't acknowledged (and our own acknowledgment)
+static bool send_inputs(struct netplay *np) {
+    uint8_t buf[NETPLAY_MAX_PACKET];
+    uint32_t first = MAX(np->peer_ack, np->local_next - MIN(np->local_next, NETPLAY_WINDOW));
+    uint16_t count = (uint16_t)(np->local_next - first);
+    memcpy(buf, "C8NP", 4);
+    put32(buf + 4, (uint32_t)np->session);
+    put32(buf + 8, (uint32_t)(np->session >> 32));
+    put32(buf + 12, np->remote_next);
+    put32(buf + 16, first);
+    put16(buf + 20, count);
+    for (uint32_t i = 0; i < count; ++i) put16(buf + HEADER + 2 * i, np->local[SLOT(first + i)]);
+    ++np->stats.sent;
+    return np->t.send(np->t.ctx, buf, HEADER + 2 * count);
+}
+
+// helper to go back to the start of frame `from` and re-simulate up to where we were
+static bool roll_back(struct netplay *np, uint32_t from) {
+    uint64_t t0 = now_ns();
+    uint32_t to = np->frame;
+    np->vm = *(struct chip8_vm *)arena8_slot(np->snaps, from % RING);
+    np->frame = from;
+    while (np->frame < to) {
+        if (!simulate(np)) return false;
+    }
+
+    uint64_t ns = now_ns() - t0;
+    int depth = (int)(to - from);
+    ++np->stats.rollbacks;
+    np->stats.resim_frames += depth;
+    ++np->stats.depth_hist[MIN(depth, NETPLAY_MAX_ROLLBACK)];
+    np->stats.max_depth = MAX(np->stats.max_depth, depth);
+    np->stats.rollback_ns += ns;
+    np->stats.max_rollback_ns = MAX(np->stats.max_rollback_ns, ns);
+    return true;
+}
+
+struct netplay *netplay_create(const struct chip8_vm *vm, const struct netplay_transport *t,
+                               const struct netplay_config *cfg) {
+    struct netplay *np = calloc(1, sizeof *np);
+    if (!np) return NULL;
+    np->cfg = *cfg;
+    if (!np->cfg.cpf) np->cfg.cpf = DEFAULT_CPF;
+    if (!np->cfg.max_rollback) np->cfg.max_rollback = DEFAULT_MAX_ROLLBACK;
+    if (np->cfg.cpf < 0 || np->cfg.max_rollback < 1 || np->cfg.max_rollback > NETPLAY_MAX_ROLLBACK
+        || np->cfg.input_delay < 0 || np->cfg.input_delay > NETPLAY_MAX_DELAY) {
+        free(np);
+        return NULL;
+    }
+    if ((np->snaps = arena8_create(0, RING, ARENA8_PREFAULT)) == NULL) {
+        free(np);
+        return NULL;
+    }
+    np->t = *t;
+    np->vm = *vm;
+    np->session = chip8_state_hash(vm);
+
+    // (the first `input_delay` frames run with no local keys down)
+    np->local_next = (uint32_t)np->cfg.input_delay;
+    return np;
+}
+
+int netplay_frame(struct netplay *np, uint16_t keys, bool *sound) {
+    // take in the peer's input, and fix up any frames we guessed wrong
+    uint32_t bad_frame = UINT32_MAX;
+    if (!receive(np, &bad_frame)) return -1;
+    if (bad_frame < np->frame && !roll_back(np, bad_frame)) return -1;
+
+    // run the next frame, unless that would mean guessing further ahead than we could roll back
+    int ret = 0;
+    bool ahead = np->frame >= np->remote_next + (uint32_t)np->cfg.max_rollback;
+    if (ahead) {
+        ++np->stats.stalls;
+    } else {
+        np->local[SLOT(np->local_next)] = keys;
+        ++np->local_next;
+    }
+    if (!send_inputs(np)) return -1;
+    if (!ahead) {
+        if (!simulate(np)) return -1;
+        ++np->stats.frames;
+        ret = 1;
+    }
+    np->stats.lead = (np->frame > np->remote_next) ? (int)(np->frame - np->remote_next) : 0;
+    *sound = np->sound;
+    return ret;
+}
+
+const struct chip8_vm *netplay_vm(const struct netplay *np) {
+    return &np->vm;
+}
+
+uint32_t netplay_confirmed(const struct netplay *np, uint64_t *state_hash) {
+    uint32_t f = MIN(np->remote_next, np->frame);
+    const struct chip8_vm *vm = (f == np->frame) ? &np->vm : arena8_slot(np->snaps, f % RING);
+    *state_hash = chip8_state_hash(vm);
+    return f;
+}
+
+const struct netplay_stats *netplay_stats(const struct netplay *np) {
+    return &np->stats;
+}
+
+void netplay_destroy(struct netplay *np) {
+    if (!np) return;
+    if (np->t.close) np->t.close(np->t.ctx);
+    arena8_destroy(np->snaps);
+    free(np);
+}
+
+
+// UDP TRANSPORT
+//--------------------------------------------------------------
+
+// (ctx is the socket descriptor, boxed)
+static bool udp_send(void *ctx, const void *buf, size_t len) {
+    if (send(*(int *)ctx, buf, len, 0) >= 0) return true;
+    // (a full socket buffer or a peer that isn't up yet just loses the datagram)
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED || errno == EINTR;
+}
+
+static int udp_recv(void *ctx, void *buf, size_t cap) {
+    for (;;) {
+        ssize_t n = recv(*(int *)ctx, buf, cap, 0);
+        if (n > 0) return (int)n;
+        if (n == 0) continue;   // (an empty datagram is nobody's packet)
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        if (errno != ECONNREFUSED && errno != EINTR) return -1;
+    }
+}
+
+static void udp_close(void *ctx) {
+    close(*(int *)ctx);
+    free(ctx);
+}
+
+bool netplay_udp_open(struct netplay_transport *t, const char *local_port, const char *peer_host, const char *peer_port) {
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM }, *peer = NULL;
+    int fd = -1, *box = NULL;
+    int err = getaddrinfo(peer_host, peer_port, &hints, &peer);
+    if (err != 0) {
+        fprintf(stderr, "ERROR: cannot resolve '%s:%s': %s\n", peer_host, peer_port, gai_strerror(err));
+        return false;
+    }
+
+    // bind the local port in the peer's address family, and only accept datagrams from the peer
+    struct addrinfo lhints = { .ai_family = peer->ai_family, .ai_socktype = SOCK_DGRAM, .ai_flags = AI_PASSIVE }, *local = NULL;
+    if ((err = getaddrinfo(NULL, local_port, &lhints, &local)) != 0) {
+        fprintf(stderr, "ERROR: bad local port '%s': %s\n", local_port, gai_strerror(err));
+        goto fail;
+    }
+    if ((fd = socket(peer->ai_family, SOCK_DGRAM, 0)) < 0 || bind(fd, local->ai_addr, local->ai_addrlen) != 0
+        || connect(fd, peer->ai_addr, peer->ai_addrlen) != 0 || fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+        fprintf(stderr, "ERROR: cannot set up UDP port %s for '%s:%s': %s\n", local_port, peer_host, peer_port, strerror(errno));
+        goto fail;
+    }
+    if ((box = malloc(sizeof *box)) == NULL) goto fail;
+    *box = fd;
+    *t = (struct netplay_transport){ .ctx = box, .send = udp_send, .recv = udp_recv, .close = udp_close };
+    freeaddrinfo(peer);
+    freeaddrinfo(local);
+    return true;
+
+fail:
+    if (fd >= 0) close(fd);
+    freeaddrinfo(peer);
+    if (local) freeaddrinfo(local);
+    return false;
+}
+
+
+// LOOPBACK TRANSPORT
+//--------------------------------------------------------------
+
+struct lb_packet {
+    uint64_t due;               // tick it arrives at
+    uint16_t len;
+    uint8_t data[NETPLAY_MAX_PACKET];
+};
+
+// one direction's datagrams in flight
+struct lb_queue {
+    struct lb_packet *packets;
+    size_t n, cap;
+};
+
+struct lb_end {
+    struct netplay_loopback *lb;
+    int side;                   // (receives from queue `side`, sends into the other one)
+};
+
+struct netplay_loopback {
+    int latency, jitter, loss_pct;
+    uint64_t rng;
+    uint64_t now;
+    struct lb_queue queues[2];
+    struct lb_end ends[2];
+};
+
+// helper to draw from the loopback's RNG (xorshift64*)
+static uint32_t lb_random(struct netplay_loopback *lb) {
+    lb->rng ^= lb->rng >> 12;
+    lb->rng ^= lb->rng << 25;
+    lb->rng ^= lb->rng >> 27;
+    return (uint32_t)((lb->rng * 0x2545f4914f6cdd1dull) >> 32);
+}
+
+static bool lb_send(void *ctx, const void *buf, size_t len) {
+    struct lb_end *end = (struct lb_end *)ctx;
+    struct netplay_loopback *lb = end->lb;
+    struct lb_queue *q = &lb->queues[!end->side];
+    if (len > NETPLAY_MAX_PACKET) return false;
+    if ((int)(lb_random(lb) % 100) < lb->loss_pct) return true;
+    if (q->n == q->cap) {
+        size_t cap = q->cap ? 2 * q->cap : 64;
+        struct lb_packet *p = realloc(q->packets, cap * sizeof *p);
+        if (!p) return false;
+        q->packets = p;
+        q->cap = cap;
+    }
+    struct lb_packet *p = &q->packets[q->n++];
+    p->due = lb->now + lb->latency + (lb->jitter ? lb_random(lb) % (lb->jitter + 1) : 0);
+    p->len = (uint16_t)len;
+    memcpy(p->data, buf, len);
+    return true;
+}
+
+static int lb_recv(void *ctx, void *buf, size_t cap) {
+    struct lb_end *end = (struct lb_end *)ctx;
+    struct lb_queue *q = &end->lb->queues[end->side];
+
+    // the earliest datagram that has arrived (earliest sent, among those due at the same tick)
+    size_t best = q->n;
+    for (size_t i = 0; i < q->n; ++i) {
+        if (q->packets[i].due <= end->lb->now && (best == q->n || q->packets[i].due < q->packets[best].due)) best = i;
+    }
+    if (best == q->n) return 0;
+    int len = q->packets[best].len;
+    memcpy(buf, q->packets[best].data, MIN((size_t)len, cap));
+    memmove(&q->packets[best], &q->packets[best + 1], (q->n - best - 1) * sizeof q->packets[0]);
+    --q->n;
+    return len;
+}
+
+static void lb_close(void *ctx) {
+    (void)ctx;
+}
+
+struct netplay_loopback *netplay_loopback_create(int latency, int jitter, int loss_pct, uint64_t seed) {
+    if (latency < 0 || jitter < 0 || loss_pct < 0 || loss_pct > 100) return NULL;
+    struct netplay_loopback *lb = calloc(1, sizeof *lb);
+    if (!lb) return NULL;
+    lb->latency = latency;
+    lb->jitter = jitter;
+    lb->loss_pct = loss_pct;
+    lb->rng = seed ? seed : 1;
+    for (int side = 0; side < 2; ++side) lb->ends[side] = (struct lb_end){ .lb = lb, .side = side };
+    return lb;
+}
+
+void netplay_loopback_ends(struct netplay_loopback *lb, struct netplay_transport *a, struct netplay_transport *b) {
+    *a = (struct netplay_transport){ .ctx = &lb->ends[0], .send = lb_send, .recv = lb_recv, .close = lb_close };
+    *b = (struct netplay_transport){ .ctx = &lb->ends[1], .send = lb_send, .recv = lb_recv, .close = lb_close };
+}
+
+void netplay_loopback_tick(struct netplay_loopback *lb) {
+    ++lb->now;
+}
+
+void netplay_loopback_destroy(struct netplay_loopback *lb) {
+    if (!lb) return;
+    free(lb->queues[0].packets);
+    free(lb->queues[1].packets);
+    free(lb);
+}
@@ -0,0 +1,114 @@
+#ifndef _NETPLAY_H
+#define _NETPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// ROLLBACK NETPLAY FOR TWO-PLAYER ROMS
+//--------------------------------------------------------------
+//
+// Both peers run the same ROM in lockstep frames (`cpf` cycles each, vtick = frame number),
+// and every frame runs with the keypad state local keys | remote keys.  Local input is sent
+// right away; the remote input for a frame is *predicted* (the peer is assumed to still hold
+// what it held last) so the game never waits for the network.  When the peer's real input
+// for an already-simulated frame turns out different, the session restores its snapshot of
+// that frame and re-simulates up to the present within the same call, so a late input
+// costs a few frames of emulation, not a visible stall.
+//
+// A VM is one flat struct, so a snapshot is a struct copy (one per frame, kept for the last
+// `max_rollback` frames).  A peer that falls more than `max_rollback` frames behind makes
+// the other side stall (skip frames) until it catches up.
+//
+// Packets (all integers little-endian):
+//
+//     "C8NP", u64 session (chip8_state_hash of the start state), u32 ack (next frame we need),
+//     u32 first (frame of the first input), u16 count, u16 keys[count]
+//
+// Each packet repeats every input the peer hasn't acknowledged yet (up to NETPLAY_WINDOW
+// of them), so lost or reordered datagrams heal themselves with the next one that arrives.
+
+#define NETPLAY_MAX_ROLLBACK 15     // most frames a session may predict (and re-simulate)
+#define NETPLAY_MAX_DELAY 8         // most frames of input delay
+#define NETPLAY_WINDOW 64           // most inputs per packet (and frames of input kept)
+#define NETPLAY_MAX_PACKET (22 + 2 * NETPLAY_WINDOW)
+
+// a datagram transport (UDP, or the in-process loopback below)
+struct netplay_transport {
+    void *ctx;
+    bool (*send)(void *ctx, const void *buf, size_t len);   // false on a hard error (a lost datagram is not one)
+    int (*recv)(void *ctx, void *buf, size_t cap);          // bytes received (0 = nothing pending, -1 = error)
+    void (*close)(void *ctx);
+};
+
+struct netplay_config {
+    int cpf;                    // cycles per frame (0 = 10)
+    int max_rollback;           // frames of prediction allowed before stalling (0 = 8, at most NETPLAY_MAX_ROLLBACK)
+    int input_delay;            // frames local input is held back (at most NETPLAY_MAX_DELAY; trades latency for fewer rollbacks)
+};
+
+struct netplay_stats {
+    uint64_t frames;            // frames simulated (the first time)
+    uint64_t stalls;            // calls that had to wait for the peer
+    uint64_t rollbacks;         // mispredictions that forced a rollback...
+    uint64_t resim_frames;      // ...and the frames they re-simulated
+    uint32_t depth_hist[NETPLAY_MAX_ROLLBACK + 1];  // rollbacks by depth (frames re-simulated)
+    int max_depth;
+    uint64_t rollback_ns;       // time spent restoring and re-simulating (total and worst single rollback)
+    uint64_t max_rollback_ns;
+    uint64_t snapshot_ns;       // time spent taking snapshots (re-simulated frames included)
+    uint64_t sent, received, bad_packets;
+    int lead;                   // frames simulated past the last confirmed one (i.e., predicted)
+};
+
+struct netplay;
+
+// start a session running `vm`'s current state (e.g., right after chip8_load) over `t`
+// (which the session then owns); both peers must start from the same state and config
+// (NULL on error, in which case the transport is still the caller's to close)
+struct netplay *netplay_create(const struct chip8_vm *vm, const struct netplay_transport *t,
+                               const struct netplay_config *cfg);
+
+// advance by one frame with the local keypad state `keys` (call once per 60Hz tick, even while stalled);
+// returns 1 if a frame was run (`*sound` = the beeper state after it), 0 if it had to wait for
+// the peer, or -1 on error (transport failure, or the VM hit an illegal instruction)
+int netplay_frame(struct netplay *np, uint16_t keys, bool *sound);
+
+// the VM as of the latest frame (predicted, so it may still be rolled back)
+const struct chip8_vm *netplay_vm(const struct netplay *np);
+
+// the newest frame whose state is final (every input before it is known on both sides), and the
+// chip8_state_hash of the state at its start (both peers must agree on it, so it doubles as a desync check)
+uint32_t netplay_confirmed(const struct netplay *np, uint64_t *state_hash);
+
+const struct netplay_stats *netplay_stats(const struct netplay *np);
+
+// close the session and its transport (NULL is OK)
+void netplay_destroy(struct netplay *np);
+
+// open a UDP transport bound to `local_port` that talks to `peer_host`:`peer_port` (false on error, with a message)
+bool netplay_udp_open(struct netplay_transport *t, const char *local_port, const char *peer_host, const char *peer_port);
+
+// IN-PROCESS LOOPBACK WITH SIMULATED LATENCY
+//--------------------------------------------------------------
+//
+// Two connected ends; a datagram sent at tick T shows up at the other end at tick
+// T + latency + (0..jitter) (so it may overtake earlier ones), or never (`loss_pct`
+// percent of them, picked by a seeded RNG so runs are reproducible).  The caller
+// advances the clock, normally once per frame.
+
+struct netplay_loopback;
+
+// (NULL on error)
+struct netplay_loopback *netplay_loopback_create(int latency, int jitter, int loss_pct, uint64_t seed);
+
+// the two ends (each transport's `close` is a no-op; destroy the loopback itself after both sessions)
+void netplay_loopback_ends(struct netplay_loopback *lb, struct netplay_transport *a, struct netplay_transport *b);
+
+void netplay_loopback_tick(struct netplay_loopback *lb);
+
+void netplay_loopback_destroy(struct netplay_loopback *lb);
+
+#endif
@@ -0,0 +1,229 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// we include the rollback netplay session (and the ROM database for per-title quirks/speed) here
+#include "netplay.h"
+#include "romdb.h"
+
+// ROLLBACK NETPLAY LOOPBACK TEST
+//--------------------------------------------------------------
+//
+// Runs both peers of a netplay session in one process, connected by the loopback transport
+// with simulated latency, jitter and packet loss, each side pressing random keys from its own
+// half of the keypad (player 1: 0-7, player 2: 8-F) and holding them for random stretches.
+// Every time a side confirms a frame, the state hash it reports must match a plain,
+// non-networked run of the same ROM with both players' inputs; any mismatch (a desync) fails
+// the run.  Rollback depth/cost and traffic are reported for both sides.
+
+// makefile-overridable path of the per-ROM settings database (can also be set with the env var GUI8_ROMDB)
+#ifndef NETPLAY8_ROMDB
+#define NETPLAY8_ROMDB "chip8.romdb"
+#endif
+
+// longest a random key press is held (frames)
+#define MAX_HOLD 30
+
+// (frames past the end of the scripts the sessions may get to before both have confirmed it)
+#define SLACK (2 * (NETPLAY_MAX_ROLLBACK + NETPLAY_MAX_DELAY + 1))
+
+// helper to draw from a seeded xorshift64* generator
+static uint32_t next_random(uint64_t *s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return (uint32_t)((*s * 0x2545f4914f6cdd1dull) >> 32);
+}
+
+// helper to print one side's statistics
+static void print_stats(const char *name, const struct netplay_stats *st) {
+    printf("%s: %llu frames, %llu stalls, %llu rollbacks (%llu frames re-simulated, deepest %d)\n", name,
+           (unsigned long long)st->frames, (unsigned long long)st->stalls, (unsigned long long)st->rollbacks,
+           (unsigned long long)st->resim_frames, st->max_depth);
+    printf("%*s  rollback cost %.2f us avg, %.2f us worst; snapshots %.0f ns/frame; packets %llu sent, %llu received, %llu bad\n",
+           (int)strlen(name), "", st->rollbacks ? st->rollback_ns / 1e3 / st->rollbacks : 0., st->max_rollback_ns / 1e3,
+           (double)st->snapshot_ns / (st->frames + st->resim_frames), (unsigned long long)st->sent,
+           (unsigned long long)st->received, (unsigned long long)st->bad_packets);
+    printf("%*s  rollback depth histogram:", (int)strlen(name), "");
+    for (int d = 1; d <= NETPLAY_MAX_ROLLBACK; ++d) {
+        if (st->depth_hist[d]) printf(" %d:%u", d, st->depth_hist[d]);
+    }
+    printf("\n");
+}
+
+// entry point: run a loopback session against a reference run and report
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    FILE *romfile = NULL;
+    struct romdb *romdb = NULL;
+    struct netplay_loopback *lb = NULL;
+    struct netplay *np[2] = { NULL, NULL };
+    uint16_t *script[2] = { NULL, NULL };
+    uint64_t *ref_hash = NULL;
+    uint8_t rom[RAM_SIZE];
+    struct chip8_vm start, ref;
+    struct netplay_config cfg = { 0 };
+    int frames = 3600, latency = 4, jitter = 2, loss_pct = 5;
+    uint64_t seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:r:d:l:j:p:s:")) != -1) {
+        switch (opt) {
+        case 'n': frames = atoi(optarg); break;
+        case 'c': cfg.cpf = atoi(optarg); break;
+        case 'r': cfg.max_rollback = atoi(optarg); break;
+        case 'd': cfg.input_delay = atoi(optarg); break;
+        case 'l': latency = atoi(optarg); break;
+        case 'j': jitter = atoi(optarg); break;
+        case 'p': loss_pct = atoi(optarg); break;
+        case 's': seed = strtoull(optarg, NULL, 0); break;
+        default: goto usage;
+        }
+    }
+    if (optind != argc - 1 || frames < 1) {
+usage:
+        fprintf(stderr, "usage: %s [-n FRAMES] [-c CPF] [-r ROLLBACK] [-d DELAY] [-l LATENCY] [-j JITTER] [-p LOSS%%] [-s SEED] ROM_FILE\n"
+                        "  -n  frames of input to play (default: 3600)\n"
+                        "  -c  cycles per frame (default: from the ROM database, else 10)\n"
+                        "  -r  most frames predicted before a side stalls (default: 8, at most %d)\n"
+                        "  -d  frames of input delay (default: 0, at most %d)\n"
+                        "  -l  one-way latency in frames (default: 4)\n"
+                        "  -j  extra random latency, up to this many frames (default: 2)\n"
+                        "  -p  percentage of packets lost (default: 5)\n"
+                        "  -s  seed for the inputs and the simulated network (default: 1)\n",
+                        argv[0], NETPLAY_MAX_ROLLBACK, NETPLAY_MAX_DELAY);
+        goto cleanup;
+    }
+
+    // load the ROM (with its quirks/speed from the database, unless given on the command line)
+    if ((romfile = fopen(argv[optind], "rb")) == NULL) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", argv[optind]);
+        goto cleanup;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, romfile);
+    if (!chip8_load(&start, rom, romlen)) {
+        fprintf(stderr, "ERROR: cannot load program\n");
+        goto cleanup;
+    }
+    const char *romdb_path = getenv("GUI8_ROMDB");
+    if ((romdb = romdb_open(romdb_path ? romdb_path : NETPLAY8_ROMDB)) != NULL) {
+        const struct romdb_entry *rome = romdb_lookup(romdb, romdb_hash_rom(rom, romlen));
+        if (rome) {
+            chip8_set_quirks(&start, rome->quirks);
+            if (!cfg.cpf) cfg.cpf = rome->cpf;
+        }
+    }
+    if (!cfg.cpf) cfg.cpf = 10;
+
+    // both players' key scripts (by the frame each side is on when it presses them; nothing
+    // pressed past the end), then the reference run: the state hash at the start of every frame
+    size_t len = (size_t)frames + SLACK;
+    script[0] = calloc(len, sizeof script[0][0]);
+    script[1] = calloc(len, sizeof script[1][0]);
+    ref_hash = malloc(len * sizeof ref_hash[0]);
+    if (!script[0] || !script[1] || !ref_hash) {
+        fprintf(stderr, "ERROR: out of memory\n");
+        goto cleanup;
+    }
+    uint64_t rng = seed ? seed : 1;
+    for (int side = 0; side < 2; ++side) {
+        for (int f = 0; f < frames;) {
+            int hold = 1 + next_random(&rng) % MAX_HOLD;
+            uint16_t keys = (next_random(&rng) % 3) ? (uint16_t)(1 << (8 * side + next_random(&rng) % 8)) : 0;
+            for (; hold && f < frames; --hold) script[side][f++] = keys;
+        }
+    }
+    ref = start;
+    for (size_t f = 0; f < len; ++f) {
+        bool sound;
+        uint16_t keys = (f < (size_t)cfg.input_delay) ? 0 : script[0][f - cfg.input_delay] | script[1][f - cfg.input_delay];
+        ref_hash[f] = chip8_state_hash(&ref);
+        for (int c = 0; c < cfg.cpf; ++c) {
+            if (!chip8_cycle(&ref, keys, f, &sound)) {
+                fprintf(stderr, "ERROR: the ROM hit an illegal instruction at frame %zu\n", f);
+                goto cleanup;
+            }
+        }
+    }
+
+    // two sessions over one simulated network
+    struct netplay_transport ends[2];
+    if ((lb = netplay_loopback_create(latency, jitter, loss_pct, seed)) == NULL) {
+        fprintf(stderr, "ERROR: bad network settings\n");
+        goto cleanup;
+    }
+    netplay_loopback_ends(lb, &ends[0], &ends[1]);
+    for (int side = 0; side < 2; ++side) {
+        if ((np[side] = netplay_create(&start, &ends[side], &cfg)) == NULL) {
+            fprintf(stderr, "ERROR: bad netplay settings\n");
+            goto cleanup;
+        }
+    }
+
+    // play until both sides have confirmed every scripted frame, checking every confirmation on the way
+    size_t played[2] = { 0, 0 };
+    int64_t confirmed[2] = { -1, -1 };   // (newest confirmed frame checked, per side)
+    uint64_t checks = 0, ticks = 0;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (confirmed[0] < frames || confirmed[1] < frames) {
+        for (int side = 0; side < 2; ++side) {
+            bool sound;
+            uint16_t keys = (played[side] < len) ? script[side][played[side]] : 0;
+            int r = netplay_frame(np[side], keys, &sound);
+            if (r < 0) {
+                fprintf(stderr, "ERROR: player %d's session failed at frame %zu\n", side + 1, played[side]);
+                goto cleanup;
+            }
+            played[side] += r;
+
+            uint64_t hash;
+            uint32_t c = netplay_confirmed(np[side], &hash);
+            if (c >= len) {
+                fprintf(stderr, "ERROR: player %d got %u frames ahead of the reference run\n", side + 1, c);
+                goto cleanup;
+            }
+            if (c != confirmed[side]) {
+                if (hash != ref_hash[c]) {
+                    fprintf(stderr, "ERROR: player %d desynced: state at confirmed frame %u doesn't match the reference\n",
+                            side + 1, c);
+                    goto cleanup;
+                }
+                ++checks;
+                confirmed[side] = c;
+            }
+        }
+        netplay_loopback_tick(lb);
+        if (++ticks > 100 * len) {
+            fprintf(stderr, "ERROR: the session stopped making progress (confirmed frames %lld and %lld)\n",
+                    (long long)confirmed[0], (long long)confirmed[1]);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("%d frames over a link with %d+%d frames of latency and %d%% loss (rollback %d, delay %d, %d cycles/frame)\n",
+           frames, latency, jitter, loss_pct, cfg.max_rollback ? cfg.max_rollback : 8, cfg.input_delay, cfg.cpf);
+    print_stats("player 1", netplay_stats(np[0]));
+    print_stats("player 2", netplay_stats(np[1]));
+    printf("OK: %llu confirmed states matched the reference run (%llu ticks in %.3f s, %.1f us per tick for both sides)\n",
+           (unsigned long long)checks, (unsigned long long)ticks, secs, secs * 1e6 / ticks);
+
+    ret = EXIT_SUCCESS;
+cleanup:
+    netplay_destroy(np[0]);
+    netplay_destroy(np[1]);
+    netplay_loopback_destroy(lb);
+    free(script[0]);
+    free(script[1]);
+    free(ref_hash);
+    romdb_close(romdb);
+    if (romfile) fclose(romfile);
+    return ret;
+}
@@ -0,0 +1,136 @@
+// some standard library headers
+#include <string.h>
+
+#include "ref8.h"
+
+#define ADDR(a) ((a) & 0x0FFF)
+
+void ref8_from_vm(struct ref8 *r, const struct chip8_vm *vm) {
+    memcpy(r->ram, vm->ram, sizeof r->ram);
+    memcpy(r->V, vm->V, sizeof r->V);
+    memcpy(r->stack, vm->stack, sizeof r->stack);
+    r->pc = vm->pc;
+    r->I = vm->I;
+    r->sp = vm->sp;
+    r->delay_timer = vm->delay_timer;
+    r->sound_timer = vm->sound_timer;
+    r->rng = vm->rng;
+    r->quirks = vm->quirks;
+    r->cycles = vm->cycles;
+    memcpy(r->fb, vm->fb, sizeof r->fb);
+}
+
+// helper to draw 8 random bits (xorshift64*, high byte of the product)
+static uint8_t next_random(struct ref8 *r) {
+    r->rng ^= r->rng >> 12;
+    r->rng ^= r->rng << 25;
+    r->rng ^= r->rng >> 27;
+    return (uint8_t)((r->rng * 0x2545f4914f6cdd1dull) >> 56);
+}
+
+// helper for the 8XYN arithmetic/logic group (false for the subcodes the core rejects)
+static bool alu(struct ref8 *r, int n, int x, int y) {
+    uint8_t *V = r->V;
+    switch (n) {
+    case 0x0: V[x] = V[y]; V[0xF] = 0; return true;
+    case 0x1: V[x] |= V[y]; if (r->quirks & CHIP8_QUIRK_VF_RESET) V[0xF] = 0; return true;
+    case 0x2: V[x] &= V[y]; if (r->quirks & CHIP8_QUIRK_VF_RESET) V[0xF] = 0; return true;
+    case 0x3: V[x] ^= V[y]; if (r->quirks & CHIP8_QUIRK_VF_RESET) V[0xF] = 0; return true;
+    case 0x4: {
+        // (flag first, then the sum, which sees the new VF when X or Y is F)
+        V[0xF] = V[x] + V[y] > 0xFF;
+        V[x] = V[x] + V[y];
+        return true;
+    }
+    case 0x5: V[0xF] = V[x] > V[y]; V[x] -= V[y]; return true;
+    case 0x6: {
+        // (VX = VY shifted; the flag goes in last, so 8FY6/8FYE leave the shifted-out bit in VF)
+        uint8_t bit = V[y] & 1;
+        V[x] = V[y] >> 1;
+        V[0xF] = bit;
+        return true;
+    }
+    case 0x7: V[0xF] = V[y] > V[x]; V[x] = V[y] - V[x]; return true;
+    case 0xE: {
+        uint8_t bit = V[y] >> 7;
+        V[x] = (uint8_t)(V[y] << 1);
+        V[0xF] = bit;
+        return true;
+    }
+    default: return false;
+    }
+}
+
+bool ref8_step(struct ref8 *r, uint16_t keys, size_t vtick, bool *sound) {
+    (void)vtick;
+    uint16_t op = (uint16_t)((r->ram[ADDR(r->pc)] << 8) | r->ram[ADDR(r->pc + 1)]);
+    int x = (op >> 8) & 0xF, y = (op >> 4) & 0xF;
+    uint16_t nnn = op & 0x0FFF;
+    uint8_t nn = op & 0xFF;
+
+    // (PC and the cycle count move on even when the instruction then fails)
+    r->pc += 2;
+    r->cycles++;
+
+    switch (op >> 12) {
+    case 0x0:
+        if (op != 0x00EE || r->sp == 0) return false;
+        r->pc = r->stack[--r->sp];
+        break;
+    case 0x1:
+        r->pc = nnn;
+        break;
+    case 0x2:
+        if (r->sp == STACK_SLOTS) return false;
+        r->stack[r->sp++] = r->pc;
+        r->pc = nnn;
+        break;
+    case 0x3: if (r->V[x] == nn) r->pc += 2; break;
+    case 0x4: if (r->V[x] != nn) r->pc += 2; break;
+    case 0x5: if (r->V[x] == r->V[y]) r->pc += 2; break;
+    case 0x6: r->V[x] = nn; break;
+    case 0x7: r->V[x] += nn; break;
+    case 0x8:
+        if (!alu(r, op & 0xF, x, y)) return false;
+        break;
+    case 0x9: if (r->V[x] != r->V[y]) r->pc += 2; break;
+    case 0xA: r->I = nnn; break;
+    case 0xB: return false;
+    case 0xC: r->V[x] = next_random(r) & nn; break;
+    case 0xD: {
+        // (the start wraps around the screen, the sprite is clipped at the right and bottom edges)
+        int cx = r->V[x] % FB_COLS, cy = r->V[y] % FB_ROWS;
+        uint8_t hit = 0;
+        for (int row = 0; row < (op & 0xF) && cy + row < FB_ROWS; ++row) {
+            uint8_t bits = (uint8_t)r->ram[ADDR(r->I + row)];
+            for (int b = 0; b < 8 && cx + b < FB_COLS; ++b) {
+                if (!(bits & (0x80 >> b))) continue;
+                hit |= r->fb[cy + row][cx + b];
+                r->fb[cy + row][cx + b] ^= 1;
+            }
+        }
+        r->V[0xF] = hit;
+        break;
+    }
+    case 0xE:
+        if (nn == 0x9E && ((keys >> (r->V[x] & 0xF)) & 1)) r->pc += 2;
+        if (nn == 0xA1 && !((keys >> (r->V[x] & 0xF)) & 1)) r->pc += 2;
+        break;
+    case 0xF:
+        if (nn == 0x55) {
+            for (int i = 0; i <= x; ++i) r->ram[ADDR(r->I + i)] = r->V[i];
+        } else if (nn == 0x65) {
+            for (int i = 0; i <= x; ++i) r->V[i] = (uint8_t)r->ram[ADDR(r->I + i)];
+        } else {
+            break;
+        }
+        if (r->quirks & CHIP8_QUIRK_MEMORY_I) r->I += x + 1;
+        break;
+    }
+
+    // timers count down once per instruction
+    if (r->delay_timer) r->delay_timer--;
+    *sound = r->sound_timer != 0;
+    if (r->sound_timer) r->sound_timer--;
+    return true;
+}
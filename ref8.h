@@ -0,0 +1,39 @@
+#ifndef _REF8_H
+#define _REF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// REFERENCE CHIP-8 INTERPRETER
+//--------------------------------------------------------------
+//
+// A deliberately plain, one-switch-per-instruction interpreter with no fast paths, no
+// watchpoints, no tracing and no running fingerprints, used as the oracle that shadow.h
+// checks chip8_cycle against.  It follows what the core does *today* (unimplemented opcodes,
+// unimplemented timers and all), not the CHIP-8 spec, so a divergence means an optimization
+// changed the VM's behavior; an intentional change to the core's semantics has to be made
+// here too.  RAM addresses are masked to 12 bits (the core doesn't check them, so a ROM that
+// strays out of bounds shows up as a divergence instead of corrupting the reference).
+
+struct ref8 {
+    uint16_t ram[RAM_SIZE];     // (same layout as the core's, so whole regions compare with memcmp)
+    uint8_t V[16];
+    uint16_t stack[STACK_SLOTS];
+    uint16_t pc, I, sp;
+    uint16_t delay_timer, sound_timer;
+    uint64_t rng;
+    uint8_t quirks;
+    uint64_t cycles;
+    uint8_t fb[FB_ROWS][FB_COLS];
+};
+
+// take over a VM's emulated state (e.g., right after chip8_load, or to resynchronize)
+void ref8_from_vm(struct ref8 *r, const struct chip8_vm *vm);
+
+// execute one instruction exactly the way chip8_cycle does (same arguments and result), but silently
+bool ref8_step(struct ref8 *r, uint16_t keys, size_t vtick, bool *sound);
+
+#endif
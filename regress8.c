@@ -0,0 +1,311 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// we include the CHIP-8 VM API (and the shadow-execution validator) here
+#include "chip8.h"
+#include "shadow.h"
+#include "romdb.h"  // (for the ROM hash movies are tagged with)
+#include "movie.h"  // (and the gameplay movie recorder)
+
+// ROM-LEVEL GOLDEN-FRAME REGRESSION RUNNER
+//--------------------------------------------------------------
+//
+// The corpus file lists one test case per line ('#' starts a comment; paths are relative
+// to the corpus file):
+//
+//     # rom        frames  cpf  inputs         golden
+//     keypad.ch8   300     20   keypad.keys    keypad.golden
+//
+// Each case runs its ROM headless for `frames` virtual frames of `cpf` cycles each,
+// feeding it the keypad states from the `inputs` script (lines of "FRAME KEYMASK", both
+// in hex; the mask holds from that frame on; "-" means no input), and hashes the
+// framebuffer at every vtick.  The hashes must match the `golden` file (one hex hash per
+// line); on a mismatch the first divergent frame is reported and dumped as a PBM image.
+// Cases run in parallel.  With -u, the golden files are (re)written instead.  With -s, every
+// case also runs under the shadow-execution validator (see shadow.h), and any divergence
+// between the core and the reference interpreter fails it.  With -m, every case is also recorded as
+// a gameplay movie (see movie.h) named after its golden file, which `movie8 replay` can check.
+
+// seed for framebuffer hashes (part of the golden file format, so don't change it)
+#define FB_HASH_SEED 0x464241524d45ull // "FBARME"
+
+#define MAX_CASES 256
+#define MAX_KEY_EVENTS 4096
+
+struct key_event {
+    uint64_t frame;
+    uint16_t keys;
+};
+
+struct test_case {
+    char rom[256], inputs[256], golden[256];
+    char name[128];
+    uint64_t frames;
+    int cpf;
+
+    // results (filled in by the worker that runs the case)
+    bool passed;
+    char message[512];
+};
+
+// settings shared with the worker threads
+static struct test_case cases[MAX_CASES];
+static int num_cases;
+static atomic_int next_case;
+static bool update_mode;
+static const char *shadow_spec;     // (NULL = no shadow execution)
+static const char *dump_dir = ".";
+static const char *movie_dir;       // (NULL = no movies)
+
+// helper to join `rel` onto the directory part of `base` (unless `rel` is absolute)
+static void path_join(char *out, size_t len, const char *base, const char *rel) {
+    const char *slash = strrchr(base, '/');
+    if (rel[0] == '/' || !slash) {
+        snprintf(out, len, "%s", rel);
+    } else {
+        snprintf(out, len, "%.*s/%s", (int)(slash - base), base, rel);
+    }
+}
+
+// helper to read the key event script for a case (returns event count, -1 on error)
+static int load_inputs(const char *path, struct key_event *evs) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    int n = 0;
+    char line[128];
+    while (fgets(line, sizeof line, fp) && n < MAX_KEY_EVENTS) {
+        unsigned long long frame;
+        unsigned keys;
+        if (line[0] == '#' || sscanf(line, "%llx %x", &frame, &keys) != 2) continue;
+        evs[n].frame = frame;
+        evs[n].keys = keys;
+        ++n;
+    }
+    fclose(fp);
+    return n;
+}
+
+// helper to write a framebuffer as a binary PBM (P4) image
+static void dump_pbm(const char *path, const struct chip8_vm *vm) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return;
+    fprintf(fp, "P4\n%d %d\n", FB_COLS, FB_ROWS);
+    for (int y = 0; y < FB_ROWS; ++y) {
+        for (int b = 0; b < FB_COLS / 8; ++b) {
+            uint8_t byte = 0;
+            for (int i = 0; i < 8; ++i) byte |= (vm->fb[y][b * 8 + i] & 1) << (7 - i);
+            fputc(byte, fp);
+        }
+    }
+    fclose(fp);
+}
+
+// run one test case to completion (or first divergence/error)
+static void run_case(struct test_case *tc) {
+    static _Thread_local struct key_event evs[MAX_KEY_EVENTS];
+    uint8_t rom[RAM_SIZE];
+    struct chip8_vm vm;
+    struct shadow *sh = NULL;
+    struct movie_writer *movie = NULL;
+    FILE *golden = NULL;
+    bool sound = false;
+
+    tc->passed = false;
+    FILE *fp = fopen(tc->rom, "rb");
+    if (!fp) {
+        snprintf(tc->message, sizeof tc->message, "cannot open ROM '%s'", tc->rom);
+        return;
+    }
+    size_t romlen = fread(rom, 1, sizeof rom, fp);
+    fclose(fp);
+    if (!chip8_load(&vm, rom, romlen)) {
+        snprintf(tc->message, sizeof tc->message, "cannot load ROM '%s'", tc->rom);
+        return;
+    }
+    struct shadow_config shcfg = { 0 };
+    if (shadow_spec && (!shadow_parse(shadow_spec, &shcfg) || (sh = shadow_create(&vm, &shcfg)) == NULL)) {
+        snprintf(tc->message, sizeof tc->message, "cannot start shadow execution");
+        return;
+    }
+
+    int nevs = load_inputs(tc->inputs, evs);
+    if (nevs < 0) {
+        snprintf(tc->message, sizeof tc->message, "cannot read inputs '%s'", tc->inputs);
+        goto done;
+    }
+    if ((golden = fopen(tc->golden, update_mode ? "w" : "r")) == NULL) {
+        snprintf(tc->message, sizeof tc->message, "cannot open golden file '%s'", tc->golden);
+        goto done;
+    }
+    if (update_mode) {
+        fprintf(golden, "# framebuffer hash after each vtick (regenerate with: regress8 -u CORPUS)\n");
+    }
+
+    if (movie_dir) {
+        char path[384];
+        snprintf(path, sizeof path, "%s/%s.c8mov", movie_dir, tc->name);
+        if ((movie = movie_create(path, romdb_hash_rom(rom, romlen), vm.quirks)) == NULL) {
+            snprintf(tc->message, sizeof tc->message, "cannot create movie '%s'", path);
+            goto done;
+        }
+    }
+
+    uint16_t keys = 0;
+    int ev = 0;
+    for (uint64_t frame = 0; frame < tc->frames; ++frame) {
+        while (ev < nevs && evs[ev].frame <= frame) keys = evs[ev++].keys;
+        if (movie) movie_input(movie, chip8_get_cycles(&vm), keys, frame);
+
+        for (int c = 0; c < tc->cpf; ++c) {
+            if (!(sh ? shadow_cycle(sh, &vm, keys, frame, &sound) : chip8_cycle(&vm, keys, frame, &sound))) {
+                snprintf(tc->message, sizeof tc->message, "frame %llu: chip8_cycle failed at PC=0x%03x",
+                        (unsigned long long)frame, chip8_get_pc(&vm));
+                goto done;
+            }
+        }
+        if (sh && shadow_stats(sh)->divergences) {
+            snprintf(tc->message, sizeof tc->message, "frame %llu: core and reference interpreter diverged (see report)",
+                    (unsigned long long)frame);
+            goto done;
+        }
+
+        if (movie && !movie_write_frame(movie, chip8_get_cycles(&vm), &vm.fb[0][0], sound)) {
+            snprintf(tc->message, sizeof tc->message, "frame %llu: cannot write the movie", (unsigned long long)frame);
+            goto done;
+        }
+
+        uint64_t hash = chip8_hash(vm.fb, sizeof vm.fb, FB_HASH_SEED);
+        if (update_mode) {
+            fprintf(golden, "%016llx\n", (unsigned long long)hash);
+            continue;
+        }
+
+        char line[256];
+        unsigned long long want;
+        do {
+            if (!fgets(line, sizeof line, golden)) {
+                snprintf(tc->message, sizeof tc->message, "golden file ends at frame %llu", (unsigned long long)frame);
+                goto done;
+            }
+        } while (line[0] == '#');
+        if (sscanf(line, "%llx", &want) != 1 || want != hash) {
+            char pbm[384];
+            snprintf(pbm, sizeof pbm, "%s/%s-frame%llu.pbm", dump_dir, tc->name, (unsigned long long)frame);
+            dump_pbm(pbm, &vm);
+            snprintf(tc->message, sizeof tc->message, "frame %llu diverged (%016llx != golden %016llx); see %s",
+                    (unsigned long long)frame, (unsigned long long)hash, want, pbm);
+            goto done;
+        }
+    }
+    if (sh && !shadow_flush(sh, &vm)) {
+        snprintf(tc->message, sizeof tc->message, "end of run: core and reference interpreter diverged (see report)");
+        goto done;
+    }
+    tc->passed = true;
+done:
+    if (golden && fclose(golden) != 0 && update_mode) tc->passed = false;
+    if (!movie_finish(movie) && tc->passed) {
+        snprintf(tc->message, sizeof tc->message, "cannot finish the movie");
+        tc->passed = false;
+    }
+    shadow_destroy(sh);
+}
+
+// worker thread: keep grabbing the next unclaimed case
+static void *worker(void *arg) {
+    (void)arg;
+    int i;
+    while ((i = atomic_fetch_add(&next_case, 1)) < num_cases) {
+        run_case(&cases[i]);
+    }
+    return NULL;
+}
+
+// helper to parse the corpus file into `cases` (false on error)
+static bool load_corpus(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot open corpus '%s'\n", path);
+        return false;
+    }
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof line, fp)) {
+        ++lineno;
+        char rom[256], inputs[256], golden[256];
+        unsigned long long frames;
+        int cpf;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+        if (sscanf(line, "%255s %llu %d %255s %255s", rom, &frames, &cpf, inputs, golden) != 5 || cpf < 1) {
+            fprintf(stderr, "%s:%d: malformed test case\n", path, lineno);
+            fclose(fp);
+            return false;
+        }
+        if (num_cases == MAX_CASES) {
+            fprintf(stderr, "%s:%d: too many test cases\n", path, lineno);
+            fclose(fp);
+            return false;
+        }
+        struct test_case *tc = &cases[num_cases++];
+        path_join(tc->rom, sizeof tc->rom, path, rom);
+        path_join(tc->inputs, sizeof tc->inputs, path, strcmp(inputs, "-") ? inputs : "/dev/null");
+        path_join(tc->golden, sizeof tc->golden, path, golden);
+        const char *base = strrchr(golden, '/') ? strrchr(golden, '/') + 1 : golden;
+        snprintf(tc->name, sizeof tc->name, "%.*s", (int)strcspn(base, "."), base);
+        tc->frames = frames;
+        tc->cpf = cpf;
+    }
+    fclose(fp);
+    return true;
+}
+
+// entry point: run (or with -u, re-record) every case in a corpus
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    pthread_t threads[64];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "uj:o:s:m:")) != -1) {
+        switch (opt) {
+        case 'u': update_mode = true; break;
+        case 'j': jobs = atoi(optarg); break;
+        case 'o': dump_dir = optarg; break;
+        case 's': shadow_spec = optarg; break;
+        case 'm': movie_dir = optarg; break;
+        default: goto usage;
+        }
+    }
+    struct shadow_config shcfg;
+    if (optind != argc - 1 || (shadow_spec && !shadow_parse(shadow_spec, &shcfg))) {
+usage:
+        fprintf(stderr, "usage: %s [-u] [-j JOBS] [-o DUMP_DIR] [-s insn|block|VTICKS] [-m MOVIE_DIR] CORPUS\n", argv[0]);
+        goto cleanup;
+    }
+    if (!load_corpus(argv[optind])) goto cleanup;
+
+    if (jobs < 1) jobs = 1;
+    if (jobs > 64) jobs = 64;
+    if (jobs > num_cases) jobs = num_cases;
+    for (int t = 0; t < jobs; ++t) pthread_create(&threads[t], NULL, worker, NULL);
+    for (int t = 0; t < jobs; ++t) pthread_join(threads[t], NULL);
+
+    int failed = 0;
+    for (int i = 0; i < num_cases; ++i) {
+        printf("%-24s %s%s%s\n", cases[i].name, cases[i].passed ? (update_mode ? "UPDATED" : "OK") : "FAIL",
+                cases[i].passed ? "" : ": ", cases[i].message);
+        if (!cases[i].passed) ++failed;
+    }
+    printf("%d/%d cases passed\n", num_cases - failed, num_cases);
+    if (!failed) ret = EXIT_SUCCESS;
+
+cleanup:
+    return ret;
+}
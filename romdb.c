@@ -0,0 +1,262 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+// POSIX hosts memory-map the index; everyone else just reads it into a malloc'd buffer
+#if defined(__unix__) || defined(__APPLE__)
+#define ROMDB_MMAP 1
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "chip8.h"
+#include "romdb.h"
+
+// seed for ROM hashes (changing it invalidates every database out there, so don't)
+#define ROMDB_HASH_SEED 0x43484950382d3031ull // "CHIP8-01"
+
+// header at the start of the binary index file (followed by `count` sorted `romdb_entry` records)
+struct romdb_index_header {
+    char magic[8];          // "C8ROMDB1"
+    uint32_t count;         // number of records
+    uint32_t entry_size;    // sizeof(struct romdb_entry) when the index was written
+    int64_t src_mtime;      // modification time of the text file the index was built from
+    int64_t src_size;       // and its size (together, our "is the index stale?" check)
+};
+
+#define ROMDB_MAGIC "C8ROMDB1"
+
+struct romdb {
+    const struct romdb_entry *entries;  // sorted by hash
+    uint32_t count;
+    void *base;                         // start of the mapping/buffer holding header + entries
+    size_t len;                         // its length in bytes
+    bool mapped;                        // true if `base` came from mmap (else malloc)
+};
+
+// helper to order records by hash (for qsort)
+static int entry_cmp(const void *a, const void *b) {
+    uint64_t ha = ((const struct romdb_entry *)a)->hash;
+    uint64_t hb = ((const struct romdb_entry *)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+// helper to parse the text database into a malloc'd, sorted array of records
+// (returns number of records, or -1 on error with `*out` untouched)
+static long parse_text(const char *path, struct romdb_entry **out) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    struct romdb_entry *vec = NULL;
+    long count = 0, cap = 0, lineno = 0;
+    char line[256];
+    while (fgets(line, sizeof line, fp)) {
+        ++lineno;
+        char *hash_pos = line;
+        while (isspace((unsigned char)*hash_pos)) ++hash_pos;
+        if (*hash_pos == '#' || *hash_pos == '\0') continue;
+
+        struct romdb_entry e;
+        memset(&e, 0, sizeof e);
+        unsigned long long hash;
+        unsigned long cpf;
+        long quirks, idle_pc;
+        int name_pos = 0;
+        if (sscanf(hash_pos, "%llx %lu %li %li %n", &hash, &cpf, &quirks, &idle_pc, &name_pos) < 4) {
+            fprintf(stderr, "%s:%ld: malformed ROM database record\n", path, lineno);
+            free(vec);
+            fclose(fp);
+            return -1;
+        }
+        e.hash = hash;
+        e.cpf = (uint32_t)cpf;
+        e.quirks = (uint8_t)quirks;
+        e.idle_pc = (uint16_t)(idle_pc & 0x0fff);
+        if (name_pos) {
+            // the rest of the line (minus comments/trailing whitespace) is the title
+            char *name = hash_pos + name_pos;
+            name[strcspn(name, "#\r\n")] = '\0';
+            size_t n = strlen(name);
+            while (n && isspace((unsigned char)name[n - 1])) name[--n] = '\0';
+            snprintf(e.name, sizeof e.name, "%s", name);
+        }
+
+        if (count == cap) {
+            cap = cap ? cap * 2 : 64;
+            struct romdb_entry *nv = realloc(vec, cap * sizeof *vec);
+            if (!nv) {
+                free(vec);
+                fclose(fp);
+                return -1;
+            }
+            vec = nv;
+        }
+        vec[count++] = e;
+    }
+    fclose(fp);
+
+    qsort(vec, count, sizeof *vec, entry_cmp);
+    *out = vec;
+    return count;
+}
+
+// helper to (re)write the binary index for text file `path` (best effort; false on error)
+static bool write_index(const char *idx_path, const struct stat *src, const struct romdb_entry *vec, long count) {
+    char tmp_path[1040];
+#ifdef ROMDB_MMAP
+    // (a temporary name of our own, so two hosts rebuilding the index at once never write into
+    // the same file; mkstemp makes it 0600, but the index is as readable as the text file)
+    snprintf(tmp_path, sizeof tmp_path, "%s.XXXXXX", idx_path);
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) return false;
+    FILE *fp = fdopen(fd, "wb");
+    if (!fp || fchmod(fd, 0644) != 0) {
+        if (fp) fclose(fp);
+        else close(fd);
+        remove(tmp_path);
+        return false;
+    }
+#else
+    snprintf(tmp_path, sizeof tmp_path, "%s.tmp", idx_path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) return false;
+#endif
+
+    struct romdb_index_header hdr;
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, ROMDB_MAGIC, sizeof hdr.magic);
+    hdr.count = (uint32_t)count;
+    hdr.entry_size = sizeof(struct romdb_entry);
+    hdr.src_mtime = (int64_t)src->st_mtime;
+    hdr.src_size = (int64_t)src->st_size;
+
+    bool ok = (fwrite(&hdr, sizeof hdr, 1, fp) == 1)
+        && (fwrite(vec, sizeof *vec, count, fp) == (size_t)count);
+    ok = (fclose(fp) == 0) && ok;
+
+    // rename-over so concurrent readers only ever see a complete index
+    if (!ok || rename(tmp_path, idx_path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+// helper to load the index file (if it exists and matches the text file); false if missing/stale
+static bool load_index(struct romdb *db, const char *idx_path, const struct stat *src) {
+    struct romdb_index_header hdr;
+#ifdef ROMDB_MMAP
+    int fd = open(idx_path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof hdr) {
+        close(fd);
+        return false;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    db->base = base;
+    db->len = st.st_size;
+    db->mapped = true;
+#else
+    FILE *fp = fopen(idx_path, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    rewind(fp);
+    void *base = (len >= (long)sizeof hdr) ? malloc(len) : NULL;
+    if (!base || fread(base, 1, len, fp) != (size_t)len) {
+        free(base);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+    db->base = base;
+    db->len = len;
+    db->mapped = false;
+#endif
+
+    memcpy(&hdr, db->base, sizeof hdr);
+    bool fresh = (memcmp(hdr.magic, ROMDB_MAGIC, sizeof hdr.magic) == 0)
+        && (hdr.entry_size == sizeof(struct romdb_entry))
+        && (hdr.src_mtime == (int64_t)src->st_mtime)
+        && (hdr.src_size == (int64_t)src->st_size)
+        && (db->len >= sizeof hdr + (size_t)hdr.count * sizeof(struct romdb_entry));
+    if (!fresh) {
+#ifdef ROMDB_MMAP
+        munmap(db->base, db->len);
+#else
+        free(db->base);
+#endif
+        db->base = NULL;
+        return false;
+    }
+
+    db->entries = (const struct romdb_entry *)((const char *)db->base + sizeof hdr);
+    db->count = hdr.count;
+    return true;
+}
+
+struct romdb *romdb_open(const char *path) {
+    struct stat src;
+    if (stat(path, &src) != 0) return NULL;
+
+    struct romdb *db = calloc(1, sizeof *db);
+    if (!db) return NULL;
+
+    char idx_path[1024];
+    snprintf(idx_path, sizeof idx_path, "%s.idx", path);
+
+    // fast path: the index is up to date
+    if (load_index(db, idx_path, &src)) return db;
+
+    // slow path: compile the text file, then try to cache the result for next time
+    struct romdb_entry *vec = NULL;
+    long count = parse_text(path, &vec);
+    if (count < 0) {
+        free(db);
+        return NULL;
+    }
+    if (write_index(idx_path, &src, vec, count) && load_index(db, idx_path, &src)) {
+        free(vec);
+        return db;
+    }
+
+    // (read-only directory?) just use the parsed records directly
+    db->entries = vec;
+    db->count = (uint32_t)count;
+    db->base = vec;
+    db->mapped = false;
+    return db;
+}
+
+const struct romdb_entry *romdb_lookup(const struct romdb *db, uint64_t hash) {
+    if (!db) return NULL;
+    size_t lo = 0, hi = db->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint64_t h = db->entries[mid].hash;
+        if (h == hash) return &db->entries[mid];
+        if (h < hash) lo = mid + 1; else hi = mid;
+    }
+    return NULL;
+}
+
+uint64_t romdb_hash_rom(const uint8_t *program, size_t proglen) {
+    return chip8_hash(program, proglen, ROMDB_HASH_SEED);
+}
+
+void romdb_close(struct romdb *db) {
+    if (!db) return;
+#ifdef ROMDB_MMAP
+    if (db->mapped) munmap(db->base, db->len);
+    else
+#endif
+    free(db->base);
+    free(db);
+}
@@ -0,0 +1,51 @@
+#ifndef _ROMDB_H
+#define _ROMDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ROM DATABASE: PER-TITLE SETTINGS KEYED BY chip8_hash() OF THE ROM BYTES
+//--------------------------------------------------------------
+//
+// The database is a plain text file (one ROM per line, '#' starts a comment):
+//
+//     # hash (hex)      cpf   quirks  idle_pc  name
+//     5a8e20a2db8f4b2e  600   0x03    0x2b4    Pong
+//
+// * `cpf` := recommended CHIP-8 cycles per frame (0 = use the host's default)
+// * `quirks` := CHIP8_QUIRK_* bit vector to pass to chip8_set_quirks()
+// * `idle_pc` := address of a busy-wait loop (e.g., a delay timer poll); once PC lands
+//   there the host can sleep until the next frame instead of burning cycles (0 = none)
+//
+// The first lookup after the text file changes compiles it into a sorted binary index
+// (`<path>.idx`) right next to it; every later startup just memory-maps that index and
+// binary-searches it, so no parsing happens on the common path.
+
+// the record stored (sorted by `hash`) in the binary index file
+struct romdb_entry {
+    uint64_t hash;
+    uint32_t cpf;
+    uint16_t idle_pc;
+    uint8_t quirks;
+    uint8_t reserved;
+    char name[48];
+};
+
+// opaque handle for an open database
+struct romdb;
+
+// open the database stored in text file `path` (rebuilding its index if stale)
+// (NULL on error, e.g., the text file does not exist or cannot be parsed)
+struct romdb *romdb_open(const char *path);
+
+// find the record for the ROM with the given chip8_hash() value (NULL if not found)
+const struct romdb_entry *romdb_lookup(const struct romdb *db, uint64_t hash);
+
+// hash a ROM image the same way the database does
+uint64_t romdb_hash_rom(const uint8_t *program, size_t proglen);
+
+// release an open database (NULL is OK)
+void romdb_close(struct romdb *db);
+
+#endif
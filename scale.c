@@ -0,0 +1,132 @@
+#include <string.h>
+#include <pthread.h>
+
+#include "scale.h"
+
+// on x86 builds with GCC/Clang we compile SSE2 and AVX2 versions of the row expander
+// side by side (via target attributes) and pick one at runtime based on the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCALE8_X86 1
+#include <immintrin.h>
+#endif
+
+// index into the per-call palette by framebuffer byte value (0 = bg, 1 = fg, else error)
+#define PAL_INDEX(v) ((v) > 1 ? 2 : (v))
+
+// halve the RGB channels of an ARGB pixel (keeping alpha)
+#define DIM(c) (((c) & 0xff000000u) | (((c) >> 1) & 0x007f7f7fu))
+
+// signature of the routines that expand one framebuffer row into one row of ARGB pixels
+// (`grid` != 0 means "paint the last column of each block in that color")
+typedef void (*expand_row_fn)(const uint8_t *src, int cols, int scale, uint32_t *out,
+                              const uint32_t pal[3], uint32_t grid);
+
+static void expand_row_scalar(const uint8_t *src, int cols, int scale, uint32_t *out,
+                              const uint32_t pal[3], uint32_t grid) {
+    for (int x = 0; x < cols; ++x) {
+        uint32_t c = pal[PAL_INDEX(src[x])];
+        for (int i = 0; i < scale; ++i) out[i] = c;
+        if (grid) out[scale - 1] = grid;
+        out += scale;
+    }
+}
+
+#ifdef SCALE8_X86
+__attribute__((target("sse2")))
+static void expand_row_sse2(const uint8_t *src, int cols, int scale, uint32_t *out,
+                            const uint32_t pal[3], uint32_t grid) {
+    for (int x = 0; x < cols; ++x) {
+        uint32_t c = pal[PAL_INDEX(src[x])];
+        __m128i v = _mm_set1_epi32((int)c);
+        int i = 0;
+        for (; i + 4 <= scale; i += 4) _mm_storeu_si128((__m128i *)(out + i), v);
+        for (; i < scale; ++i) out[i] = c;
+        if (grid) out[scale - 1] = grid;
+        out += scale;
+    }
+}
+
+__attribute__((target("avx2")))
+static void expand_row_avx2(const uint8_t *src, int cols, int scale, uint32_t *out,
+                            const uint32_t pal[3], uint32_t grid) {
+    for (int x = 0; x < cols; ++x) {
+        uint32_t c = pal[PAL_INDEX(src[x])];
+        __m256i v = _mm256_set1_epi32((int)c);
+        int i = 0;
+        for (; i + 8 <= scale; i += 8) _mm256_storeu_si256((__m256i *)(out + i), v);
+        if (i + 4 <= scale) {
+            _mm_storeu_si128((__m128i *)(out + i), _mm256_castsi256_si128(v));
+            i += 4;
+        }
+        for (; i < scale; ++i) out[i] = c;
+        if (grid) out[scale - 1] = grid;
+        out += scale;
+    }
+}
+#endif
+
+// the expander chosen for this CPU (picked on first use, exactly once: grid workers all scale
+// their tiles at the same time, so the first use can come from several threads at once)
+static expand_row_fn expand_row;
+static const char *expand_isa;
+static pthread_once_t expander_once = PTHREAD_ONCE_INIT;
+
+static void pick_expander(void) {
+#ifdef SCALE8_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        expand_isa = "avx2";
+        expand_row = expand_row_avx2;
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        expand_isa = "sse2";
+        expand_row = expand_row_sse2;
+        return;
+    }
+#endif
+    expand_isa = "scalar";
+    expand_row = expand_row_scalar;
+}
+
+int scale8_fit(int cols, int rows, int width, int height) {
+    int sx = width / cols;
+    int sy = height / rows;
+    int s = (sx < sy) ? sx : sy;
+    return (s < 1) ? 1 : s;
+}
+
+void scale8_argb(const uint8_t *fb, int cols, int rows, int scale,
+                 uint32_t *dst, int pitch, const struct scale8_opts *opts) {
+    pthread_once(&expander_once, pick_expander);
+
+    const uint32_t pal[3] = { opts->bg, opts->fg, opts->error };
+    // (effects need at least one spare line per block to draw into)
+    bool grid = (opts->effects & SCALE8_GRID) && (scale > 1);
+    bool scanlines = (opts->effects & SCALE8_SCANLINES) && (scale > 1);
+    size_t row_bytes = (size_t)cols * scale * sizeof(uint32_t);
+    int out_cols = cols * scale;
+
+    for (int y = 0; y < rows; ++y) {
+        // expand the first output line of this row of blocks...
+        uint32_t *first = (uint32_t *)((uint8_t *)dst + (size_t)y * scale * pitch);
+        expand_row(fb + (size_t)y * cols, cols, scale, first, pal, grid ? opts->grid : 0);
+
+        // ...then replicate it down the rest of the block (which is just a memcpy per line)
+        for (int r = 1; r < scale; ++r) {
+            uint32_t *line = (uint32_t *)((uint8_t *)first + (size_t)r * pitch);
+            if (r == scale - 1 && grid) {
+                for (int i = 0; i < out_cols; ++i) line[i] = opts->grid;
+            } else if (r == scale - 1 && scanlines) {
+                for (int i = 0; i < out_cols; ++i) line[i] = DIM(first[i]);
+            } else {
+                memcpy(line, first, row_bytes);
+            }
+        }
+    }
+}
+
+const char *scale8_isa(void) {
+    pthread_once(&expander_once, pick_expander);
+    return expand_isa;
+}
@@ -0,0 +1,39 @@
+#ifndef _SCALE_H
+#define _SCALE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// CPU FRAMEBUFFER UPSCALER
+//--------------------------------------------------------------
+//
+// Expands a 1-byte-per-pixel CHIP-8 framebuffer into 32-bit ARGB pixels at an integer
+// scale factor, ready to be copied into a streaming texture (one texture upload and one
+// draw call per frame, no matter how big the window gets).  Uses AVX2 or SSE2 stores
+// when the CPU has them and plain C otherwise.
+
+// effect flags for `scale8_opts.effects`
+#define SCALE8_GRID      0x01   // outline every CHIP-8 pixel in `grid` color (debugging aid)
+#define SCALE8_SCANLINES 0x02   // dim the bottom line of every CHIP-8 pixel (CRT look)
+
+// colors are 0xAARRGGBB (SDL_PIXELFORMAT_ARGB8888)
+struct scale8_opts {
+    uint32_t bg;        // color of pixels that are off (0)
+    uint32_t fg;        // color of pixels that are on (1)
+    uint32_t error;     // color of pixels with any other (invalid) value
+    uint32_t grid;      // color of SCALE8_GRID outlines
+    int effects;        // SCALE8_* bit vector
+};
+
+// largest integer scale at which a `cols` x `rows` image fits in `width` x `height` (at least 1)
+int scale8_fit(int cols, int rows, int width, int height);
+
+// expand `fb` (`rows` rows of `cols` bytes) into `dst`, which must hold `rows * scale` rows
+// of `cols * scale` pixels each, `pitch` bytes apart
+void scale8_argb(const uint8_t *fb, int cols, int rows, int scale,
+                 uint32_t *dst, int pitch, const struct scale8_opts *opts);
+
+// name of the code path scale8_argb picked for this CPU ("avx2", "sse2" or "scalar")
+const char *scale8_isa(void);
+
+#endif
@@ -0,0 +1,283 @@
+// some standard library headers
+#include <stdlib.h>
+#include <string.h>
+
+#include "ref8.h"
+#include "shadow.h"
+
+#define DEFAULT_SAMPLE_VTICKS 60
+#define RAM_DIFFS_SHOWN 8
+
+#define ADDR(a) ((a) & 0x0FFF)
+
+// one instruction as it was fed to both machines
+struct shadow_step {
+    uint32_t vtick;
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t keys;
+    bool failed;
+};
+
+struct shadow {
+    struct shadow_config cfg;
+    struct shadow_stats stats;
+    struct ref8 ref;
+    bool synced;            // is the reference following the VM right now (for SHADOW_SAMPLED: inside a window)?
+    bool pending;           // has it run instructions since the last comparison?
+
+    // outcome of the latest instruction on each side
+    bool ok, ref_ok;
+    bool sound, ref_sound;
+
+    // (SHADOW_SAMPLED) the current window: its vtick, when the next one starts and the VM at its start
+    size_t window_vtick;
+    size_t next_sample;
+    struct chip8_vm base;
+    struct chip8_vm replay; // (scratch copies of `base` for pinning a divergence down)
+    struct ref8 replay_ref;
+
+    // recent instructions (a ring of SHADOW_TRACE; for SHADOW_SAMPLED, the whole window; both powers of 2)
+    struct shadow_step *log;
+    size_t log_cap;
+    uint64_t nsteps;
+};
+
+struct shadow *shadow_create(const struct chip8_vm *vm, const struct shadow_config *cfg) {
+    if (cfg->mode != SHADOW_INSN && cfg->mode != SHADOW_BLOCK && cfg->mode != SHADOW_SAMPLED) return NULL;
+    if (cfg->sample_vticks < 0) return NULL;
+    struct shadow *sh = calloc(1, sizeof *sh);
+    if (!sh) return NULL;
+    sh->cfg = *cfg;
+    if (!sh->cfg.sample_vticks) sh->cfg.sample_vticks = DEFAULT_SAMPLE_VTICKS;
+    sh->log_cap = (cfg->mode == SHADOW_SAMPLED) ? SHADOW_WINDOW : SHADOW_TRACE;
+    if ((sh->log = calloc(sh->log_cap, sizeof sh->log[0])) == NULL) {
+        free(sh);
+        return NULL;
+    }
+    ref8_from_vm(&sh->ref, vm);
+    sh->synced = (cfg->mode != SHADOW_SAMPLED);
+    return sh;
+}
+
+bool shadow_parse(const char *spec, struct shadow_config *cfg) {
+    char *end;
+    if (!strcmp(spec, "insn")) {
+        cfg->mode = SHADOW_INSN;
+    } else if (!strcmp(spec, "block")) {
+        cfg->mode = SHADOW_BLOCK;
+    } else {
+        long n = strtol(spec, &end, 10);
+        if (end == spec || *end || n < 1 || n > 1000000) return false;
+        cfg->mode = SHADOW_SAMPLED;
+        cfg->sample_vticks = (int)n;
+    }
+    return true;
+}
+
+// helper to compare everything the two machines emulate
+static bool same_state(const struct chip8_vm *vm, const struct ref8 *r) {
+    return vm->pc == r->pc && vm->I == r->I && vm->sp == r->sp
+        && vm->delay_timer == r->delay_timer && vm->sound_timer == r->sound_timer
+        && vm->rng == r->rng && vm->quirks == r->quirks && vm->cycles == r->cycles
+        && !memcmp(vm->V, r->V, sizeof r->V)
+        && !memcmp(vm->stack, r->stack, sizeof r->stack)
+        && !memcmp(vm->ram, r->ram, sizeof r->ram)
+        && !memcmp(vm->fb, r->fb, sizeof r->fb);
+}
+
+// helper to print one scalar side by side (flagged if the two differ)
+static void report_field(FILE *f, const char *name, unsigned long long core, unsigned long long ref, int digits) {
+    fprintf(f, "  %-8s %0*llx  %0*llx%s\n", name, digits, core, digits, ref, core != ref ? "  <--" : "");
+}
+
+// helper to print a register file or the stack for both machines, with a marker under each difference
+static void report_array(FILE *f, const char *name, const uint16_t *core, const uint16_t *ref, int n, int digits) {
+    fprintf(f, "  %-8s core:", name);
+    for (int i = 0; i < n; ++i) fprintf(f, " %0*x", digits, core[i]);
+    fprintf(f, "\n  %-8s  ref:", "");
+    for (int i = 0; i < n; ++i) fprintf(f, " %0*x", digits, ref[i]);
+    fprintf(f, "\n  %-8s      ", "");
+    for (int i = 0; i < n; ++i) fprintf(f, " %*s", digits, core[i] != ref[i] ? "^" : "");
+    fprintf(f, "\n");
+}
+
+// helper to write a divergence report: both states, what differs, and the `n`th instruction back
+// to SHADOW_TRACE before it (`exact`: the state is right after the first instruction that went wrong)
+static void report(struct shadow *sh, const struct chip8_vm *vm, const struct ref8 *r, uint64_t n, bool exact) {
+    static const char *const mode_names[] = { "instruction", "block", "sampled" };
+    FILE *f = sh->cfg.report ? sh->cfg.report : stderr;
+    const struct shadow_step *last = &sh->log[(n - 1) & (sh->log_cap - 1)];
+
+    fprintf(f, "SHADOW: core and reference diverged (%s check, %s instruction at PC=0x%03x [%04X], vtick %u, cycle %llu)\n",
+            mode_names[sh->cfg.mode], exact ? "first bad" : "latest", last->pc, last->opcode, last->vtick,
+            (unsigned long long)vm->cycles);
+    if (sh->ok != sh->ref_ok) {
+        fprintf(f, "  result   core %s, reference %s\n", sh->ok ? "ok" : "failed", sh->ref_ok ? "ok" : "failed");
+    }
+    if (sh->sound != sh->ref_sound) {
+        fprintf(f, "  sound    core %s, reference %s\n", sh->sound ? "on" : "off", sh->ref_sound ? "on" : "off");
+    }
+
+    fprintf(f, "  %-8s %-4s  %s\n", "", "core", "reference");
+    report_field(f, "PC", vm->pc, r->pc, 4);
+    report_field(f, "I", vm->I, r->I, 4);
+    report_field(f, "SP", vm->sp, r->sp, 4);
+    report_field(f, "DT", vm->delay_timer, r->delay_timer, 4);
+    report_field(f, "ST", vm->sound_timer, r->sound_timer, 4);
+    report_field(f, "quirks", vm->quirks, r->quirks, 4);
+    report_field(f, "RNG", vm->rng, r->rng, 16);
+    report_field(f, "cycles", vm->cycles, r->cycles, 16);
+    uint16_t cv[16], rv[16];
+    for (int i = 0; i < 16; ++i) {
+        cv[i] = vm->V[i];
+        rv[i] = r->V[i];
+    }
+    report_array(f, "V0-VF", cv, rv, 16, 2);
+    report_array(f, "stack", vm->stack, r->stack, STACK_SLOTS, 3);
+
+    int ram_diffs = 0, fb_diffs = 0;
+    for (int a = 0; a < RAM_SIZE; ++a) {
+        if (vm->ram[a] == r->ram[a]) continue;
+        if (ram_diffs++ < RAM_DIFFS_SHOWN) fprintf(f, "  RAM[%03x] %02x    %02x  <--\n", a, vm->ram[a], r->ram[a]);
+    }
+    if (ram_diffs > RAM_DIFFS_SHOWN) fprintf(f, "  (%d more RAM bytes differ)\n", ram_diffs - RAM_DIFFS_SHOWN);
+    int first_row = 0, first_col = 0;
+    for (int y = FB_ROWS - 1; y >= 0; --y) {
+        for (int x = FB_COLS - 1; x >= 0; --x) {
+            if (vm->fb[y][x] == r->fb[y][x]) continue;
+            ++fb_diffs;
+            first_row = y;
+            first_col = x;
+        }
+    }
+    if (fb_diffs) fprintf(f, "  framebuffer: %d pixels differ (first at row %d, column %d)\n", fb_diffs, first_row, first_col);
+
+    uint64_t shown = n < SHADOW_TRACE ? n : SHADOW_TRACE;
+    fprintf(f, "  last %llu instructions (oldest first):\n", (unsigned long long)shown);
+    for (uint64_t i = n - shown; i < n; ++i) {
+        const struct shadow_step *st = &sh->log[i & (sh->log_cap - 1)];
+        fprintf(f, "    vtick %-8u PC=0x%03x  %04X  keys=%04x%s\n", st->vtick, st->pc, st->opcode, st->keys,
+                st->failed ? "  (failed)" : "");
+    }
+    fflush(f);
+}
+
+// helper to replay a SHADOW_SAMPLED window from its starting copy, checking after every instruction;
+// on the first disagreement, `replay`/`replay_ref` hold both states and `*n` the instructions run (false
+// if it all agrees this time, e.g., because the host changed the VM without telling us)
+static bool pinpoint(struct shadow *sh, uint64_t *n) {
+    sh->replay = sh->base;
+    chip8_attach_watches(&sh->replay, NULL);
+    chip8_attach_tracer(&sh->replay, NULL);
+    ref8_from_vm(&sh->replay_ref, &sh->replay);
+    for (uint64_t i = 0; i < sh->nsteps; ++i) {
+        const struct shadow_step *st = &sh->log[i];
+        bool sound = false, ref_sound = false;
+        bool ok = chip8_cycle(&sh->replay, st->keys, st->vtick, &sound);
+        bool ref_ok = ref8_step(&sh->replay_ref, st->keys, st->vtick, &ref_sound);
+        if (ok != ref_ok || sound != ref_sound || !same_state(&sh->replay, &sh->replay_ref)) {
+            sh->ok = ok, sh->ref_ok = ref_ok, sh->sound = sound, sh->ref_sound = ref_sound;
+            *n = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// helper to compare the VM with the reference now, reporting (and then dropping) any divergence
+static bool compare(struct shadow *sh, const struct chip8_vm *vm) {
+    sh->stats.checks++;
+    sh->pending = false;
+    if (sh->ok == sh->ref_ok && sh->sound == sh->ref_sound && same_state(vm, &sh->ref)) return true;
+
+    sh->stats.divergences++;
+    uint64_t n;
+    if (sh->cfg.mode == SHADOW_SAMPLED && pinpoint(sh, &n)) {
+        report(sh, &sh->replay, &sh->replay_ref, n, true);
+    } else {
+        if (sh->cfg.mode == SHADOW_SAMPLED) {
+            fprintf(sh->cfg.report ? sh->cfg.report : stderr,
+                    "SHADOW: (replaying the window from its start did not reproduce this divergence)\n");
+        }
+        report(sh, vm, &sh->ref, sh->nsteps, sh->cfg.mode == SHADOW_INSN);
+    }
+    sh->synced = false;     // (start over from the core's state)
+    return false;
+}
+
+// helper to run one instruction on both machines (out of line, so the unsampled path of
+// SHADOW_SAMPLED stays a compare and a jump into chip8_cycle)
+static __attribute__((noinline)) bool shadowed_cycle(struct shadow *sh, struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
+    if (!sh->synced) {
+        if (sh->cfg.mode == SHADOW_SAMPLED) {
+            sh->base = *vm;
+            sh->window_vtick = vtick;
+            sh->next_sample = vtick + sh->cfg.sample_vticks;
+            sh->nsteps = 0;
+        }
+        ref8_from_vm(&sh->ref, vm);
+        sh->synced = true;
+    }
+
+    struct shadow_step *st = &sh->log[sh->nsteps++ & (sh->log_cap - 1)];
+    st->vtick = (uint32_t)vtick;
+    st->pc = vm->pc;
+    st->opcode = (uint16_t)((vm->ram[ADDR(vm->pc)] << 8) | vm->ram[ADDR(vm->pc + 1)]);
+    st->keys = keys;
+
+    sh->ok = chip8_cycle(vm, keys, vtick, sound);
+    sh->ref_ok = ref8_step(&sh->ref, keys, vtick, &sh->ref_sound);
+    sh->sound = *sound;
+    st->failed = !sh->ok;
+    sh->stats.shadowed++;
+    sh->pending = true;
+
+    // a different result or beeper state can't wait for the end of the block/window
+    bool check = sh->ok != sh->ref_ok || sh->sound != sh->ref_sound || !sh->ok;
+    if (sh->cfg.mode == SHADOW_INSN) check = true;
+    if (sh->cfg.mode == SHADOW_BLOCK && vm->pc != (uint16_t)(st->pc + 2)) check = true;
+    if (check) compare(sh, vm);
+
+    // (after a failure the host usually patches the VM up, so pick its state up afresh)
+    if (!sh->ok) sh->synced = false;
+    return sh->ok;
+}
+
+bool shadow_cycle(struct shadow *sh, struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound) {
+    sh->stats.cycles++;
+    if (sh->cfg.mode == SHADOW_SAMPLED) {
+        // close the window once its vtick is over (or the log is full), then run unchecked until the next one
+        if (sh->synced && (vtick != sh->window_vtick || sh->nsteps == sh->log_cap)) {
+            compare(sh, vm);
+            sh->synced = false;
+        }
+        if (!sh->synced && vtick < sh->next_sample && vtick >= sh->window_vtick) {
+            return chip8_cycle(vm, keys, vtick, sound);
+        }
+    }
+    return shadowed_cycle(sh, vm, keys, vtick, sound);
+}
+
+void shadow_resync(struct shadow *sh) {
+    sh->synced = false;
+    sh->pending = false;
+    sh->stats.resyncs++;
+}
+
+bool shadow_flush(struct shadow *sh, const struct chip8_vm *vm) {
+    if (!sh->synced || !sh->pending) return true;
+    bool same = compare(sh, vm);
+    if (sh->cfg.mode == SHADOW_SAMPLED) sh->synced = false;
+    return same;
+}
+
+const struct shadow_stats *shadow_stats(const struct shadow *sh) {
+    return &sh->stats;
+}
+
+void shadow_destroy(struct shadow *sh) {
+    if (!sh) return;
+    free(sh->log);
+    free(sh);
+}
@@ -0,0 +1,79 @@
+#ifndef _SHADOW_H
+#define _SHADOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "chip8.h"
+
+// SHADOW-EXECUTION VALIDATOR
+//--------------------------------------------------------------
+//
+// Runs the reference interpreter (ref8.h) next to chip8_cycle on the same inputs and
+// compares the two machines' full state (registers, stack, timers, RNG, cycle count, RAM and
+// framebuffer) at one of three granularities:
+//
+//   SHADOW_INSN     after every instruction (slowest; pinpoints a divergence exactly)
+//   SHADOW_BLOCK    at the end of every straight-line run: after any jump, call, return or
+//                   taken skip, and after a failed instruction
+//   SHADOW_SAMPLED  one vtick out of every `sample_vticks`: the reference takes a copy of the
+//                   VM when the sampled vtick starts, follows it until the vtick ends (or
+//                   SHADOW_WINDOW instructions, whichever is first) and then compares; the
+//                   other vticks run chip8_cycle directly, so the cost is roughly 1/N of
+//                   SHADOW_INSN's and low enough to leave on in everyday builds
+//
+// A divergence (different state, a different chip8_cycle result or a different beeper state)
+// is written to the report stream with both machines' state side by side, the RAM and
+// framebuffer differences and the most recent instructions; in SHADOW_SAMPLED mode the window
+// is first replayed from its starting copy to find the first instruction that went wrong.
+// The reference then takes over the VM's state again and checking carries on.
+
+#define SHADOW_TRACE 32         // instructions shown in a divergence report
+#define SHADOW_WINDOW 4096      // most instructions in one SHADOW_SAMPLED window
+
+enum shadow_mode {
+    SHADOW_INSN,
+    SHADOW_BLOCK,
+    SHADOW_SAMPLED,
+};
+
+struct shadow_config {
+    enum shadow_mode mode;
+    int sample_vticks;          // SHADOW_SAMPLED: check one vtick in this many (0 = 60)
+    FILE *report;               // where divergence reports go (NULL = stderr)
+};
+
+struct shadow_stats {
+    uint64_t cycles;            // instructions run through shadow_cycle...
+    uint64_t shadowed;          // ...and how many of them the reference ran too
+    uint64_t checks;            // state comparisons
+    uint64_t divergences;
+    uint64_t resyncs;           // shadow_resync calls
+};
+
+struct shadow;
+
+// start shadowing `vm` (whose current state the reference starts from) (NULL on error)
+struct shadow *shadow_create(const struct chip8_vm *vm, const struct shadow_config *cfg);
+
+// parse a mode spec: "insn", "block", or a number N for SHADOW_SAMPLED every N vticks (false if bad)
+bool shadow_parse(const char *spec, struct shadow_config *cfg);
+
+// drop-in replacement for chip8_cycle (same arguments, and the core's result)
+bool shadow_cycle(struct shadow *sh, struct chip8_vm *vm, uint16_t keys, size_t vtick, bool *sound);
+
+// the host changed the VM outside chip8_cycle (a debugger poke, chip8_set_pc after an error, ...):
+// drop any unchecked work and start over from the VM's state on the next shadow_cycle
+void shadow_resync(struct shadow *sh);
+
+// compare anything not yet checked right now (e.g., at the end of a run); false on a divergence
+bool shadow_flush(struct shadow *sh, const struct chip8_vm *vm);
+
+const struct shadow_stats *shadow_stats(const struct shadow *sh);
+
+// (NULL is OK)
+void shadow_destroy(struct shadow *sh);
+
+#endif
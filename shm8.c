@@ -0,0 +1,88 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shm8.h"
+
+struct shm8 {
+    struct shm8_state *st;
+    char name[256];
+};
+
+struct shm8 *shm8_create(const char *name) {
+    struct shm8 *shm = calloc(1, sizeof *shm);
+    if (!shm) return NULL;
+    snprintf(shm->name, sizeof shm->name, "%s", name);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: shm_open('%s'): %s\n", name, strerror(errno));
+        free(shm);
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof *shm->st) != 0) {
+        fprintf(stderr, "ERROR: cannot size shared memory '%s': %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        free(shm);
+        return NULL;
+    }
+    shm->st = mmap(NULL, sizeof *shm->st, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // (the mapping keeps the segment alive)
+    if (shm->st == MAP_FAILED) {
+        fprintf(stderr, "ERROR: cannot map shared memory '%s': %s\n", name, strerror(errno));
+        shm_unlink(name);
+        free(shm);
+        return NULL;
+    }
+
+    // start from a clean slate (a stale segment may hold an old layout or a leftover override)
+    memset(shm->st, 0, sizeof *shm->st);
+    shm->st->magic = SHM8_MAGIC;
+    shm->st->version = SHM8_VERSION;
+    return shm;
+}
+
+void shm8_publish(struct shm8 *shm, const struct chip8_vm *vm, uint16_t keys, uint64_t vtick) {
+    struct shm8_state *st = shm->st;
+    uint32_t seq = atomic_load_explicit(&st->seq, memory_order_relaxed);
+
+    // seqlock write side: go odd, update, go even (readers that overlap will see the change and retry)
+    atomic_store_explicit(&st->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    st->frame++;
+    st->vtick = vtick;
+    st->cycles = vm->cycles;
+    st->pc = vm->pc;
+    st->I = vm->I;
+    st->sp = vm->sp;
+    st->delay_timer = vm->delay_timer;
+    st->sound_timer = vm->sound_timer;
+    memcpy(st->V, vm->V, sizeof st->V);
+    memcpy(st->stack, vm->stack, sizeof st->stack);
+    st->keys = keys;
+    for (int i = 0; i < RAM_SIZE; ++i) st->ram[i] = vm->ram[i];
+    memcpy(st->fb, vm->fb, sizeof st->fb);
+
+    atomic_store_explicit(&st->seq, seq + 2, memory_order_release);
+}
+
+bool shm8_input_override(struct shm8 *shm, uint16_t *keys) {
+    uint32_t in = atomic_load_explicit(&shm->st->input, memory_order_relaxed);
+    if (!(in & SHM8_INPUT_OVERRIDE)) return false;
+    *keys = in & 0xffff;
+    return true;
+}
+
+void shm8_close(struct shm8 *shm) {
+    if (!shm) return;
+    munmap(shm->st, sizeof *shm->st);
+    shm_unlink(shm->name);
+    free(shm);
+}
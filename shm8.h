@@ -0,0 +1,82 @@
+#ifndef _SHM8_H
+#define _SHM8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "chip8.h"
+
+// LIVE VM STATE IN POSIX SHARED MEMORY (SEQLOCK-PROTECTED)
+//--------------------------------------------------------------
+//
+// A host creates a segment with shm8_create("/name") and calls shm8_publish() once per
+// frame.  Any number of readers can shm_open("/name", O_RDONLY or O_RDWR) + mmap it and
+// read `struct shm8_state` in place, with no syscalls and without ever blocking the host:
+//
+//     uint32_t seq;
+//     do {
+//         seq = shm8_read_begin(st);
+//         ... copy out whatever fields you need ...
+//     } while (shm8_read_retry(st, seq));
+//
+// A bot can drive the keypad by storing SHM8_INPUT_OVERRIDE | keymask into `input`
+// (segment opened read/write); storing 0 hands the keypad back to the keyboard.
+
+#define SHM8_MAGIC 0x384d4853u    // "SHM8"
+#define SHM8_VERSION 1
+
+// bit in `input` that says "use the low 16 bits as the keypad state"
+#define SHM8_INPUT_OVERRIDE 0x80000000u
+
+struct shm8_state {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic uint32_t seq;       // even: stable; odd: the host is in the middle of an update
+    _Atomic uint32_t input;     // written by readers (see SHM8_INPUT_OVERRIDE)
+
+    // everything below is only meaningful between shm8_read_begin/shm8_read_retry
+    uint64_t frame;             // frames published so far
+    uint64_t vtick;
+    uint64_t cycles;
+    uint16_t pc, I, sp;
+    uint8_t delay_timer, sound_timer;
+    uint8_t V[16];
+    uint16_t stack[STACK_SLOTS];
+    uint16_t keys;              // keypad state the VM ran with
+    uint8_t ram[RAM_SIZE];
+    uint8_t fb[FB_ROWS][FB_COLS];
+};
+
+// reader side: start a consistent read (spins while the host is mid-update)
+static inline uint32_t shm8_read_begin(const struct shm8_state *st) {
+    uint32_t seq;
+    while ((seq = atomic_load_explicit((_Atomic uint32_t *)&st->seq, memory_order_acquire)) & 1) {
+        // (the host holds the "lock" for a few microseconds once per frame)
+    }
+    return seq;
+}
+
+// reader side: true if the fields read since shm8_read_begin may be torn (read them again)
+static inline bool shm8_read_retry(const struct shm8_state *st, uint32_t seq) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((_Atomic uint32_t *)&st->seq, memory_order_relaxed) != seq;
+}
+
+// opaque handle for the host side of a segment
+struct shm8;
+
+// create (or take over) shared-memory segment `name` (e.g., "/gui8") (NULL on error, with a message on stderr)
+struct shm8 *shm8_create(const char *name);
+
+// copy the VM's state into the segment (`keys` = keypad state it is running with)
+void shm8_publish(struct shm8 *shm, const struct chip8_vm *vm, uint16_t keys, uint64_t vtick);
+
+// has a reader taken over the keypad? (if so, `*keys` gets its keypad state)
+bool shm8_input_override(struct shm8 *shm, uint16_t *keys);
+
+// unmap and remove the segment (NULL is OK)
+void shm8_close(struct shm8 *shm);
+
+#endif
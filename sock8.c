@@ -0,0 +1,53 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "sock8.h"
+
+bool sock8_remove_stale(const char *path) {
+    struct stat st;
+    if (lstat(path, &st) != 0) {
+        if (errno == ENOENT) return true;
+        perror(path);
+        return false;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        fprintf(stderr, "ERROR: '%s' exists and is not a socket (not replacing it)\n", path);
+        return false;
+    }
+
+    // knock first: only a socket nobody listens on any more refuses the connection
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path) {
+        fprintf(stderr, "ERROR: socket path too long: '%s'\n", path);
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return false;
+    }
+    int rc = connect(fd, (struct sockaddr *)&addr, sizeof addr), err = errno;
+    close(fd);
+    if (rc != 0 && err == ENOENT) return true;     // (its owner removed it while we looked)
+    if (rc == 0 || err == EAGAIN) {
+        // (EAGAIN: a listener whose backlog is full, which is still a live one)
+        fprintf(stderr, "ERROR: '%s' is in use by another instance (not replacing it)\n", path);
+        return false;
+    }
+    if (err != ECONNREFUSED) {
+        fprintf(stderr, "ERROR: cannot probe '%s': %s (not replacing it)\n", path, strerror(err));
+        return false;
+    }
+    if (unlink(path) != 0) {
+        perror(path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef _SOCK8_H
+#define _SOCK8_H
+
+#include <stdbool.h>
+
+// LOCAL SOCKET PATH HOUSEKEEPING
+//--------------------------------------------------------------
+//
+// The host's unix-domain endpoints (the metrics exporter, the debugger) bind to a fixed path,
+// and a run that crashed leaves its socket file behind, which makes the next bind() fail.
+// sock8_remove_stale() clears such a leftover before binding, but only once it is sure
+// nobody answers on it: a path that still has a live listener (a second instance started
+// with the same GUI8_* setting) or that is not a socket at all is left alone.
+
+// remove the dead socket at `path`, if there is one (true if the path is now free to bind;
+// false, with a message, if it is in use or is something other than a socket)
+bool sock8_remove_stale(const char *path);
+
+#endif
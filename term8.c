@@ -0,0 +1,390 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+// we include the CHIP-8 VM API here
+#include "chip8.h"
+#include "romdb.h"  // (and the per-ROM settings database)
+#include "movie.h"  // (and the gameplay movie recorder)
+
+// ------------- PREPROCESSOR DEFINES & MACROS --------------
+// ----------------------------------------------------------
+
+// makefile-overridable default-CPF target (same meaning as gui8's)
+#ifndef TERM8_DEFAULT_TARGET_CPF
+#define TERM8_DEFAULT_TARGET_CPF 1000
+#endif
+
+// makefile-overridable path of the per-ROM settings database (can also be set with the env var GUI8_ROMDB)
+#ifndef TERM8_ROMDB
+#define TERM8_ROMDB "chip8.romdb"
+#endif
+
+// environment variable naming a file to record a gameplay movie into (no recording if unset; same as gui8's)
+#define TERM8_RECORD_ENV "GUI8_RECORD"
+
+// how long a keypad key stays down after its key arrives on stdin
+// (terminals only send presses, so a held key is one that keeps auto-repeating;
+// this has to bridge the gap between repeats, not the initial repeat delay)
+#ifndef TERM8_KEY_HOLD_US
+#define TERM8_KEY_HOLD_US 150000
+#endif
+
+// how long a lone Esc waits for the rest of an escape sequence before it counts as Esc (quit)
+// (arrow keys and Alt+key arrive as ESC plus more bytes, which a slow link may deliver separately)
+#ifndef TERM8_ESC_WAIT_US
+#define TERM8_ESC_WAIT_US 50000
+#endif
+
+// one 60Hz tick (we render once per tick, too) in microseconds
+#define TICK_US (1000000 / 60)
+
+// the terminal is 2 pixels tall per character cell: 64 columns x 16 rows
+#define CELL_ROWS (FB_ROWS / 2)
+#define STATUS_ROW (CELL_ROWS + 1)
+
+// escape sequences: alternate screen + hidden cursor on the way in, the reverse on the way out
+#define ENTER_SCREEN "\x1b[?1049h\x1b[?25l\x1b[2J"
+#define LEAVE_SCREEN "\x1b[?25h\x1b[?1049l"
+
+// -------------------- KEYBOARD SUBSYSTEM --------------------
+// ------------------------------------------------------------
+
+// the same QWERTY layout gui8 uses (see its keypad diagrams), keyed by the byte the terminal sends
+// (arrow keys arrive as ESC [ A-D and are translated to W/S/D/A before the lookup)
+static const struct keypad_char {
+    char ch;
+    uint16_t keymask;
+} keypad_chars[] = {
+    { '1', 1 << 1 },  { '2', 1 << 2 },  { '3', 1 << 3 },  { '4', 1 << 12 },
+    { 'q', 1 << 4 },  { 'w', 1 << 5 },  { 'e', 1 << 6 },  { 'r', 1 << 13 },
+    { 'a', 1 << 7 },  { 's', 1 << 8 },  { 'd', 1 << 9 },  { 'f', 1 << 14 },
+    { 'z', 1 << 10 }, { 'x', 1 << 0 },  { 'c', 1 << 11 }, { 'v', 1 << 15 },
+    { ' ', 1 << 6 },
+    { 0, 0 },   // end of the list
+};
+
+// helper to return the current time in microseconds (monotonic)
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// helper to note a keypad key as held until `until`
+static void press(uint64_t held_until[16], char ch, uint64_t until) {
+    if (ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+    for (const struct keypad_char *kc = keypad_chars; kc->ch; ++kc) {
+        if (kc->ch != ch) continue;
+        for (int k = 0; k < 16; ++k) {
+            if (kc->keymask & (1 << k)) held_until[k] = until;
+        }
+    }
+}
+
+// an escape sequence read so far (it may be split across reads)
+struct escape {
+    unsigned char seq[16];
+    int len;            // (0 = not in one)
+    uint64_t since;     // when its ESC arrived
+};
+
+// helper to feed one byte to the escape sequence in progress; returns false if the user asked to quit
+// (ESC [ or ESC O, any parameters, then A-D are the arrow keys; ESC plus any other key is Alt+key,
+// which counts as the key; other sequences are ignored)
+static bool escape_byte(struct escape *esc, uint64_t held_until[16], unsigned char ch, uint64_t now) {
+    static const char arrows[4] = { 'w', 's', 'd', 'a' };   // (up, down, right, left)
+    if (esc->len == 1) {
+        if (ch == '[' || ch == 'O') {
+            esc->seq[esc->len++] = ch;
+        } else {
+            esc->len = 0;
+            if (ch == 0x1b || ch == 0x03) return false;   // (Esc Esc, Esc Ctrl-C)
+            press(held_until, ch, now + TERM8_KEY_HOLD_US);
+        }
+    } else if (ch >= 0x40 && ch <= 0x7e) {
+        // (the final byte)
+        if (ch >= 'A' && ch <= 'D') press(held_until, arrows[ch - 'A'], now + TERM8_KEY_HOLD_US);
+        esc->len = 0;
+    } else if (esc->len < (int)sizeof esc->seq && esc->seq[1] == '[') {
+        esc->seq[esc->len++] = ch;
+    } else {
+        esc->len = 0;   // (malformed or too long: drop it)
+    }
+    return true;
+}
+
+// helper to drain whatever stdin has for us (never blocks); returns false if the user asked to quit
+// (Esc on its own, once nothing followed it for TERM8_ESC_WAIT_US, or Ctrl-C)
+static bool read_keys(struct escape *esc, uint64_t held_until[16], uint64_t now) {
+    unsigned char buf[64];
+    ssize_t len;
+    while ((len = read(STDIN_FILENO, buf, sizeof buf)) > 0) {
+        for (ssize_t i = 0; i < len; ++i) {
+            if (esc->len) {
+                if (!escape_byte(esc, held_until, buf[i], now)) return false;
+            } else if (buf[i] == 0x03) {
+                return false;
+            } else if (buf[i] == 0x1b) {
+                esc->seq[0] = buf[i];
+                esc->len = 1;
+                esc->since = now;
+            } else {
+                press(held_until, buf[i], now + TERM8_KEY_HOLD_US);
+            }
+        }
+    }
+    if (esc->len && now - esc->since >= TERM8_ESC_WAIT_US) {
+        if (esc->len == 1) return false;
+        esc->len = 0;   // (the rest of a sequence never came: drop it)
+    }
+    return true;
+}
+
+// helper to turn the hold deadlines into a keypad state
+static uint16_t keypad_state(const uint64_t held_until[16], uint64_t now) {
+    uint16_t keys = 0;
+    for (int k = 0; k < 16; ++k) {
+        if (held_until[k] > now) keys |= 1 << k;
+    }
+    return keys;
+}
+
+// -------------------- GRAPHICS SUBSYSTEM --------------------
+// ------------------------------------------------------------
+
+// what each cell shows: bit 0 = top pixel, bit 1 = bottom pixel (UTF-8 half blocks)
+static const char *const cell_glyphs[4] = { " ", "\xe2\x96\x80", "\xe2\x96\x84", "\xe2\x96\x88" };
+
+// what the terminal currently shows (0xff = unknown, so the first frame draws every cell)
+struct screen {
+    uint8_t cells[CELL_ROWS][FB_COLS];
+    char out[CELL_ROWS * FB_COLS * 12 + 64];    // (worst case: a cursor move + glyph per cell)
+};
+
+// helper to emit the cells that changed since the last frame, as one write()
+// (a cursor move is only needed where a run of changed cells starts); returns the bytes written
+static size_t render_diff(struct screen *scr, const struct chip8_vm *vm) {
+    size_t len = 0;
+    for (int row = 0; row < CELL_ROWS; ++row) {
+        int next_col = -1;  // column the cursor is at, if it is on this row right after our last glyph
+        for (int col = 0; col < FB_COLS; ++col) {
+            uint8_t cell = (vm->fb[2 * row][col] & 1) | ((vm->fb[2 * row + 1][col] & 1) << 1);
+            if (cell == scr->cells[row][col]) continue;
+            scr->cells[row][col] = cell;
+            if (col != next_col) len += sprintf(scr->out + len, "\x1b[%d;%dH", row + 1, col + 1);
+            len += sprintf(scr->out + len, "%s", cell_glyphs[cell]);
+            next_col = col + 1;
+        }
+    }
+    if (len && write(STDOUT_FILENO, scr->out, len) < 0) return 0;
+    return len;
+}
+
+// helper to (over)write the status line below the display
+static size_t render_status(const char *text) {
+    char line[160];
+    int len = snprintf(line, sizeof line, "\x1b[%d;1H%s\x1b[K", STATUS_ROW, text);
+    if (write(STDOUT_FILENO, line, len) < 0) return 0;
+    return len;
+}
+
+
+// -------------------- TERMINAL SUBSYSTEM --------------------
+// ------------------------------------------------------------
+
+// the terminal settings to go back to (valid while `term_raw` is set)
+static struct termios saved_tio;
+static volatile sig_atomic_t term_raw;
+
+// helper to leave the alternate screen and restore the terminal settings (once; async-signal-safe,
+// so it can run from the signal handler below as well as on the way out of main or from exit())
+static bool restore_terminal(void) {
+    if (!term_raw) return true;
+    term_raw = 0;
+    bool ok = write(STDOUT_FILENO, LEAVE_SCREEN, sizeof LEAVE_SCREEN - 1) >= 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_tio);
+    return ok;
+}
+
+static void restore_terminal_atexit(void) {
+    restore_terminal();
+}
+
+// signal handler for hangups (e.g., a dropped SSH connection) and kill requests: put the terminal
+// back, then die of the signal the way we would have without the handler
+static void on_fatal_signal(int sig) {
+    restore_terminal();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+
+// ------------------------- MAIN PROGRAM LOGIC ------------------------
+// ---------------------------------------------------------------------
+
+// entry point that puts the terminal in raw mode and drives the CHIP-8 fetch/decode/execute cycle
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    char progbuf[RAM_SIZE];
+    static struct chip8_vm vm;
+    static struct screen scr;
+    FILE *romfile = NULL;
+    int target_cpf = TERM8_DEFAULT_TARGET_CPF;
+    bool cpf_from_cli = false;
+    struct romdb *romdb = NULL;
+    struct movie_writer *movie = NULL;
+    uint16_t idle_pc = 0;   // PC of the ROM's busy-wait loop (from the database; 0 if unknown)
+    struct termios raw_tio;
+    char error[96] = "";    // (reported once the terminal is back to normal)
+
+    // if we have no ROM file name as a CLI arg, print a usage message and quit
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s ROM_FILE [TARGET_CPF]\n"
+                        "  keys as in gui8 (1234/QWER/ASDF/ZXCV, arrows, space); Esc or Ctrl-C quits\n"
+                        "  " TERM8_RECORD_ENV "=FILE records a gameplay movie (see movie8)\n", argv[0]);
+        goto cleanup;
+    }
+    if (argc > 2) {
+        target_cpf = atoi(argv[2]);
+        cpf_from_cli = true;
+    }
+
+    // open the ROM file (for binary reading) and read up to (sizeof progbuf) bytes into `progbuf`
+    if ((romfile = fopen(argv[1], "rb")) == NULL) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", argv[1]);
+        goto cleanup;
+    }
+    size_t proglen = fread(progbuf, sizeof(char), sizeof progbuf, romfile);
+
+    // load the CHIP-8 VM with the desired program
+    if (!chip8_load(&vm, (uint8_t *)progbuf, proglen)) {
+        fprintf(stderr, "ERROR: cannot load program\n");
+        goto cleanup;
+    }
+
+    // look the ROM up in the settings database (if we have one) to pick its quirks and speed
+    const char *romdb_path = getenv("GUI8_ROMDB");
+    if ((romdb = romdb_open(romdb_path ? romdb_path : TERM8_ROMDB)) != NULL) {
+        const struct romdb_entry *rome = romdb_lookup(romdb, romdb_hash_rom((uint8_t *)progbuf, proglen));
+        if (rome) {
+            chip8_set_quirks(&vm, rome->quirks);
+            if (rome->cpf && !cpf_from_cli) target_cpf = rome->cpf;
+            idle_pc = rome->idle_pc;
+        }
+    }
+    if (target_cpf <= 0) {
+        // (gui8 treats 0 as "as fast as possible", which a 60Hz batch loop can't do)
+        fprintf(stderr, "ERROR: TARGET_CPF must be positive\n");
+        goto cleanup;
+    }
+
+    // start recording a movie, if asked to
+    const char *movie_path = getenv(TERM8_RECORD_ENV);
+    if (movie_path && (movie = movie_create(movie_path, romdb_hash_rom((uint8_t *)progbuf, proglen), vm.quirks)) == NULL) {
+        fprintf(stderr, "ERROR: cannot create movie '%s'\n", movie_path);
+        goto cleanup;
+    }
+
+    // raw, non-blocking keyboard input: no line buffering, no echo, no signals from Ctrl-C
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_tio) != 0) {
+        fprintf(stderr, "ERROR: stdin is not a terminal\n");
+        goto cleanup;
+    }
+    // (and put it back however we go: returning, exit(), or a hangup/kill signal)
+    static const int fatal_signals[] = { SIGHUP, SIGTERM, SIGINT, SIGQUIT };
+    struct sigaction sa = { .sa_handler = on_fatal_signal };
+    sigemptyset(&sa.sa_mask);
+    for (size_t i = 0; i < sizeof fatal_signals / sizeof fatal_signals[0]; ++i) {
+        sigaction(fatal_signals[i], &sa, NULL);
+    }
+    atexit(restore_terminal_atexit);
+    raw_tio = saved_tio;
+    raw_tio.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+    raw_tio.c_iflag &= ~(IXON | ICRNL);
+    raw_tio.c_cc[VMIN] = 0;
+    raw_tio.c_cc[VTIME] = 0;
+    term_raw = 1;   // (before the switch, so a signal arriving right after it still switches back)
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw_tio) != 0) {
+        fprintf(stderr, "ERROR: cannot put the terminal in raw mode\n");
+        goto cleanup;
+    }
+    if (write(STDOUT_FILENO, ENTER_SCREEN, sizeof ENTER_SCREEN - 1) < 0) goto cleanup;
+    memset(scr.cells, 0xff, sizeof scr.cells);
+
+    // THE MAIN LOOP: once per 60Hz tick, pick up keys, run one virtual frame's worth of cycles as a
+    // batch (cut short if the ROM reaches its known busy-wait loop), draw what changed, then sleep in
+    // poll() until the next tick is due (a key press wakes us early, but only to read it)
+    uint64_t held_until[16] = { 0 };
+    struct escape esc = { .len = 0 };
+    uint64_t next_tick = now_us(), sec_start = next_tick;
+    size_t vtick = 0;
+    int frames = 0, cycles = 0;
+    size_t bytes = 0;
+    bool sound_on = false, was_sound_on = false;
+    for (;;) {
+        uint64_t now = now_us();
+        if (now < next_tick) {
+            struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+            poll(&pfd, 1, (int)((next_tick - now + 999) / 1000));
+            if (!read_keys(&esc, held_until, now_us())) break;
+            continue;
+        }
+        // (if we fell more than a tick behind, e.g., the process was stopped, don't try to catch up)
+        next_tick = (now - next_tick > TICK_US) ? now + TICK_US : next_tick + TICK_US;
+
+        if (!read_keys(&esc, held_until, now)) break;
+        uint16_t keys = keypad_state(held_until, now);
+        ++vtick;
+        if (movie) movie_input(movie, chip8_get_cycles(&vm), keys, vtick);
+
+        for (int n = 0; n < target_cpf; ++n) {
+            uint16_t old_pc = chip8_get_pc(&vm);
+            if (!chip8_cycle(&vm, keys, vtick, &sound_on)) {
+                snprintf(error, sizeof error, "ERROR: illegal instruction @ PC=0x%04x (instruction=0x%02x%02x)",
+                         old_pc, chip8_get_ram(&vm, old_pc), chip8_get_ram(&vm, old_pc + 1));
+                goto cleanup;
+            }
+            ++cycles;
+            if (idle_pc && chip8_get_pc(&vm) == idle_pc) break;
+        }
+
+        // (the terminal bell is the closest thing to a beeper we have: ring it when the sound starts)
+        if (sound_on && !was_sound_on && write(STDOUT_FILENO, "\a", 1) == 1) ++bytes;
+        was_sound_on = sound_on;
+
+        bytes += render_diff(&scr, &vm);
+        ++frames;
+        if (movie && !movie_write_frame(movie, chip8_get_cycles(&vm), &vm.fb[0][0], sound_on)) {
+            snprintf(error, sizeof error, "ERROR: cannot write movie frame");
+            goto cleanup;
+        }
+
+        // once per second, show the FPS/CPF counters and what the display is costing us over the wire
+        if (now - sec_start >= 1000000) {
+            char status[96];
+            snprintf(status, sizeof status, "CHIP-8 (FPS=%d, CPF=%d, %.1f KB/s)  Esc quits",
+                     frames, cycles / (frames ? frames : 1), bytes / 1024.0);
+            bytes = render_status(status);  // (the status line counts toward the next second)
+            frames = cycles = 0;
+            sec_start = now;
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+cleanup:
+    if (!restore_terminal()) ret = EXIT_FAILURE;
+    if (error[0]) fprintf(stderr, "%s\n", error);
+    if (!movie_finish(movie)) fprintf(stderr, "ERROR: movie file may be incomplete\n");
+    if (romfile) fclose(romfile);
+    romdb_close(romdb);
+    return ret;
+}
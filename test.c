@@ -1,8 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "chip8.h"
+#include "movie.h"
+#include "trace.h"
 
 
 // how wide should the "Test XX (blah blah).......OK/FAIL" lines be (up to/not including the "OK/FAIL")
@@ -44,7 +48,7 @@
 } while(0);
 
 // helper to print each major test's number/description/padded line of "."s
-void test_banner(int n, char *desc) {
+void test_banner(int n, const char *desc) {
     int width = printf("Test %d (%s)", n, desc);
     while (width++ < TEST_BANNER_WIDTH) {
         putchar('.');
@@ -376,23 +380,543 @@ cleanup:
     return ret;
 }
 
-// test suite entry point (no CLI args, just run all the tests until completion or first failure)
-int main() {
-    int ret = EXIT_FAILURE;
+// CHIP-8 program ROM for test4
+uint8_t test_prog4[] = {
+/* 0x200 */ I(0xC0FF), // V0 = random & 0xFF
+/* 0x202 */ I(0xC10F), // V1 = random & 0x0F
+/* 0x204 */ I(0x1200), // jump back to the top (keep drawing numbers)
+};
+
+// per-VM random number generator (Cxnn) masking, determinism and seeding tests
+bool test4() {
+    bool ret = false;
+    struct chip8_vm vm, vm2;
+    uint16_t keys = 0u;
+    size_t vticks = 0;
+    bool sound = false;
+    uint8_t seq[64];
+    bool differs = false;
 
-    test_banner(0, "compiling, linking and running");
-    puts("OK"); // implied by getting to this point
+    if (!chip8_load(&vm, test_prog4, sizeof test_prog4)) {
+        FAIL("chip8_load can't load test_prog4");
+    }
 
-    test_banner(1, "control flow, load/store, basic register ops");
-    if (test1()) { puts("OK"); } else { goto cleanup; }
-    
-    test_banner(2, "core ALU [8XY?] operations with carry flag [VF]");
-    if (test2()) { puts("OK"); } else { goto cleanup; }
+    // record a sequence of random bytes (and check that Cxnn honors its mask)
+    for (int i = 0; i < 64; ++i) {
+        CYCLE_PC(0x202);
+        seq[i] = chip8_get_vr(&vm, 0);
+        CYCLE_PC(0x204);
+        if (chip8_get_vr(&vm, 1) > 0x0F) FAILF("C10F produced 0x%02x (not masked)", chip8_get_vr(&vm, 1));
+        CYCLE_PC(0x200);
+    }
+
+    // a freshly loaded VM must replay exactly the same sequence...
+    vm2 = vm;
+    if (!chip8_load(&vm, test_prog4, sizeof test_prog4)) {
+        FAIL("chip8_load can't reload test_prog4");
+    }
+    for (int i = 0; i < 64; ++i) {
+        CYCLE_PC(0x202);
+        if (chip8_get_vr(&vm, 0) != seq[i]) FAILF("reload diverged at draw #%d", i);
+        CYCLE_PC(0x204);
+        CYCLE_PC(0x200);
+    }
+
+    // ...and so must a copy of a running VM (the generator state travels with the struct)
+    vm = vm2;
+    for (int i = 0; i < 16; ++i) {
+        chip8_cycle(&vm2, keys, vticks, &sound);
+        CYCLE_VX(0, chip8_get_vr(&vm2, 0));
+    }
+
+    // while a different seed gives a different sequence
+    chip8_load(&vm, test_prog4, sizeof test_prog4);
+    chip8_seed(&vm, 42);
+    for (int i = 0; i < 64; ++i) {
+        CYCLE_PC(0x202);
+        differs |= (chip8_get_vr(&vm, 0) != seq[i]);
+        CYCLE_PC(0x204);
+        CYCLE_PC(0x200);
+    }
+    if (!differs) FAIL("chip8_seed(42) did not change the random sequence");
+
+    ret = true;
+cleanup:
+    return ret;
+}
+
+// CHIP-8 program ROM for test5
+uint8_t test_prog5[] = {
+/* 0x200 */ I(0x8011), // V0 |= V1 (VF cleared only with CHIP8_QUIRK_VF_RESET)
+/* 0x202 */ I(0xA300), // I = 0x300
+/* 0x204 */ I(0xF155), // store V0-V1 into RAM[I..I+1] (I += 2 only with CHIP8_QUIRK_MEMORY_I)
+};
+
+// interpreter quirk selection tests
+bool test5() {
+    bool ret = false;
+    struct chip8_vm vm;
+    uint16_t keys = 0u;
+    size_t vticks = 0;
+    bool sound = false;
+
+    if (!chip8_load(&vm, test_prog5, sizeof test_prog5)) {
+        FAIL("chip8_load can't load test_prog5");
+    }
+    chip8_set_quirks(&vm, 0);
+    chip8_set_vr(&vm, 15, 1);
+    CYCLE_PC(0x202);
+    ASSERT_VX(15, 1);
+    CYCLE_I(0x300);
+    CYCLE_I(0x300);
+
+    if (!chip8_load(&vm, test_prog5, sizeof test_prog5)) {
+        FAIL("chip8_load can't reload test_prog5");
+    }
+    chip8_set_vr(&vm, 15, 1);
+    CYCLE_PC(0x202);
+    ASSERT_VX(15, 0);
+    CYCLE_I(0x300);
+    CYCLE_I(0x302);
+
+    ret = true;
+cleanup:
+    return ret;
+}
+
+// CHIP-8 program ROM for test6
+uint8_t test_prog6[] = {
+/* 0x200 */ I(0xA300), // I = 0x300
+/* 0x202 */ I(0xF255), // store V0-V2 into RAM[0x300..0x302] (writes a watched address)
+/* 0x204 */ I(0xA300), // I = 0x300
+/* 0x206 */ I(0xF065), // V0 = RAM[0x300] (reads a watched address)
+/* 0x208 */ I(0xA400), // I = 0x400
+/* 0x20A */ I(0xF055), // RAM[0x400] = V0 (unwatched)
+/* 0x20C */ I(0xAFFF), // I = 0xFFF
+/* 0x20E */ I(0xF155), // RAM[0xFFF] = V0, RAM[0x000] = V1 (wraps around to a watched address)
+};
+
+// watchpoint handler for test6: remember the last hit and count them all
+static struct chip8_watch_hit test6_hit;
+static int test6_hits;
+static void test6_handler(void *ctx, const struct chip8_watch_hit *hit) {
+    (void)ctx;
+    test6_hit = *hit;
+    ++test6_hits;
+}
+
+// memory watchpoint tests
+bool test6() {
+    bool ret = false;
+    struct chip8_vm vm;
+    struct chip8_watchset ws = { .handler = test6_handler };
+    uint16_t keys = 0u;
+    size_t vticks = 0;
+    bool sound = false;
+
+    if (!chip8_load(&vm, test_prog6, sizeof test_prog6)) {
+        FAIL("chip8_load can't load test_prog6");
+    }
+    chip8_attach_watches(&vm, &ws);
+    chip8_watch_range(&vm, 0x301, 1, CHIP8_WATCH_WRITE, true);
+    chip8_watch_range(&vm, 0x300, 1, CHIP8_WATCH_READ, true);
+    chip8_set_vr(&vm, 0, 0x11);
+    chip8_set_vr(&vm, 1, 0x22);
+    chip8_set_vr(&vm, 2, 0x33);
+    chip8_set_ram(&vm, 0x301, 0x99);
+
+    CYCLE_I(0x300);
+    CYCLE_PC(0x204);
+    if (test6_hits != 1) FAILF("expected 1 write hit (got %d)", test6_hits);
+    if (!test6_hit.write || test6_hit.pc != 0x202 || test6_hit.addr != 0x301 ||
+            test6_hit.old_val != 0x99 || test6_hit.new_val != 0x22) {
+        FAILF("bad write hit (pc=0x%03x addr=0x%03x old=0x%02x new=0x%02x)",
+                test6_hit.pc, test6_hit.addr, test6_hit.old_val, test6_hit.new_val);
+    }
+
+    CYCLE_I(0x300);
+    CYCLE_VX(0, 0x11);
+    if (test6_hits != 2) FAILF("expected a read hit (got %d hits)", test6_hits);
+    if (test6_hit.write || test6_hit.pc != 0x206 || test6_hit.addr != 0x300) FAIL("bad read hit");
+
+    CYCLE_I(0x400);
+    CYCLE_PC(0x20C);
+    if (test6_hits != 2) FAIL("unwatched store reported a hit");
+
+    // a store running off the end of RAM wraps around (and reports the address it really wrote)
+    chip8_watch_range(&vm, 0x000, 1, CHIP8_WATCH_WRITE, true);
+    uint8_t old0 = chip8_get_ram(&vm, 0x000);
+    CYCLE_I(0xFFF);
+    CYCLE_PC(0x210);
+    ASSERT_RAMB(0xFFF, 0x11);
+    ASSERT_RAMB(0x000, 0x22);
+    ASSERT_VX(0, 0x11);
+    ASSERT_VX(1, 0x22);
+    if (test6_hits != 3 || test6_hit.addr != 0x000 || test6_hit.old_val != old0 || test6_hit.new_val != 0x22) {
+        FAILF("bad wrapped write hit (%d hits, addr=0x%03x old=0x%02x new=0x%02x)",
+                test6_hits, test6_hit.addr, test6_hit.old_val, test6_hit.new_val);
+    }
+    chip8_watch_range(&vm, 0x000, 1, CHIP8_WATCH_WRITE, false);
+
+    // unwatching clears the page bits again
+    chip8_watch_range(&vm, 0x300, 2, CHIP8_WATCH_READ | CHIP8_WATCH_WRITE, false);
+    if (vm.watch_rpages || vm.watch_wpages) FAIL("page bits still set after unwatching everything");
+
+    ret = true;
+cleanup:
+    return ret;
+}
+
+// CHIP-8 program ROM for test7
+uint8_t test_prog7[] = {
+/* 0x200 */ I(0x6005), // V0 = 5
+/* 0x202 */ I(0x7001), // V0 += 1
+/* 0x204 */ I(0x1202), // loop back to 0x202
+};
+
+// VM state fingerprint tests
+bool test7() {
+    bool ret = false;
+    struct chip8_vm vm, clone;
+    struct chip8_watchset ws = { 0 };
+    uint16_t keys = 0u;
+    size_t vticks = 0;
+    bool sound = false;
+
+    if (!chip8_load(&vm, test_prog7, sizeof test_prog7)) {
+        FAIL("chip8_load can't load test_prog7");
+    }
+    uint64_t h0 = chip8_state_hash(&vm);
+    clone = vm;
+    if (chip8_state_hash(&clone) != h0) FAIL("a copied VM hashes differently");
+
+    // every part of the emulated state counts...
+    CYCLE_VX(0, 5);
+    uint64_t h1 = chip8_state_hash(&vm);
+    if (h1 == h0) FAIL("hash ignores a register/PC change");
+    clone = vm;
+    chip8_set_ram(&clone, 0xFFF, 1);
+    if (chip8_state_hash(&clone) == h1) FAIL("hash ignores RAM");
+    chip8_set_ram(&clone, 0xFFF, 0);
+    if (chip8_state_hash(&clone) != h1) FAIL("hash differs after undoing a RAM write");
+    clone = vm;
+    chip8_seed(&clone, 1);
+    if (chip8_state_hash(&clone) == h1) FAIL("hash ignores the RNG state");
+
+    // ...but not how we got there or what's attached
+    clone = vm;
+    clone.cycles += 100;
+    chip8_attach_watches(&clone, &ws);
+    if (chip8_state_hash(&clone) != h1) FAIL("hash depends on the cycle count or watchpoints");
+
+    ret = true;
+cleanup:
+    return ret;
+}
+
+// CHIP-8 program ROM for test8
+uint8_t test_prog8[] = {
+/* 0x200 */ I(0xA20C), // I = 0x20C (the sprite below)
+/* 0x202 */ I(0xD012), // draw it at (V0, V1)
+/* 0x204 */ I(0xD012), // and again (erasing it: VF = 1)
+/* 0x206 */ I(0xF055), // RAM[0x20C] = V0 (rewrites the sprite's first row)
+/* 0x208 */ I(0xA20C), // I = 0x20C
+/* 0x20A */ I(0xD012), // draw it again (must see the new row, not a stale cached one)
+/* 0x20C */ 0xC3, 0x81, // sprite: ##....## / #......#
+};
+
+// helper to count the lit pixels in a VM's framebuffer
+static int lit_pixels(const struct chip8_vm *vm) {
+    int n = 0;
+    for (int y = 0; y < FB_ROWS; ++y) {
+        for (int x = 0; x < FB_COLS; ++x) n += vm->fb[y][x];
+    }
+    return n;
+}
+
+// sprite drawing (DXYN: wrapping, clipping, collisions) and sprite cache invalidation tests
+bool test8() {
+    bool ret = false;
+    struct chip8_vm vm;
+    uint16_t keys = 0u;
+    size_t vticks = 0;
+    bool sound = false;
+
+    if (!chip8_load(&vm, test_prog8, sizeof test_prog8)) {
+        FAIL("chip8_load can't load test_prog8");
+    }
+    // (pre-shift the sprite the way a static analysis would: the store below has to drop that entry too)
+    chip8_prewarm_sprite(&vm, 0x20C, 2);
+    uint64_t blank = vm.fb_hash;
+    chip8_set_vr(&vm, 0, 124);  // (column 60, once wrapped)
+    chip8_set_vr(&vm, 1, 62);   // (row 30, once wrapped)
+
+    // the sprite's start wraps around, the rest of it is clipped at the right and bottom edges
+    CYCLE_I(0x20C);
+    CYCLE_VX(15, 0);
+    if (!vm.fb[30][60] || !vm.fb[30][61] || !vm.fb[31][60] || lit_pixels(&vm) != 3) {
+        FAILF("wrong pixels after the first draw (%d lit)", lit_pixels(&vm));
+    }
+    if (vm.fb_hash == blank) FAIL("framebuffer fingerprint didn't change");
+
+    // drawing it again erases it
+    CYCLE_VX(15, 1);
+    if (lit_pixels(&vm) != 0) FAILF("%d pixels still lit after erasing", lit_pixels(&vm));
+    if (vm.fb_hash != blank) FAIL("framebuffer fingerprint differs after erasing");
+
+    // a store into the (now cached) sprite must show up in the next draw: 124 = .#####..
+    CYCLE_I(0x20D);
+    CYCLE_I(0x20C);
+    CYCLE_VX(15, 0);
+    if (vm.fb[30][60] || !vm.fb[30][61] || !vm.fb[30][62] || !vm.fb[30][63] || !vm.fb[31][60] || lit_pixels(&vm) != 4) {
+        FAILF("stale sprite drawn after it was rewritten (%d lit)", lit_pixels(&vm));
+    }
+
+    ret = true;
+cleanup:
+    return ret;
+}
+
+// the frames test9 records: what each one looks like
+enum test9_pattern {
+    T9_BLANK,
+    T9_COLUMNS,     // pixels at columns 0, 16, 32 and 48 on every row (every packed byte its own RLE run)
+    T9_CHECKER,     // alternate pixels lit (every packed byte nonzero)
+    T9_FULL,        // every pixel lit
+    T9_NOISE,       // pseudo-random pixels
+};
 
-    test_banner(3, "timer, sound-state, and key status/press tests");
-    if (test3()) { puts("OK"); } else { goto cleanup; }
+// helper to draw one of test9's frames
+static void test9_draw(uint8_t fb[FB_ROWS][FB_COLS], enum test9_pattern pat, uint32_t *rng) {
+    for (int y = 0; y < FB_ROWS; ++y) {
+        for (int x = 0; x < FB_COLS; ++x) {
+            switch (pat) {
+            case T9_BLANK: fb[y][x] = 0; break;
+            case T9_COLUMNS: fb[y][x] = (x % 16) == 0; break;
+            case T9_CHECKER: fb[y][x] = (x + y) & 1; break;
+            case T9_FULL: fb[y][x] = 1; break;
+            case T9_NOISE:
+                *rng = *rng * 1103515245u + 12345u;
+                fb[y][x] = (*rng >> 16) & 1;
+                break;
+            }
+        }
+    }
+}
+
+// gameplay movie round trip: every frame (worst-case RLE rows included) and every logged input
+// must decode exactly as recorded
+bool test9() {
+    static const enum test9_pattern script[] = {
+        T9_COLUMNS, T9_COLUMNS, T9_BLANK, T9_COLUMNS, T9_CHECKER, T9_FULL, T9_NOISE, T9_NOISE, T9_BLANK, T9_CHECKER,
+    };
+    static uint8_t frames[sizeof script / sizeof script[0]][FB_ROWS][FB_COLS];
+    static struct movie_frame fr;
+    const int nframes = sizeof script / sizeof script[0];
+    bool ret = false;
+    struct movie_writer *mw = NULL;
+    struct movie_reader *mr = NULL;
+    char path[] = "/tmp/test8-movie-XXXXXX";
+    uint32_t rng = 1;
+    int fd = mkstemp(path);
+
+    // frame f runs cycles [100 * f, 100 * (f + 1)): vtick f + 1 and new keys from its 8th cycle on (set
+    // twice there, so only the second one counts), then more keys logged for the cycle right after it
+    if (fd < 0) FAIL("cannot create a temporary movie file");
+    close(fd);
+    if ((mw = movie_create(path, 0x1234, CHIP8_QUIRK_MEMORY_I)) == NULL) FAIL("movie_create failed");
+    for (int f = 0; f < nframes; ++f) {
+        uint64_t end = 100 * (f + 1);
+        movie_input(mw, end - 93, 0x100 + f, f + 1);
+        movie_input(mw, end - 93, 0x200 + f, f + 1);
+        movie_input(mw, end, 0xf000 | f, f + 1);
+        test9_draw(frames[f], script[f], &rng);
+        if (!movie_write_frame(mw, end, &frames[f][0][0], f & 1)) FAILF("movie_write_frame failed at frame %d", f);
+    }
+    bool finished = movie_finish(mw);
+    mw = NULL;
+    if (!finished) FAIL("movie_finish failed");
+
+    if ((mr = movie_open(path)) == NULL) FAIL("movie_open can't read the movie back");
+    if (movie_rom_hash(mr) != 0x1234 || movie_quirks(mr) != CHIP8_QUIRK_MEMORY_I) FAIL("wrong ROM hash or quirks");
+    for (int f = 0; f < nframes; ++f) {
+        if (!movie_read_frame(mr, &fr)) FAILF("movie ends early (frame %d)", f);
+        uint64_t end = 100 * (f + 1);
+        if (fr.number != (uint64_t)f || fr.cycle != end || fr.keys != (0xf000 | f) || fr.sound != (f & 1)) {
+            FAILF("frame %d: wrong number/cycle/keys/sound", f);
+        }
+        if (fr.ninputs != 2 || fr.inputs[0].cycle != end - 93 || fr.inputs[0].keys != 0x200 + f
+                || fr.inputs[0].vtick != (size_t)f + 1 || fr.inputs[1].cycle != end || fr.inputs[1].vtick != (size_t)f + 1) {
+            FAILF("frame %d: inputs decoded differently (%d of them)", f, fr.ninputs);
+        }
+        if (memcmp(fr.fb, frames[f], sizeof fr.fb) != 0) FAILF("frame %d: framebuffer decoded differently", f);
+    }
+    if (movie_read_frame(mr, &fr)) FAIL("movie has frames past the last one written");
+
+    ret = true;
+cleanup:
+    movie_finish(mw);
+    movie_close(mr);
+    if (fd >= 0) unlink(path);
+    return ret;
+}
+
+// CHIP-8 program ROM for test10
+uint8_t test_prog10[] = {
+/* 0x200 */ I(0x6005), // V0 = 0x05
+/* 0x202 */ I(0x61FF), // V1 = 0xFF
+/* 0x204 */ I(0x8014), // V0 += V1 (V0 = 0x04, carry into VF)
+/* 0x206 */ I(0x6300), // V3 = 0 (already is: nothing changes)
+/* 0x208 */ I(0xA300), // I = 0x300
+/* 0x20A */ I(0xF155), // RAM[0x300..0x301] = V0, V1
+/* 0x20C */ I(0x6009), // V0 = 0x09
+/* 0x20E */ I(0xA300), // I = 0x300
+/* 0x210 */ I(0xF165), // V0, V1 = RAM[0x300..0x301] (only V0 changes)
+/* 0x212 */ I(0x0000), // (illegal)
+};
+
+// what test10 expects each instruction to be traced as (pc, reg, reg_val, flags)
+static const struct chip8_trace_record test10_expect[] = {
+    { .pc = 0x200, .opcode = 0x6005, .reg = 0x0, .reg_val = 0x05, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x202, .opcode = 0x61FF, .reg = 0x1, .reg_val = 0xFF, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x204, .opcode = 0x8014, .reg = 0x0, .reg_val = 0x04, .flags = CHIP8_TRACE_REG | CHIP8_TRACE_VF },
+    { .pc = 0x206, .opcode = 0x6300 },
+    { .pc = 0x208, .opcode = 0xA300, .reg = CHIP8_TRACE_REG_I, .reg_val = 0x300, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x20A, .opcode = 0xF155, .reg = CHIP8_TRACE_REG_I, .reg_val = 0x302, .flags = CHIP8_TRACE_REG | CHIP8_TRACE_MEM,
+        .mem_addr = 0x300, .mem_val = 0x04, .mem_len = 2 },
+    { .pc = 0x20C, .opcode = 0x6009, .reg = 0x0, .reg_val = 0x09, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x20E, .opcode = 0xA300, .reg = CHIP8_TRACE_REG_I, .reg_val = 0x300, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x210, .opcode = 0xF165, .reg = 0x0, .reg_val = 0x04, .flags = CHIP8_TRACE_REG },
+    { .pc = 0x212, .opcode = 0x0000, .flags = CHIP8_TRACE_FAIL },
+};
+#define TEST10_RECORDS (int)(sizeof test10_expect / sizeof test10_expect[0])
+
+// tracer for test10 with room for only 3 records, handing each full buffer over into `test10_log`
+static struct chip8_trace_record test10_buf[3], test10_log[2 * TEST10_RECORDS];
+static int test10_logged, test10_flushes;
+static void test10_flush(struct chip8_tracer *t) {
+    for (uint32_t i = 0; i < t->len && test10_logged < 2 * TEST10_RECORDS; ++i) test10_log[test10_logged++] = t->buf[i];
+    t->len = 0;
+    ++test10_flushes;
+}
+
+// helper to run test_prog10 to its illegal instruction with tracer `t` attached (false if it stops early)
+static bool test10_run(struct chip8_tracer *t) {
+    struct chip8_vm vm;
+    bool sound = false;
+    if (!chip8_load(&vm, test_prog10, sizeof test_prog10)) return false;
+    chip8_attach_tracer(&vm, t);
+    for (int n = 0; n < TEST10_RECORDS - 1; ++n) {
+        if (!chip8_cycle(&vm, 0, 7, &sound)) return false;
+    }
+    return !chip8_cycle(&vm, 0, 7, &sound);
+}
+
+// helper to compare a traced record with the one test10 expects (false, with a message, if they differ)
+static bool test10_check(const struct chip8_trace_record *r, int n) {
+    const struct chip8_trace_record *e = &test10_expect[n];
+    if (r->vtick != 7 || r->pc != e->pc || r->opcode != e->opcode || r->flags != e->flags
+            || ((e->flags & CHIP8_TRACE_REG) && (r->reg != e->reg || r->reg_val != e->reg_val))
+            || ((e->flags & CHIP8_TRACE_MEM) && (r->mem_addr != e->mem_addr || r->mem_val != e->mem_val || r->mem_len != e->mem_len))) {
+        printf("FAIL\n\t%s:%d: record %d: pc=%03X op=%04X flags=%02X reg=%X val=%03X mem=%03X/%02X/%u\n", __FILE__, __LINE__,
+                n, r->pc, r->opcode, r->flags, r->reg, r->reg_val, r->mem_addr, r->mem_val, r->mem_len);
+        return false;
+    }
+    return true;
+}
 
-    ret = EXIT_SUCCESS;
+// instruction tracer: what each record says changed, and a trace file written by the background
+// writer must hold exactly those records
+bool test10() {
+    bool ret = false;
+    struct chip8_tracer t = { .buf = test10_buf, .cap = 3, .flush = test10_flush };
+    struct trace_writer *tw = NULL;
+    FILE *fp = NULL;
+    char path[] = "/tmp/test8-trace-XXXXXX";
+    int fd = mkstemp(path);
+
+    if (!test10_run(&t)) FAIL("test_prog10 didn't run up to (and fail on) its illegal instruction");
+    test10_flush(&t);
+    if (test10_flushes != TEST10_RECORDS / 3 + 1 || test10_logged != TEST10_RECORDS) {
+        FAILF("expected %d records in %d flushes (got %d in %d)", TEST10_RECORDS, TEST10_RECORDS / 3 + 1, test10_logged, test10_flushes);
+    }
+    for (int n = 0; n < TEST10_RECORDS; ++n) {
+        if (!test10_check(&test10_log[n], n)) goto cleanup;
+    }
+
+    // the same run through trace.c, into a file
+    if (fd < 0) FAIL("cannot create a temporary trace file");
+    close(fd);
+    if ((tw = trace_create(path, 0x1234)) == NULL) FAIL("trace_create failed");
+    if (!test10_run(trace_tracer(tw))) FAIL("test_prog10 ran differently with the trace writer attached");
+    if (trace_records(tw) != TEST10_RECORDS) FAILF("trace_records says %llu", (unsigned long long)trace_records(tw));
+    bool closed = trace_close(tw);
+    tw = NULL;
+    if (!closed) FAIL("trace_close failed");
+
+    uint8_t hdr[TRACE_HEADER_SIZE];
+    struct chip8_trace_record r;
+    if ((fp = fopen(path, "rb")) == NULL || fread(hdr, sizeof hdr, 1, fp) != 1) FAIL("cannot read the trace file back");
+    if (memcmp(hdr, TRACE_MAGIC, 8) != 0 || hdr[8] != sizeof r || hdr[16] != 0x34 || hdr[17] != 0x12) FAIL("bad trace file header");
+    for (int n = 0; n < TEST10_RECORDS; ++n) {
+        if (fread(&r, sizeof r, 1, fp) != 1) FAILF("trace file ends early (record %d)", n);
+        if (memcmp(&r, &test10_log[n], sizeof r) != 0) FAILF("record %d was written differently", n);
+    }
+    if (fread(&r, sizeof r, 1, fp) != 0) FAIL("trace file has records past the last one traced");
+
+    ret = true;
 cleanup:
+    trace_close(tw);
+    if (fp) fclose(fp);
+    if (fd >= 0) unlink(path);
     return ret;
 }
+
+// the test suite, in order
+static const struct {
+    bool (*run)(void);
+    const char *what;
+} tests[] = {
+    { NULL, "compiling, linking and running" },
+    { test1, "control flow, load/store, basic register ops" },
+    { test2, "core ALU [8XY?] operations with carry flag [VF]" },
+    { test3, "timer, sound-state, and key status/press tests" },
+    { test4, "per-VM random number generator [CXNN] and seeding" },
+    { test5, "interpreter quirk selection" },
+    { test6, "memory watchpoints" },
+    { test7, "VM state fingerprints" },
+    { test8, "sprite drawing [DXYN] and the sprite cache" },
+    { test9, "gameplay movie encode/decode round trip" },
+    { test10, "instruction tracer and trace files" },
+};
+#define NTESTS ((int)(sizeof tests / sizeof tests[0]))
+
+// test suite entry point: run every test (or just the ones numbered on the command line), report
+// each one, and fail if any of them did
+int main(int argc, char **argv) {
+    bool selected[NTESTS] = { false };
+    int failed = 0, ran = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        int n = atoi(argv[i]);
+        if (n < 0 || n >= NTESTS) {
+            fprintf(stderr, "usage: %s [TEST_NUMBER...] (0-%d)\n", argv[0], NTESTS - 1);
+            return EXIT_FAILURE;
+        }
+        selected[n] = true;
+    }
+
+    for (int n = 0; n < NTESTS; ++n) {
+        if (argc > 1 && !selected[n]) continue;
+        test_banner(n, tests[n].what);
+        ++ran;
+        if (!tests[n].run || tests[n].run()) {
+            puts("OK"); // (test 0 is implied by getting to this point)
+        } else {
+            ++failed;
+        }
+    }
+
+    printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+// some standard library/system headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "trace.h"
+
+// ring geometry: 16 chunks of 8192 records (2 MiB in all)
+#define CHUNK_RECORDS 8192
+#define NUM_CHUNKS 16
+
+_Static_assert(sizeof(struct chip8_trace_record) == 16, "trace records must stay 16 bytes (file format)");
+
+struct trace_writer {
+    struct chip8_tracer tracer;     // (first, so the flush callback can get back to us)
+    FILE *fp;
+    struct chip8_trace_record (*chunks)[CHUNK_RECORDS];
+    uint32_t lens[NUM_CHUNKS];
+    uint64_t filled;    // chunks handed to the writer thread so far (the VM fills chunk `filled % NUM_CHUNKS`)
+    uint64_t written;   // chunks the writer thread has finished with
+    uint64_t records;   // records in handed-over chunks
+    bool stopping;
+    bool failed;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work;    // signaled when a chunk is handed over (or we are stopping)
+    pthread_cond_t space;   // signaled when the writer thread frees a chunk
+    pthread_t thread;
+};
+
+// background thread: write out handed-over chunks in order
+static void *writer_thread(void *arg) {
+    struct trace_writer *tw = (struct trace_writer *)arg;
+    pthread_mutex_lock(&tw->lock);
+    for (;;) {
+        while (tw->written == tw->filled && !tw->stopping) pthread_cond_wait(&tw->work, &tw->lock);
+        if (tw->written == tw->filled) break;
+        int idx = tw->written % NUM_CHUNKS;
+        pthread_mutex_unlock(&tw->lock);
+
+        bool ok = fwrite(tw->chunks[idx], sizeof(struct chip8_trace_record), tw->lens[idx], tw->fp) == tw->lens[idx];
+
+        pthread_mutex_lock(&tw->lock);
+        if (!ok) tw->failed = true;
+        tw->written++;
+        pthread_cond_signal(&tw->space);
+    }
+    pthread_mutex_unlock(&tw->lock);
+    return NULL;
+}
+
+// helper to hand the current chunk over and move the VM on to the next one (waiting if none is free)
+static void submit_chunk(struct trace_writer *tw) {
+    pthread_mutex_lock(&tw->lock);
+    tw->lens[tw->filled % NUM_CHUNKS] = tw->tracer.len;
+    tw->records += tw->tracer.len;
+    tw->filled++;
+    pthread_cond_signal(&tw->work);
+    while (tw->filled - tw->written >= NUM_CHUNKS) pthread_cond_wait(&tw->space, &tw->lock);
+    pthread_mutex_unlock(&tw->lock);
+
+    tw->tracer.buf = tw->chunks[tw->filled % NUM_CHUNKS];
+    tw->tracer.len = 0;
+}
+
+// chip8_tracer flush callback (runs inside chip8_cycle once per CHUNK_RECORDS instructions)
+static void flush_cb(struct chip8_tracer *t) {
+    submit_chunk((struct trace_writer *)t);
+}
+
+struct trace_writer *trace_create(const char *path, uint64_t rom_hash) {
+    struct trace_writer *tw = calloc(1, sizeof *tw);
+    if (!tw) return NULL;
+    if ((tw->chunks = malloc(sizeof(*tw->chunks) * NUM_CHUNKS)) == NULL) {
+        free(tw);
+        return NULL;
+    }
+    if ((tw->fp = fopen(path, "wb")) == NULL) {
+        fprintf(stderr, "ERROR: cannot create trace file '%s'\n", path);
+        free(tw->chunks);
+        free(tw);
+        return NULL;
+    }
+
+    uint8_t hdr[TRACE_HEADER_SIZE] = { 0 };
+    memcpy(hdr, TRACE_MAGIC, 8);
+    hdr[8] = sizeof(struct chip8_trace_record);
+    for (int i = 0; i < 8; ++i) hdr[16 + i] = (rom_hash >> (8 * i)) & 0xff;
+    if (fwrite(hdr, sizeof hdr, 1, tw->fp) != 1) tw->failed = true;
+
+    tw->tracer.buf = tw->chunks[0];
+    tw->tracer.cap = CHUNK_RECORDS;
+    tw->tracer.flush = flush_cb;
+    pthread_mutex_init(&tw->lock, NULL);
+    pthread_cond_init(&tw->work, NULL);
+    pthread_cond_init(&tw->space, NULL);
+    if (pthread_create(&tw->thread, NULL, writer_thread, tw) != 0) {
+        fprintf(stderr, "ERROR: cannot start trace writer thread\n");
+        fclose(tw->fp);
+        free(tw->chunks);
+        free(tw);
+        return NULL;
+    }
+    return tw;
+}
+
+struct chip8_tracer *trace_tracer(struct trace_writer *tw) {
+    return &tw->tracer;
+}
+
+void trace_flush(struct trace_writer *tw) {
+    if (tw->tracer.len) submit_chunk(tw);
+}
+
+uint64_t trace_records(const struct trace_writer *tw) {
+    return tw->records + tw->tracer.len;
+}
+
+bool trace_close(struct trace_writer *tw) {
+    if (!tw) return true;
+    trace_flush(tw);
+
+    pthread_mutex_lock(&tw->lock);
+    tw->stopping = true;
+    pthread_cond_signal(&tw->work);
+    pthread_mutex_unlock(&tw->lock);
+    pthread_join(tw->thread, NULL);
+
+    bool ok = !tw->failed;
+    ok = (fclose(tw->fp) == 0) && ok;
+    pthread_mutex_destroy(&tw->lock);
+    pthread_cond_destroy(&tw->work);
+    pthread_cond_destroy(&tw->space);
+    free(tw->chunks);
+    free(tw);
+    return ok;
+}
@@ -0,0 +1,43 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+// INSTRUCTION TRACES STREAMED TO DISK BY A BACKGROUND WRITER THREAD
+//--------------------------------------------------------------
+//
+// File layout: header "C8TRACE1", u32 record size (16), u32 reserved, u64 rom_hash,
+// then back-to-back `struct chip8_trace_record`s (little-endian) until end of file.
+//
+// The VM appends records to one chunk of a ring of chunks; whenever a chunk fills up it is
+// handed to the writer thread and the VM moves on to the next free one.  The VM only ever
+// waits if the disk falls a whole ring behind, so traces are complete (never sampled).
+// Use trace8 to decode, filter and summarize them.
+
+#define TRACE_MAGIC "C8TRACE1"
+#define TRACE_HEADER_SIZE 24
+
+// opaque handle for a trace file being written
+struct trace_writer;
+
+// create trace file `path` (NULL on error, with a message on stderr)
+struct trace_writer *trace_create(const char *path, uint64_t rom_hash);
+
+// the tracer to pass to chip8_attach_tracer (tracing can be switched on/off any time)
+struct chip8_tracer *trace_tracer(struct trace_writer *tw);
+
+// hand whatever has been recorded so far to the writer thread (e.g., after switching tracing off)
+void trace_flush(struct trace_writer *tw);
+
+// number of records captured so far
+uint64_t trace_records(const struct trace_writer *tw);
+
+// flush, stop the writer thread and close the file (false if any write failed) (NULL is OK)
+// (detach the tracer from every VM first)
+bool trace_close(struct trace_writer *tw);
+
+#endif
@@ -0,0 +1,184 @@
+// some standard library/system headers
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+// we include the trace file format (and the analyzer's disassembler) here
+#include "trace.h"
+#include "analyze.h"
+
+// how many hot spots `stats` lists
+#define TOP_PCS 10
+
+// record filters for `dump` (all of the given ones must match)
+struct filter {
+    int pc;                 // -1 = any
+    uint16_t op_mask;       // opcode & op_mask == op_value (from a pattern like "Fx55")
+    uint16_t op_value;
+    bool writes_only;
+    uint64_t vtick_from, vtick_to;
+};
+
+// helper to turn an opcode pattern ("00EE", "8xy4", "Fx55", "D...") into a mask/value pair
+static bool parse_pattern(const char *pat, struct filter *f) {
+    if (strlen(pat) != 4) return false;
+    f->op_mask = f->op_value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int shift = 12 - 4 * i;
+        if (isxdigit((unsigned char)pat[i])) {
+            char digit[2] = { pat[i], 0 };
+            f->op_mask |= 0xF << shift;
+            f->op_value |= strtoul(digit, NULL, 16) << shift;
+        }
+    }
+    return true;
+}
+
+static bool matches(const struct filter *f, const struct chip8_trace_record *r) {
+    return (f->pc < 0 || r->pc == f->pc)
+        && (r->opcode & f->op_mask) == f->op_value
+        && (!f->writes_only || (r->flags & CHIP8_TRACE_MEM))
+        && r->vtick >= f->vtick_from && r->vtick <= f->vtick_to;
+}
+
+// helper to open a trace and check its header (NULL on error, with a message)
+static FILE *open_trace(const char *path, uint64_t *rom_hash) {
+    uint8_t hdr[TRACE_HEADER_SIZE];
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "ERROR: cannot open '%s'\n", path);
+        return NULL;
+    }
+    if (fread(hdr, sizeof hdr, 1, fp) != 1 || memcmp(hdr, TRACE_MAGIC, 8) != 0
+            || hdr[8] != sizeof(struct chip8_trace_record)) {
+        fprintf(stderr, "ERROR: '%s' is not a CHIP-8 trace\n", path);
+        fclose(fp);
+        return NULL;
+    }
+    *rom_hash = 0;
+    for (int i = 7; i >= 0; --i) *rom_hash = (*rom_hash << 8) | hdr[16 + i];
+    return fp;
+}
+
+// print every record that passes the filter, one per line
+static void trace_dump(FILE *fp, const struct filter *f) {
+    struct chip8_trace_record r;
+    uint64_t index = 0;
+    for (; fread(&r, sizeof r, 1, fp) == 1; ++index) {
+        if (!matches(f, &r)) continue;
+        char text[32], effect[64] = "";
+        chip8_disasm(r.opcode, text, sizeof text);
+        int len = 0;
+        if (r.flags & CHIP8_TRACE_REG) {
+            if (r.reg == CHIP8_TRACE_REG_I) len = snprintf(effect, sizeof effect, "I=%03X", r.reg_val);
+            else len = snprintf(effect, sizeof effect, "V%X=%02X", r.reg, r.reg_val);
+        }
+        if (r.flags & CHIP8_TRACE_VF) len += snprintf(effect + len, sizeof effect - len, " (VF)");
+        if (r.flags & CHIP8_TRACE_MEM) {
+            len += snprintf(effect + len, sizeof effect - len, "%s[%03X]=%02X", len ? " " : "", r.mem_addr, r.mem_val);
+            if (r.mem_len > 1) len += snprintf(effect + len, sizeof effect - len, " (+%d)", r.mem_len - 1);
+        }
+        if (r.flags & CHIP8_TRACE_FAIL) snprintf(effect + len, sizeof effect - len, "%sFAILED", len ? " " : "");
+        printf("%10llu  vt=%-8u %03X: %04X  %-16s %s\n", (unsigned long long)index, r.vtick, r.pc, r.opcode, text, effect);
+    }
+}
+
+// print a summary: counts, vtick range, instruction mix and hottest PCs
+static void trace_stats(FILE *fp, uint64_t rom_hash) {
+    static uint64_t pc_hits[RAM_SIZE];
+    uint64_t families[16] = { 0 }, total = 0, writes = 0, bytes_written = 0, fails = 0;
+    uint32_t first_vt = 0, last_vt = 0;
+    struct chip8_trace_record r;
+
+    while (fread(&r, sizeof r, 1, fp) == 1) {
+        if (!total) first_vt = r.vtick;
+        last_vt = r.vtick;
+        ++total;
+        ++families[r.opcode >> 12];
+        ++pc_hits[r.pc & (RAM_SIZE - 1)];
+        if (r.flags & CHIP8_TRACE_MEM) {
+            ++writes;
+            bytes_written += r.mem_len;
+        }
+        if (r.flags & CHIP8_TRACE_FAIL) ++fails;
+    }
+
+    printf("ROM hash:       %016llx\n", (unsigned long long)rom_hash);
+    printf("instructions:   %llu\n", (unsigned long long)total);
+    if (!total) return;
+    printf("vticks:         %u-%u (%.1f instructions/vtick)\n", first_vt, last_vt,
+            (double)total / (last_vt - first_vt + 1));
+    printf("RAM writes:     %llu instructions, %llu bytes\n", (unsigned long long)writes, (unsigned long long)bytes_written);
+    printf("failures:       %llu\n", (unsigned long long)fails);
+    printf("instruction mix:\n");
+    for (int i = 0; i < 16; ++i) {
+        if (families[i]) printf("    %Xxxx  %12llu  %5.1f%%\n", i, (unsigned long long)families[i], 100.0 * families[i] / total);
+    }
+
+    printf("hottest PCs:\n");
+    for (int n = 0; n < TOP_PCS; ++n) {
+        int best = -1;
+        for (int pc = 0; pc < RAM_SIZE; ++pc) {
+            if (pc_hits[pc] && (best < 0 || pc_hits[pc] > pc_hits[best])) best = pc;
+        }
+        if (best < 0) break;
+        printf("    %03X   %12llu  %5.1f%%\n", best, (unsigned long long)pc_hits[best], 100.0 * pc_hits[best] / total);
+        pc_hits[best] = 0;
+    }
+}
+
+// entry point: decode/filter (dump) or summarize (stats) a trace recorded by gui8
+int main(int argc, char **argv) {
+    int ret = EXIT_FAILURE;
+    FILE *fp = NULL;
+    struct filter f = { .pc = -1, .vtick_to = UINT32_MAX };
+    uint64_t rom_hash;
+    int opt;
+
+    if (argc < 2 || (strcmp(argv[1], "dump") && strcmp(argv[1], "stats"))) goto usage;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "p:o:wv:")) != -1) {
+        switch (opt) {
+        case 'p': f.pc = strtol(optarg, NULL, 16); break;
+        case 'o':
+            if (!parse_pattern(optarg, &f)) goto usage;
+            break;
+        case 'w': f.writes_only = true; break;
+        case 'v': {
+            unsigned long long from, to;
+            int n = sscanf(optarg, "%llu:%llu", &from, &to);
+            if (n < 1) goto usage;
+            f.vtick_from = from;
+            if (n == 2) f.vtick_to = to;
+            break;
+        }
+        default: goto usage;
+        }
+    }
+    if (optind != argc - 1) {
+usage:
+        fprintf(stderr, "usage: %s stats TRACE\n"
+                        "       %s dump [-p PC] [-o PATTERN] [-w] [-v FROM[:TO]] TRACE\n"
+                        "  -p PC       only instructions at this (hex) address\n"
+                        "  -o PATTERN  only opcodes matching e.g. 8xy4, Fx55, 2... (non-hex = wildcard)\n"
+                        "  -w          only instructions that wrote RAM\n"
+                        "  -v FROM:TO  only this vtick range\n", argv[0], argv[0]);
+        goto cleanup;
+    }
+
+    if ((fp = open_trace(argv[optind], &rom_hash)) == NULL) goto cleanup;
+    if (!strcmp(argv[1], "dump")) {
+        trace_dump(fp, &f);
+    } else {
+        trace_stats(fp, rom_hash);
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (fp) fclose(fp);
+    return ret;
+}